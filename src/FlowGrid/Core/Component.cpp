@@ -22,7 +22,7 @@ Component::Component(Store &store, PrimitiveActionQueuer &primitive_q, const Win
     : RootStore(store), PrimitiveQ(primitive_q), gWindows(windows), gStyle(style), Root(this), Parent(nullptr),
       PathSegment(""), Path(RootPath), Name(""), Help(""), ImGuiLabel(""), Id(ImHashStr("", 0, 0)) {
     ById.emplace(Id, this);
-    IdByPath.emplace(Path, Id);
+    IdByPathId.emplace(PathIds::Intern(Path), Id);
 }
 
 Component::Component(Component *parent, string_view path_segment, string_view path_prefix_segment, HelpInfo info, ImGuiWindowFlags flags, Menu &&menu)
@@ -41,7 +41,7 @@ Component::Component(Component *parent, string_view path_segment, string_view pa
       WindowMenu(std::move(menu)),
       WindowFlags(flags) {
     ById.emplace(Id, this);
-    IdByPath.emplace(Path, Id);
+    IdByPathId.emplace(PathIds::Intern(Path), Id);
     HelpInfo::ById.emplace(Id, HelpInfo{Name, Help});
     parent->Children.emplace_back(this);
 }
@@ -59,7 +59,7 @@ Component::Component(ComponentArgs &&args, ImGuiWindowFlags flags, Menu &&menu)
 Component::~Component() {
     if (Parent) std::erase_if(Parent->Children, [this](const auto *child) { return child == this; });
     ById.erase(Id);
-    IdByPath.erase(Path);
+    if (const auto path_id = PathIds::Find(Path)) IdByPathId.erase(*path_id);
     HelpInfo::ById.erase(Id);
     ChangeListenersById.erase(Id);
 }
@@ -68,13 +68,23 @@ bool Component::IsChanged(bool include_descendents) const noexcept {
     return ChangedIds.contains(Id) || (include_descendents && IsDescendentChanged());
 }
 
+Component *Component::Find(const StorePath &search_path) noexcept {
+    if (const auto nearest = PathIds::FindNearest(search_path); nearest && nearest->second < 3) {
+        return Find(nearest->first, 3 - nearest->second);
+    }
+    return nullptr;
+}
+
 Component *Component::FindContainerByPath(const StorePath &search_path) {
-    StorePath subpath = search_path;
-    while (subpath != "/") {
-        if (auto it = IdByPath.find(subpath); it != IdByPath.end() && ContainerIds.contains(it->second)) {
+    if (const auto nearest = PathIds::FindNearest(search_path)) return FindContainerByPath(nearest->first);
+    return nullptr;
+}
+
+Component *Component::FindContainerByPath(PathId search_path_id) {
+    for (PathId path_id = search_path_id; PathIds::Parent(path_id) != path_id; path_id = PathIds::Parent(path_id)) {
+        if (auto it = IdByPathId.find(path_id); it != IdByPathId.end() && ContainerIds.contains(it->second)) {
             return ById[it->second];
         }
-        subpath = subpath.parent_path();
     }
     return nullptr;
 }
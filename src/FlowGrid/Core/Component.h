@@ -10,6 +10,7 @@
 #include "ComponentArgs.h"
 #include "Core/HelpInfo.h"
 #include "Core/Primitive/Scalar.h"
+#include "Helper/PathIds.h"
 #include "Helper/Paths.h"
 #include "MenuItemDrawable.h"
 
@@ -71,21 +72,23 @@ struct Component {
 
     // todo these should be non-static members on the Project (root) component.
     inline static std::unordered_map<ID, Component *> ById; // Access any component by its ID.
-    inline static std::unordered_map<StorePath, ID, PathHash> IdByPath;
+    inline static std::unordered_map<PathId, ID> IdByPathId; // Keyed by interned component path (see `PathIds`).
     // Components with at least one descendent (excluding itself) updated during the latest action pass.
     inline static std::unordered_set<ID> ChangedAncestorComponentIds;
 
     inline static std::unordered_set<ID> FieldIds; // IDs of all "field" components (Primitives/Containers).
 
     // Use when you expect a component with exactly this path to exist.
-    inline static Component *ByPath(const StorePath &path) noexcept { return ById.at(IdByPath.at(path)); }
-    inline static Component *ByPath(StorePath &&path) noexcept { return ById.at(IdByPath.at(std::move(path))); }
-
-    inline static Component *Find(const StorePath &search_path) noexcept {
-        if (IdByPath.contains(search_path)) return ByPath(search_path);
-        // Search for container fields.
-        if (IdByPath.contains(search_path.parent_path())) return ByPath(search_path.parent_path());
-        if (IdByPath.contains(search_path.parent_path().parent_path())) return ByPath(search_path.parent_path().parent_path());
+    inline static Component *ByPath(const StorePath &path) noexcept { return ById.at(IdByPathId.at(PathIds::Find(path).value())); }
+
+    // Path lookups don't intern `search_path`, since it may be any store path (e.g. a container element).
+    // Component paths are interned along with all their ancestors, so the nearest interned ancestor is where the ID search starts.
+    static Component *Find(const StorePath &search_path) noexcept;
+    inline static Component *Find(PathId search_path_id, u32 max_depth = 3) noexcept {
+        // Search the path itself, and then its parent and grandparent for container fields.
+        for (u32 depth = 0; depth < max_depth; ++depth, search_path_id = PathIds::Parent(search_path_id)) {
+            if (auto it = IdByPathId.find(search_path_id); it != IdByPathId.end()) return ById.at(it->second);
+        }
         return nullptr;
     }
 
@@ -95,6 +98,7 @@ struct Component {
     inline static std::unordered_set<ID> ContainerAuxiliaryIds;
 
     static Component *FindContainerByPath(const StorePath &search_path);
+    static Component *FindContainerByPath(PathId search_path_id);
 
     inline static std::unordered_map<ID, std::unordered_set<ChangeListener *>> ChangeListenersById;
 
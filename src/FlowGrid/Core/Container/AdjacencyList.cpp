@@ -1,34 +1,80 @@
 #include "AdjacencyList.h"
 
 #include <ranges>
-#include <stack>
 
 #include "imgui.h"
+#include "immer/algorithm.hpp"
 
 #include "Core/Store/Store.h"
 
 IdPairs AdjacencyList::Get() const { return Exists() ? RootStore.Get<IdPairs>(Path) : IdPairs{}; }
 
+void AdjacencyList::AdjacencyIndex::Update(const IdPairs &edges) {
+    bool changed = false;
+    diff(
+        Edges,
+        edges,
+        [&](const IdPair &added) {
+            const auto &[source_id, destination_id] = added;
+            DestinationsById[source_id].push_back(destination_id);
+            SourcesById[destination_id].push_back(source_id);
+            changed = true;
+        },
+        [&](const IdPair &removed) {
+            const auto &[source_id, destination_id] = removed;
+            const auto remove = [](auto &ids_by_id, ID id, ID other_id) {
+                auto &ids = ids_by_id.at(id);
+                std::erase(ids, other_id);
+                if (ids.empty()) ids_by_id.erase(id);
+            };
+            remove(DestinationsById, source_id, destination_id);
+            remove(SourcesById, destination_id, source_id);
+            changed = true;
+        },
+        [](const auto &, const auto &) {} // Change callback required but never called for `immer::set`.
+    );
+    Edges = edges;
+    if (changed) AncestorsById.clear();
+}
+
+const AdjacencyList::AdjacencyIndex &AdjacencyList::GetIndex() const {
+    Index.Update(Get());
+    return Index;
+}
+
+static const std::vector<ID> NoIds{};
+
+const std::vector<ID> &AdjacencyList::GetSources(ID destination) const {
+    const auto &sources_by_id = GetIndex().SourcesById;
+    const auto it = sources_by_id.find(destination);
+    return it != sources_by_id.end() ? it->second : NoIds;
+}
+const std::vector<ID> &AdjacencyList::GetDestinations(ID source) const {
+    const auto &destinations_by_id = GetIndex().DestinationsById;
+    const auto it = destinations_by_id.find(source);
+    return it != destinations_by_id.end() ? it->second : NoIds;
+}
+
 bool AdjacencyList::HasPath(ID from_id, ID to_id) const {
-    // Non-recursive depth-first search that handles cycles.
-    const auto id_pairs = Get();
-    std::unordered_set<ID> visited;
-    std::stack<ID> to_visit;
-    to_visit.push(from_id);
-    while (!to_visit.empty()) {
-        ID current = to_visit.top();
-        to_visit.pop();
-        if (current == to_id) return true;
-
-        if (!visited.contains(current)) {
-            visited.insert(current);
-            for (const auto &[source_id, destination_id] : id_pairs) {
-                if (source_id == current) to_visit.push(destination_id);
+    if (from_id == to_id) return true;
+
+    const auto &index = GetIndex();
+    auto [ancestors_it, inserted] = Index.AncestorsById.try_emplace(to_id);
+    if (inserted) {
+        // Non-recursive reverse depth-first search that handles cycles.
+        auto &ancestors = ancestors_it->second;
+        std::vector<ID> to_visit{to_id};
+        while (!to_visit.empty()) {
+            const ID current = to_visit.back();
+            to_visit.pop_back();
+            if (auto sources_it = index.SourcesById.find(current); sources_it != index.SourcesById.end()) {
+                for (const ID source_id : sources_it->second) {
+                    if (ancestors.insert(source_id).second) to_visit.push_back(source_id);
+                }
             }
         }
     }
-
-    return false;
+    return ancestors_it->second.contains(from_id);
 }
 
 bool AdjacencyList::Exists() const { return RootStore.Contains<IdPairs>(Path); }
@@ -56,12 +102,8 @@ void AdjacencyList::DisconnectOutput(ID id) const {
     }
 }
 
-u32 AdjacencyList::SourceCount(ID destination) const {
-    return std::ranges::count_if(Get(), [destination](const auto &pair) { return pair.second == destination; });
-}
-u32 AdjacencyList::DestinationCount(ID source) const {
-    return std::ranges::count_if(Get(), [source](const auto &pair) { return pair.first == source; });
-}
+u32 AdjacencyList::SourceCount(ID destination) const { return GetSources(destination).size(); }
+u32 AdjacencyList::DestinationCount(ID source) const { return GetDestinations(source).size(); }
 
 void AdjacencyList::Erase() const { RootStore.Erase<IdPairs>(Path); }
 
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "AdjacencyListAction.h"
 #include "Core/Action/ActionableProducer.h"
 #include "Core/Component.h"
@@ -39,6 +43,10 @@ struct AdjacencyList : Component, ActionableProducer<Action::AdjacencyList::Any>
     bool HasPath(ID source, ID destination) const;
     bool IsConnected(ID source, ID destination) const;
 
+    // Neighbors, in no particular order. Invalidated by the next query after a connection changes.
+    const std::vector<ID> &GetSources(ID destination) const;
+    const std::vector<ID> &GetDestinations(ID source) const;
+
     void Add(IdPair &&) const;
     void Connect(ID source, ID destination) const;
     void Disconnect(ID source, ID destination) const;
@@ -50,4 +58,23 @@ struct AdjacencyList : Component, ActionableProducer<Action::AdjacencyList::Any>
 
     bool Exists() const; // Check if exists in store.
     void Erase() const override;
+
+private:
+    // Forward & reverse neighbor lists, kept in sync with the stored edges by applying the diff from the previously indexed edges.
+    // Immer sets share structure, so the diff only visits changed edges.
+    // Reachability is computed on demand, and cleared whenever an edge changes.
+    struct AdjacencyIndex {
+        void Update(const IdPairs &);
+
+        IdPairs Edges;
+        std::unordered_map<ID, std::vector<ID>> SourcesById, DestinationsById;
+
+        // Nodes with a path to each queried destination.
+        std::unordered_map<ID, std::unordered_set<ID>> AncestorsById;
+    };
+
+    // Sync the index with the store.
+    const AdjacencyIndex &GetIndex() const;
+
+    mutable AdjacencyIndex Index;
 };
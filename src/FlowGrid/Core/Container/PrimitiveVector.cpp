@@ -4,61 +4,59 @@
 
 #include "Core/Store/Store.h"
 
+template<typename T> Store::Vector<T> PrimitiveVector<T>::Get() const {
+    return RootStore.Contains<Store::Vector<T>>(Path) ? RootStore.Get<Store::Vector<T>>(Path) : Store::Vector<T>{};
+}
+
 template<typename T> void PrimitiveVector<T>::Set(const std::vector<T> &value) const {
-    u32 i = 0;
-    while (i < value.size()) {
-        Set(i, value[i]);
-        i++;
-    }
-    Resize(i);
+    RootStore.Set(Path, Store::Vector<T>{value.begin(), value.end()});
 }
 
 template<typename T> void PrimitiveVector<T>::Set(size_t i, const T &value) const {
-    RootStore.Set(PathAt(i), value);
+    auto vector = Get();
+    while (vector.size() <= i) vector = std::move(vector).push_back(T{});
+    RootStore.Set(Path, std::move(vector).set(i, value));
 }
 
 template<typename T> void PrimitiveVector<T>::Set(const std::vector<std::pair<int, T>> &values) const {
-    for (const auto &[i, value] : values) Set(i, value);
+    auto vector = Get();
+    for (const auto &[i, value] : values) {
+        while (vector.size() <= size_t(i)) vector = std::move(vector).push_back(T{});
+        vector = std::move(vector).set(i, value);
+    }
+    RootStore.Set(Path, std::move(vector));
 }
 
 template<typename T> void PrimitiveVector<T>::PushBack(const T &value) const {
-    RootStore.Set(PathAt(Value.size()), value);
+    RootStore.Set(Path, Get().push_back(value));
 }
 
 template<typename T> void PrimitiveVector<T>::PopBack() const {
-    if (Value.empty()) return;
-    RootStore.Erase<T>(PathAt(Value.size() - 1));
+    if (auto vector = Get(); !vector.empty()) RootStore.Set(Path, std::move(vector).take(vector.size() - 1));
 }
 
 template<typename T> void PrimitiveVector<T>::Resize(u32 size) const {
-    u32 i = size;
-    while (RootStore.CountAt<T>(PathAt(i))) {
-        RootStore.Erase<T>(PathAt(i));
-        i++;
-    }
+    auto vector = Get();
+    if (vector.size() == size) return;
+
+    if (size < vector.size()) vector = std::move(vector).take(size);
+    while (vector.size() < size) vector = std::move(vector).push_back(T{});
+    RootStore.Set(Path, std::move(vector));
 }
 
-template<typename T> void PrimitiveVector<T>::Erase() const { Resize(0); }
+template<typename T> void PrimitiveVector<T>::Erase() const {
+    if (RootStore.Contains<Store::Vector<T>>(Path)) RootStore.Erase<Store::Vector<T>>(Path);
+}
 
 template<typename T> void PrimitiveVector<T>::Erase(const T &value) const {
     if (auto it = std::find(Value.begin(), Value.end(), value); it != Value.end()) {
-        const u32 index = it - Value.begin();
-        for (u32 relocate_index = Value.size() - 1; relocate_index > index; relocate_index--) {
-            Set(relocate_index - 1, Value.at(relocate_index));
-        }
-        Resize(Value.size() - 1);
+        RootStore.Set(Path, Get().erase(it - Value.begin()));
     }
 }
 
 template<typename T> void PrimitiveVector<T>::Refresh() {
-    u32 i = 0;
-    while (RootStore.CountAt<T>(PathAt(i))) {
-        const T value = RootStore.Get<T>(PathAt(i));
-        if (Value.size() == i) Value.push_back(value);
-        else Value[i] = value;
-        i++;
-    }
-    Value.resize(i);
+    const auto vector = Get();
+    Value.assign(vector.begin(), vector.end());
 }
 
 template<typename T> void PrimitiveVector<T>::SetJson(json &&j) const {
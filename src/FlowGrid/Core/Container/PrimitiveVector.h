@@ -1,9 +1,12 @@
 #pragma once
 
+#include "immer/flex_vector.hpp"
+
 #include "Container.h"
 #include "Core/Action/Actionable.h"
 #include "PrimitiveVectorAction.h"
 
+// Stored as a single `immer::flex_vector` value, patched per element (see `Store::Vector`).
 template<typename T> struct PrimitiveVector : Container, Actionable<typename Action::PrimitiveVector<T>::Any> {
     using Container::Container;
 
@@ -62,4 +65,7 @@ template<typename T> struct PrimitiveVector : Container, Actionable<typename Act
 
 protected:
     std::vector<T> Value;
+
+private:
+    immer::flex_vector<T> Get() const; // The stored vector (which may be ahead of `Value`).
 };
@@ -4,52 +4,42 @@
 
 #include "Core/Store/Store.h"
 
-template<typename T> void PrimitiveVector2D<T>::Set(const std::vector<std::vector<T>> &value) const {
-    u32 i = 0;
-    while (i < value.size()) {
-        u32 j = 0;
-        while (j < value[i].size()) {
-            Set(i, j, value[i][j]);
-            j++;
-        }
-        while (RootStore.CountAt<T>(PathAt(i, j))) RootStore.Erase<T>(PathAt(i, j++));
-        i++;
-    }
+template<typename T> immer::flex_vector<T> PrimitiveVector2D<T>::GetRow(u32 i) const {
+    return RootStore.Contains<Store::Vector<T>>(PathAt(i)) ? RootStore.Get<Store::Vector<T>>(PathAt(i)) : Store::Vector<T>{};
+}
 
-    Resize(i);
+template<typename T> void PrimitiveVector2D<T>::Set(const std::vector<std::vector<T>> &value) const {
+    for (u32 i = 0; i < value.size(); i++) RootStore.Set(PathAt(i), Store::Vector<T>{value[i].begin(), value[i].end()});
+    Resize(value.size());
 }
 
 template<typename T> void PrimitiveVector2D<T>::Set(u32 i, u32 j, const T &value) const {
-    RootStore.Set(PathAt(i, j), value);
+    auto row = GetRow(i);
+    while (row.size() <= j) row = std::move(row).push_back(T{});
+    RootStore.Set(PathAt(i), std::move(row).set(j, value));
 }
 
 template<typename T> void PrimitiveVector2D<T>::Resize(u32 size) const {
-    u32 i = size;
-    while (RootStore.CountAt<T>(PathAt(i, 0))) {
-        Resize(i, 0);
-        i++;
-    }
+    for (u32 i = size; RootStore.Contains<Store::Vector<T>>(PathAt(i)); i++) RootStore.Erase<Store::Vector<T>>(PathAt(i));
 }
 
 template<typename T> void PrimitiveVector2D<T>::Resize(u32 i, u32 size) const {
-    u32 j = size;
-    while (RootStore.CountAt<T>(PathAt(i, j))) RootStore.Erase<T>(PathAt(i, j++));
+    auto row = GetRow(i);
+    if (row.size() == size && RootStore.Contains<Store::Vector<T>>(PathAt(i))) return;
+
+    if (size < row.size()) row = std::move(row).take(size);
+    while (row.size() < size) row = std::move(row).push_back(T{});
+    RootStore.Set(PathAt(i), std::move(row));
 }
 
 template<typename T> void PrimitiveVector2D<T>::Erase() const { Resize(0); }
 
 template<typename T> void PrimitiveVector2D<T>::Refresh() {
     u32 i = 0;
-    while (RootStore.CountAt<T>(PathAt(i, 0))) {
-        if (Value.size() == i) Value.push_back({});
-        u32 j = 0;
-        while (RootStore.CountAt<T>(PathAt(i, j))) {
-            const T value = RootStore.Get<T>(PathAt(i, j));
-            if (Value[i].size() == j) Value[i].push_back(value);
-            else Value[i][j] = value;
-            j++;
-        }
-        Value[i].resize(j);
+    while (RootStore.Contains<Store::Vector<T>>(PathAt(i))) {
+        const auto &row = RootStore.Get<Store::Vector<T>>(PathAt(i));
+        if (Value.size() == i) Value.emplace_back();
+        Value[i].assign(row.begin(), row.end());
         i++;
     }
     Value.resize(i);
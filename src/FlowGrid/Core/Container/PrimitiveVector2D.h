@@ -1,10 +1,13 @@
 #pragma once
 
+#include "immer/flex_vector.hpp"
+
 #include "Container.h"
 #include "Core/Action/Actionable.h"
 #include "PrimitiveVector2DAction.h"
 
 // PrimitiveVector of vectors. Inner vectors may have different sizes.
+// Each inner vector is stored as a single `immer::flex_vector` value at `Path/i`, patched per element (at `Path/i/j`).
 template<typename T> struct PrimitiveVector2D : Container, Actionable<typename Action::PrimitiveVector2D<T>::Any> {
     using Container::Container;
 
@@ -29,7 +32,8 @@ template<typename T> struct PrimitiveVector2D : Container, Actionable<typename A
 
     T operator()(u32 i, u32 j) const { return Value[i][j]; }
 
-    StorePath PathAt(const u32 i, const u32 j) const { return Path / std::to_string(i) / std::to_string(j); }
+    StorePath PathAt(const u32 i) const { return Path / std::to_string(i); }
+    StorePath PathAt(const u32 i, const u32 j) const { return PathAt(i) / std::to_string(j); }
     u32 Size() const { return Value.size(); }; // Number of outer vectors
     u32 Size(u32 i) const { return Value[i].size(); }; // Size of inner vector at index `i`
 
@@ -40,5 +44,7 @@ template<typename T> struct PrimitiveVector2D : Container, Actionable<typename A
     void Erase() const override;
 
 private:
+    immer::flex_vector<T> GetRow(u32 i) const; // The stored inner vector at `i` (which may be ahead of `Value`).
+
     std::vector<std::vector<T>> Value;
 };
@@ -1,6 +1,7 @@
 #include "ImGuiSettings.h"
 
 #include "imgui_internal.h"
+#include <bit>
 #include <iostream>
 
 #include "Core/Store/Store.h"
@@ -24,8 +25,40 @@ struct ImGuiDockNodeSettings { // NOLINT(cppcoreguidelines-pro-type-member-init)
     ImVec2ih SizeRef;
 };
 
+// Each entry is hashed over the fields we store, so `Set` only writes the entries that changed since they were last written.
+// If the number of entries changed, all entries are written.
+static bool UpdateEntryHash(std::vector<u32> &hashes, bool write_all, u32 i, u32 hash) {
+    if (!write_all && hashes[i] == hash) return false;
+    hashes[i] = hash;
+    return true;
+}
+
+static u32 HashEntry(const ImGuiDockNodeSettings &ds) {
+    const u32 fields[]{ds.NodeId, ds.ParentNodeId, ds.ParentWindowId, ds.SelectedTabId, u32(ds.SplitAxis), u32(ds.Depth), u32(ds.Flags), PackImVec2ih(ds.Pos), PackImVec2ih(ds.Size), PackImVec2ih(ds.SizeRef)};
+    return ImHashData(fields, sizeof(fields));
+}
+static u32 HashEntry(const ImGuiWindowSettings &ws) {
+    const u32 fields[]{ws.ID, ws.ClassId, ws.ViewportId, ws.DockId, u32(ws.DockOrder), PackImVec2ih(ws.Pos), PackImVec2ih(ws.Size), PackImVec2ih(ws.ViewportPos), ws.Collapsed};
+    return ImHashData(fields, sizeof(fields));
+}
+// todo these nans show up when we start with a default layout showing a table and then switch the tab so that the table is hidden.
+//   should probably handle this more robustly.
+static float ColumnWidthOrWeight(const ImGuiTableColumnSettings &cs) { return std::isnan(cs.WidthOrWeight) ? 0 : cs.WidthOrWeight; }
+static u32 HashEntry(ImGuiTableSettings &ts) {
+    const u32 fields[]{ts.ID, u32(ts.SaveFlags), std::bit_cast<u32>(ts.RefScale), u32(ts.ColumnsCount), u32(ts.ColumnsCountMax), ts.WantApply};
+    u32 hash = ImHashData(fields, sizeof(fields));
+    for (int j = 0; j < ts.ColumnsCount; j++) {
+        const auto &cs = ts.GetColumnSettings()[j];
+        const u32 column_fields[]{std::bit_cast<u32>(ColumnWidthOrWeight(cs)), cs.UserID, u32(cs.Index), u32(cs.DisplayOrder), u32(cs.SortOrder), u32(cs.SortDirection), cs.IsEnabled, cs.IsStretch};
+        hash = ImHashData(column_fields, sizeof(column_fields), hash);
+    }
+    return hash;
+}
+
 void DockNodeSettings::Set(const ImVector<ImGuiDockNodeSettings> &dss) const {
     const u32 size = dss.Size;
+    const bool write_all = EntryHashes.size() != size;
+    EntryHashes.resize(size);
 
     NodeId.Resize(size);
     ParentNodeId.Resize(size);
@@ -40,6 +73,8 @@ void DockNodeSettings::Set(const ImVector<ImGuiDockNodeSettings> &dss) const {
 
     for (u32 i = 0; i < size; i++) {
         const auto &ds = dss[int(i)];
+        if (!UpdateEntryHash(EntryHashes, write_all, i, HashEntry(ds))) continue;
+
         NodeId.Set(i, ds.NodeId);
         ParentNodeId.Set(i, ds.ParentNodeId);
         ParentWindowId.Set(i, ds.ParentWindowId);
@@ -74,6 +109,8 @@ void DockNodeSettings::Update(ImGuiContext *ctx) const {
 
 void WindowSettings::Set(ImChunkStream<ImGuiWindowSettings> &wss) const {
     const u32 size = wss.size();
+    const bool write_all = EntryHashes.size() != size;
+    EntryHashes.resize(size);
 
     Id.Resize(size);
     ClassId.Resize(size);
@@ -86,7 +123,9 @@ void WindowSettings::Set(ImChunkStream<ImGuiWindowSettings> &wss) const {
     Collapsed.Resize(size);
 
     u32 i = 0;
-    for (auto *ws = wss.begin(); ws != nullptr; ws = wss.next_chunk(ws)) {
+    for (auto *ws = wss.begin(); ws != nullptr; ws = wss.next_chunk(ws), i++) {
+        if (!UpdateEntryHash(EntryHashes, write_all, i, HashEntry(*ws))) continue;
+
         Id.Set(i, ws->ID);
         ClassId.Set(i, ws->ClassId);
         ViewportId.Set(i, ws->ViewportId);
@@ -96,7 +135,6 @@ void WindowSettings::Set(ImChunkStream<ImGuiWindowSettings> &wss) const {
         Size.Set(i, PackImVec2ih(ws->Size));
         ViewportPos.Set(i, PackImVec2ih(ws->ViewportPos));
         Collapsed.Set(i, ws->Collapsed);
-        i++;
     }
 }
 
@@ -131,6 +169,8 @@ void WindowSettings::Update(ImGuiContext *) const {
 
 void TableSettings::Set(ImChunkStream<ImGuiTableSettings> &tss) const {
     const u32 size = tss.size();
+    const bool write_all = EntryHashes.size() != size;
+    EntryHashes.resize(size);
     // Table settings
     ID.Resize(size);
     SaveFlags.Resize(size);
@@ -149,8 +189,17 @@ void TableSettings::Set(ImChunkStream<ImGuiTableSettings> &tss) const {
     Columns.IsStretch.Resize(size);
 
     u32 i = 0;
-    for (auto *ts_it = tss.begin(); ts_it != nullptr; ts_it = tss.next_chunk(ts_it)) {
+    for (auto *ts_it = tss.begin(); ts_it != nullptr; ts_it = tss.next_chunk(ts_it), i++) {
         auto &ts = *ts_it;
+        if (!UpdateEntryHash(EntryHashes, write_all, i, HashEntry(ts))) continue;
+
+        ID.Set(i, ts.ID);
+        SaveFlags.Set(i, ts.SaveFlags);
+        RefScale.Set(i, ts.RefScale);
+        ColumnsCount.Set(i, ts.ColumnsCount);
+        ColumnsCountMax.Set(i, ts.ColumnsCountMax);
+        WantApply.Set(i, ts.WantApply);
+
         const u32 columns_count = ts.ColumnsCount;
 
         Columns.WidthOrWeight.Resize(i, columns_count);
@@ -164,9 +213,7 @@ void TableSettings::Set(ImChunkStream<ImGuiTableSettings> &tss) const {
 
         for (u32 j = 0; j < columns_count; j++) {
             const auto &cs = ts.GetColumnSettings()[j];
-            // todo these nans show up when we start with a default layout showing a table and then switch the tab so that the table is hidden.
-            //   should probably handle this more robustly.
-            Columns.WidthOrWeight.Set(i, j, std::isnan(cs.WidthOrWeight) ? 0 : cs.WidthOrWeight);
+            Columns.WidthOrWeight.Set(i, j, ColumnWidthOrWeight(cs));
             Columns.UserID.Set(i, j, cs.UserID);
             Columns.Index.Set(i, j, cs.Index);
             Columns.DisplayOrder.Set(i, j, cs.DisplayOrder);
@@ -175,7 +222,6 @@ void TableSettings::Set(ImChunkStream<ImGuiTableSettings> &tss) const {
             Columns.IsEnabled.Set(i, j, cs.IsEnabled);
             Columns.IsStretch.Set(i, j, cs.IsStretch);
         }
-        i++;
     }
 }
 
@@ -240,6 +286,10 @@ void ImGuiSettings::UpdateIfChanged(ImGuiContext *ctx) const {
     if (!IsChanged) return;
 
     IsChanged = false;
+    // The store may no longer match the last written entries.
+    Nodes.EntryHashes.clear();
+    Windows.EntryHashes.clear();
+    Tables.EntryHashes.clear();
 
     DockSettingsHandler_ClearAll(ctx, nullptr);
     Windows.Update(ctx);
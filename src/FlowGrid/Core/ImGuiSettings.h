@@ -22,6 +22,9 @@ struct DockNodeSettings : Component {
     void Set(const ImVector<ImGuiDockNodeSettings> &) const;
     void Update(ImGuiContext *) const;
 
+    // Hash of each entry as of its last write to the store, so `Set` only writes changed entries. Cleared by `ImGuiSettings::UpdateIfChanged`.
+    mutable std::vector<u32> EntryHashes;
+
     Prop(PrimitiveVector<ID>, NodeId);
     Prop(PrimitiveVector<ID>, ParentNodeId);
     Prop(PrimitiveVector<ID>, ParentWindowId);
@@ -40,6 +43,8 @@ struct WindowSettings : Component {
     void Set(ImChunkStream<ImGuiWindowSettings> &) const;
     void Update(ImGuiContext *) const;
 
+    mutable std::vector<u32> EntryHashes; // See `DockNodeSettings::EntryHashes`.
+
     Prop(PrimitiveVector<ID>, Id);
     Prop(PrimitiveVector<ID>, ClassId);
     Prop(PrimitiveVector<ID>, ViewportId);
@@ -71,6 +76,8 @@ struct TableSettings : Component {
     void Set(ImChunkStream<ImGuiTableSettings> &) const;
     void Update(ImGuiContext *) const;
 
+    mutable std::vector<u32> EntryHashes; // See `DockNodeSettings::EntryHashes`.
+
     Prop(PrimitiveVector<ImGuiID>, ID);
     Prop(PrimitiveVector<int>, SaveFlags);
     Prop(PrimitiveVector<float>, RefScale);
@@ -23,17 +23,17 @@ PatchOps Merge(const PatchOps &a, const PatchOps &b) {
         // (in which case it should just be `Remove` during merge) or if it was different (in which case the merged action should be a `Replace`).
         if (old_op.Op == AddOp) {
             if (op.Op == RemoveOp || ((op.Op == AddOp || op.Op == ReplaceOp) && old_op.Value == op.Value)) merged.erase(path); // Cancel out
-            else merged[path] = {AddOp, op.Value, {}};
+            else merged[path] = {AddOp, op.Value, {}, op.Target};
         } else if (old_op.Op == RemoveOp) {
             if (op.Op == AddOp || op.Op == ReplaceOp) {
                 if (old_op.Value == op.Value) merged.erase(path); // Cancel out
-                else merged[path] = {ReplaceOp, op.Value, old_op.Old};
+                else merged[path] = {ReplaceOp, op.Value, old_op.Old, op.Target};
             } else {
-                merged[path] = {RemoveOp, {}, old_op.Old};
+                merged[path] = {RemoveOp, {}, old_op.Old, op.Target};
             }
         } else if (old_op.Op == ReplaceOp) {
-            if (op.Op == AddOp || op.Op == ReplaceOp) merged[path] = {ReplaceOp, op.Value, old_op.Old};
-            else merged[path] = {RemoveOp, {}, old_op.Old};
+            if (op.Op == AddOp || op.Op == ReplaceOp) merged[path] = {ReplaceOp, op.Value, old_op.Old, op.Target};
+            else merged[path] = {RemoveOp, {}, old_op.Old, op.Target};
         }
     }
 
@@ -15,6 +15,28 @@ NLOHMANN_JSON_SERIALIZE_ENUM(
         {PatchOpType::Replace, "replace"},
     }
 );
-Json(PatchOp, Op, Value, Old);
+NLOHMANN_JSON_SERIALIZE_ENUM(
+    PatchOpTarget,
+    {
+        {PatchOpTarget::Value, "value"},
+        {PatchOpTarget::Vector, "vector"},
+        {PatchOpTarget::VectorElement, "vector_element"},
+        {PatchOpTarget::SetElement, "set_element"},
+    }
+);
+// Same as `Json(PatchOp, Op, Value, Old, Target)`, but `Target` is omitted for (the default) value ops,
+// so patches saved before it existed still load.
+inline static void to_json(json &j, const PatchOp &op) {
+    extended_to_json("Op", j, op.Op);
+    extended_to_json("Value", j, op.Value);
+    extended_to_json("Old", j, op.Old);
+    if (op.Target != PatchOpTarget::Value) j["Target"] = op.Target;
+}
+inline static void from_json(const json &j, PatchOp &op) {
+    extended_from_json("Op", j, op.Op);
+    extended_from_json("Value", j, op.Value);
+    extended_from_json("Old", j, op.Old);
+    op.Target = j.value("Target", PatchOpTarget::Value);
+}
 Json(Patch, Ops, BasePath);
 } // namespace nlohmann
@@ -11,10 +11,19 @@ enum class PatchOpType {
     Replace,
 };
 
+// What an op's path refers to.
+enum class PatchOpTarget {
+    Value, // The primitive at the path.
+    Vector, // The (possibly empty) vector at the path. Only added/removed, with a default element as its value, to carry the element type.
+    VectorElement, // The element at `vector_path/index`.
+    SetElement, // The element at `set_path/element`.
+};
+
 struct PatchOp {
     PatchOpType Op{};
     std::optional<PrimitiveVariant> Value{}; // Present for add/replace
     std::optional<PrimitiveVariant> Old{}; // Present for remove/replace
+    PatchOpTarget Target{PatchOpTarget::Value};
 };
 
 inline static std::string to_string(PatchOpType type) {
@@ -1,5 +1,7 @@
 #include "Store.h"
 
+#include <format>
+
 #include "immer/algorithm.hpp"
 
 using std::string;
@@ -32,6 +34,35 @@ template<typename T> void AddOps(const Store &before, const Store &after, const
     );
 }
 
+// Vectors are patched per element: Elements past the end of the shorter vector are added/removed, and the rest are replaced if changed.
+// Adding or removing a vector (`nullptr` when absent) also patches the vector's own path, so empty vectors are patched too.
+template<typename T> void AddVectorOps(const Store::Vector<T> *before, const Store::Vector<T> *after, const StorePath &relative_path, PatchOps &ops) {
+    static const Store::Vector<T> empty{};
+    if (!before && after) ops[relative_path] = {PatchOpType::Add, T{}, {}, PatchOpTarget::Vector};
+    else if (before && !after) ops[relative_path] = {PatchOpType::Remove, {}, T{}, PatchOpTarget::Vector};
+
+    const auto &before_vector = before ? *before : empty, &after_vector = after ? *after : empty;
+    if (before_vector == after_vector) return; // Cheap when unchanged subtrees are shared.
+
+    auto before_it = before_vector.begin(), after_it = after_vector.begin();
+    u32 i = 0;
+    for (; before_it != before_vector.end() && after_it != after_vector.end(); ++before_it, ++after_it, ++i) {
+        if (*before_it != *after_it) ops[relative_path / std::to_string(i)] = {PatchOpType::Replace, *after_it, *before_it, PatchOpTarget::VectorElement};
+    }
+    for (; after_it != after_vector.end(); ++after_it, ++i) ops[relative_path / std::to_string(i)] = {PatchOpType::Add, *after_it, {}, PatchOpTarget::VectorElement};
+    for (; before_it != before_vector.end(); ++before_it, ++i) ops[relative_path / std::to_string(i)] = {PatchOpType::Remove, {}, *before_it, PatchOpTarget::VectorElement};
+}
+
+template<typename T> void AddVectorMapOps(const Store &before, const Store &after, const StorePath &base_path, PatchOps &ops) {
+    diff(
+        before.GetMap<Store::Vector<T>>(),
+        after.GetMap<Store::Vector<T>>(),
+        [&](const auto &added) { AddVectorOps<T>(nullptr, &added.second, added.first.lexically_relative(base_path), ops); },
+        [&](const auto &removed) { AddVectorOps<T>(&removed.second, nullptr, removed.first.lexically_relative(base_path), ops); },
+        [&](const auto &o, const auto &n) { AddVectorOps<T>(&o.second, &n.second, n.first.lexically_relative(base_path), ops); }
+    );
+}
+
 Patch Store::CreatePatch(const Store &before, const Store &after, const StorePath &base_path) const {
     PatchOps ops{};
 
@@ -47,13 +78,13 @@ Patch Store::CreatePatch(const Store &before, const Store &after, const StorePat
         [&](const auto &added) {
             for (const auto &id_pair : added.second) {
                 const auto serialized = SerializeIdPair(id_pair);
-                ops[added.first.lexically_relative(base_path) / serialized] = {PatchOpType::Add, serialized, {}};
+                ops[added.first.lexically_relative(base_path) / serialized] = {PatchOpType::Add, serialized, {}, PatchOpTarget::SetElement};
             }
         },
         [&](const auto &removed) {
             for (const auto &id_pair : removed.second) {
                 const auto serialized = SerializeIdPair(id_pair);
-                ops[removed.first.lexically_relative(base_path) / serialized] = {PatchOpType::Remove, {}, serialized};
+                ops[removed.first.lexically_relative(base_path) / serialized] = {PatchOpType::Remove, {}, serialized, PatchOpTarget::SetElement};
             }
         },
         [&](const auto &o, const auto &n) {
@@ -62,11 +93,11 @@ Patch Store::CreatePatch(const Store &before, const Store &after, const StorePat
                 n.second,
                 [&](const auto &added) {
                     const auto serialized = SerializeIdPair(added);
-                    ops[n.first.lexically_relative(base_path) / serialized] = {PatchOpType::Add, serialized, {}};
+                    ops[n.first.lexically_relative(base_path) / serialized] = {PatchOpType::Add, serialized, {}, PatchOpTarget::SetElement};
                 },
                 [&](const auto &removed) {
                     const auto serialized = SerializeIdPair(removed);
-                    ops[o.first.lexically_relative(base_path) / serialized] = {PatchOpType::Remove, {}, serialized};
+                    ops[o.first.lexically_relative(base_path) / serialized] = {PatchOpType::Remove, {}, serialized, PatchOpTarget::SetElement};
                 },
                 [](const auto &, const auto &) {} // Change callback required but never called for `immer::set`.
             );
@@ -77,50 +108,139 @@ Patch Store::CreatePatch(const Store &before, const Store &after, const StorePat
         after.GetMap<immer::set<u32>>(),
         [&](const auto &added) {
             for (auto value : added.second) {
-                ops[added.first.lexically_relative(base_path) / std::to_string(value)] = {PatchOpType::Add, value, {}};
+                ops[added.first.lexically_relative(base_path) / std::to_string(value)] = {PatchOpType::Add, value, {}, PatchOpTarget::SetElement};
             }
         },
         [&](const auto &removed) {
             for (auto value : removed.second) {
-                ops[removed.first.lexically_relative(base_path) / std::to_string(value)] = {PatchOpType::Remove, {}, value};
+                ops[removed.first.lexically_relative(base_path) / std::to_string(value)] = {PatchOpType::Remove, {}, value, PatchOpTarget::SetElement};
             }
         },
         [&](const auto &o, const auto &n) {
             diff(
                 o.second,
                 n.second,
-                [&](auto added) { ops[n.first.lexically_relative(base_path) / std::to_string(added)] = {PatchOpType::Add, added, {}}; },
-                [&](unsigned int removed) { ops[o.first.lexically_relative(base_path) / std::to_string(removed)] = {PatchOpType::Remove, {}, removed}; },
+                [&](auto added) { ops[n.first.lexically_relative(base_path) / std::to_string(added)] = {PatchOpType::Add, added, {}, PatchOpTarget::SetElement}; },
+                [&](unsigned int removed) { ops[o.first.lexically_relative(base_path) / std::to_string(removed)] = {PatchOpType::Remove, {}, removed, PatchOpTarget::SetElement}; },
                 [](const auto &, const auto &) {} // Change callback required but never called for `immer::set`.
             );
         }
     );
-    // todo: immer::vector diff is not yet implemented
-    // diff(
-    //     before.GetMap<immer::vector<u32>>(),
-    //     after.GetMap<immer::vector<u32>>(),
-    //     [&](const auto &added) {
-    //         for (uint i = 0; i < added.second.size(); i++) {
-    //             ops[added.first.lexically_relative(base_path) / std::to_string(i)] = {PatchOpType::Add, added.second[i], {}};
-    //         }
-    //     },
-    //     [&](const auto &removed) {
-    //         for (uint i = 0; i < removed.second.size(); i++) {
-    //             ops[removed.first.lexically_relative(base_path) / std::to_string(i)] = {PatchOpType::Remove, {}, removed.second[i]};
-    //         }
-    //     },
-    //     [&](const auto &o, const auto &n) {
-    //         diff(
-    //             o.second,
-    //             n.second,
-    //             // `diff` for `immer::vector<T>` provides callback values of type `pair<std::size_t, const T&>`,
-    //             // where the first element is the index and the second is the value.
-    //             [&](auto added) { ops[n.first.lexically_relative(base_path) / std::to_string(added.first)] = {PatchOpType::Add, added.second, {}}; },
-    //             [&](auto removed) { ops[o.first.lexically_relative(base_path) / std::to_string(removed.first)] = {PatchOpType::Remove, {}, removed.second}; },
-    //             [](const auto &, const auto &) {} // Change callback required but never called for `immer::vector`.
-    //         );
-    //     }
-    // );
+    AddVectorMapOps<bool>(before, after, base_path, ops);
+    AddVectorMapOps<u32>(before, after, base_path, ops);
+    AddVectorMapOps<s32>(before, after, base_path, ops);
+    AddVectorMapOps<float>(before, after, base_path, ops);
+    AddVectorMapOps<string>(before, after, base_path, ops);
+
+    return {ops, base_path};
+}
+
+static std::string ElementPathSegment(const IdPair &id_pair) { return SerializeIdPair(id_pair); }
+static std::string ElementPathSegment(u32 value) { return std::to_string(value); }
+static PrimitiveVariant ElementValue(const IdPair &id_pair) { return SerializeIdPair(id_pair); }
+static PrimitiveVariant ElementValue(u32 value) { return value; }
+
+template<typename T> struct IsVector : std::false_type {};
+template<typename T> struct IsVector<Store::Vector<T>> : std::true_type {};
+
+template<typename T> void Store::AddTouchedOps(const StorePath &path, const StorePath &relative_path, PatchOps &ops) const {
+    const auto *before = GetMap<T>().find(path);
+    const auto &transient_map = GetTransientMap<T>();
+    const auto *after = transient_map.count(path) > 0 ? &transient_map.at(path) : nullptr;
+    if (!before && !after) return;
 
+    if constexpr (std::is_same_v<T, IdPairs> || std::is_same_v<T, immer::set<u32>>) {
+        // Set values are patched per element.
+        static const T empty{};
+        diff(
+            before ? *before : empty,
+            after ? *after : empty,
+            [&](const auto &added) { ops[relative_path / ElementPathSegment(added)] = {PatchOpType::Add, ElementValue(added), {}, PatchOpTarget::SetElement}; },
+            [&](const auto &removed) { ops[relative_path / ElementPathSegment(removed)] = {PatchOpType::Remove, {}, ElementValue(removed), PatchOpTarget::SetElement}; },
+            [](const auto &, const auto &) {} // Change callback required but never called for `immer::set`.
+        );
+    } else if constexpr (IsVector<T>::value) {
+        AddVectorOps<typename T::value_type>(before, after, relative_path, ops);
+    } else {
+        if (!before) ops[relative_path] = {PatchOpType::Add, *after, {}};
+        else if (!after) ops[relative_path] = {PatchOpType::Remove, {}, *before};
+        else if (*before != *after) ops[relative_path] = {PatchOpType::Replace, *after, *before};
+    }
+}
+
+Patch Store::CreateTouchedPatch(const StorePath &base_path) const {
+    PatchOps ops{};
+    if (!TransientMaps) return {ops, base_path};
+
+    for (const auto &path : TouchedPaths) {
+        const auto relative_path = path.lexically_relative(base_path);
+        AddTouchedOps<bool>(path, relative_path, ops);
+        AddTouchedOps<u32>(path, relative_path, ops);
+        AddTouchedOps<s32>(path, relative_path, ops);
+        AddTouchedOps<float>(path, relative_path, ops);
+        AddTouchedOps<string>(path, relative_path, ops);
+        AddTouchedOps<IdPairs>(path, relative_path, ops);
+        AddTouchedOps<immer::set<u32>>(path, relative_path, ops);
+        AddTouchedOps<Vector<bool>>(path, relative_path, ops);
+        AddTouchedOps<Vector<u32>>(path, relative_path, ops);
+        AddTouchedOps<Vector<s32>>(path, relative_path, ops);
+        AddTouchedOps<Vector<float>>(path, relative_path, ops);
+        AddTouchedOps<Vector<string>>(path, relative_path, ops);
+    }
     return {ops, base_path};
 }
+
+template<typename T> void Store::ApplyVectorElementOp(const StorePath &vector_path, u32 index, PatchOpType op, const T &value) const {
+    auto vector = Contains<Vector<T>>(vector_path) ? Get<Vector<T>>(vector_path) : Vector<T>{};
+    if (op == PatchOpType::Remove) {
+        // Only trailing elements are removed.
+        if (index < vector.size()) vector = vector.take(index);
+    } else {
+        // Ops are unordered, so elements may be added past the end.
+        while (vector.size() <= index) vector = std::move(vector).push_back(T{});
+        vector = std::move(vector).set(index, value);
+    }
+    Set(vector_path, vector);
+}
+
+template<typename SetType, typename T> void Store::ApplySetElementOp(const StorePath &set_path, PatchOpType op, const T &element) const {
+    auto set = Contains<SetType>(set_path) ? Get<SetType>(set_path) : SetType{};
+    Set(set_path, op == PatchOpType::Remove ? set.erase(element) : set.insert(element));
+}
+
+void Store::ApplyOp(const StorePath &path, const PatchOp &op) const {
+    std::visit(
+        [this, &path, &op](const auto &v) {
+            using T = std::decay_t<decltype(v)>;
+            switch (op.Target) {
+                case PatchOpTarget::Value:
+                    if (op.Op == PatchOpType::Remove) ErasePrimitive(path);
+                    else Set(path, v);
+                    break;
+                case PatchOpTarget::Vector:
+                    if (op.Op == PatchOpType::Remove) Erase<Vector<T>>(path);
+                    else if (!Contains<Vector<T>>(path)) Set(path, Vector<T>{});
+                    break;
+                case PatchOpTarget::VectorElement:
+                    ApplyVectorElementOp(path.parent_path(), std::stoul(path.filename().string()), op.Op, v);
+                    break;
+                case PatchOpTarget::SetElement:
+                    if constexpr (std::is_same_v<T, u32>) ApplySetElementOp<immer::set<u32>>(path.parent_path(), op.Op, v);
+                    else if constexpr (std::is_same_v<T, string>) ApplySetElementOp<IdPairs>(path.parent_path(), op.Op, DeserializeIdPair(v));
+                    else throw std::runtime_error(std::format("Unsupported set element type at path {}.", path.string()));
+                    break;
+            }
+        },
+        op.Op == PatchOpType::Remove ? *op.Old : *op.Value
+    );
+}
+
+void Store::ApplyPatch(const Patch &patch) const {
+    // Ops are unordered. Vector element ops create their vector if needed, but vectors are only removed after all element ops.
+    std::vector<std::pair<StorePath, const PatchOp *>> removed_vectors;
+    for (const auto &[partial_path, op] : patch.Ops) {
+        if (op.Target == PatchOpTarget::Vector && op.Op == PatchOpType::Remove) removed_vectors.emplace_back(patch.BasePath / partial_path, &op);
+        else ApplyOp(patch.BasePath / partial_path, op);
+    }
+    for (const auto &[path, op] : removed_vectors) ApplyOp(path, *op);
+}
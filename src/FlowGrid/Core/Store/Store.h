@@ -1,10 +1,11 @@
 #pragma once
 
 #include <tuple>
+#include <unordered_set>
 
+#include "immer/flex_vector.hpp"
 #include "immer/map.hpp"
 #include "immer/map_transient.hpp"
-#include "immer/vector.hpp"
 
 #include "Core/Action/Actionable.h"
 #include "Helper/Path.h"
@@ -22,7 +23,12 @@ struct Store : Actionable<Action::Store::Any> {
     template<typename T> using Map = immer::map<StorePath, T, PathHash>;
     template<typename T> using TransientMap = immer::map_transient<StorePath, T, PathHash>;
 
-    using ValueTypes = std::tuple<bool, u32, s32, float, std::string, IdPairs, immer::set<u32>>;
+    // Vectors are stored under a single path, but patched per element (at `path/index`).
+    template<typename T> using Vector = immer::flex_vector<T>;
+
+    using ValueTypes = std::tuple<
+        bool, u32, s32, float, std::string, IdPairs, immer::set<u32>,
+        Vector<bool>, Vector<u32>, Vector<s32>, Vector<float>, Vector<std::string>>;
     using StoreMaps = typename WrapTypes<Map, ValueTypes>::type;
     using TransientStoreMaps = typename WrapTypes<TransientMap, ValueTypes>::type;
 
@@ -47,8 +53,14 @@ struct Store : Actionable<Action::Store::Any> {
     template<typename ValueType> const ValueType &Get(const StorePath &path) const { return GetTransientMap<ValueType>().at(path); }
     template<typename ValueType> u32 CountAt(const StorePath &path) const { return GetTransientMap<ValueType>().count(path); }
 
-    template<typename ValueType> void Set(const StorePath &path, const ValueType &value) const { GetTransientMap<ValueType>().set(path, value); }
-    template<typename ValueType> void Erase(const StorePath &path) const { GetTransientMap<ValueType>().erase(path); }
+    template<typename ValueType> void Set(const StorePath &path, const ValueType &value) const {
+        TouchedPaths.insert(path);
+        GetTransientMap<ValueType>().set(path, value);
+    }
+    template<typename ValueType> void Erase(const StorePath &path) const {
+        TouchedPaths.insert(path);
+        GetTransientMap<ValueType>().erase(path);
+    }
     void ErasePrimitive(const StorePath &path) const {
         if (Contains<bool>(path)) Erase<bool>(path);
         else if (Contains<u32>(path)) Erase<u32>(path);
@@ -63,12 +75,27 @@ struct Store : Actionable<Action::Store::Any> {
         return Contains<bool>(path) || Contains<u32>(path) || Contains<s32>(path) || Contains<float>(path) || Contains<std::string>(path);
     }
 
+    bool ContainsVector(const StorePath &path) const {
+        return Contains<Vector<bool>>(path) || Contains<Vector<u32>>(path) || Contains<Vector<s32>>(path) || Contains<Vector<float>>(path) || Contains<Vector<std::string>>(path);
+    }
+
     bool Contains(const StorePath &path) const {
-        // xxx this is the only place in the store where we use knowledge about vector paths.
-        return ContainsPrimitive(path) || ContainsPrimitive(path / "0") || Contains<IdPairs>(path);
+        return ContainsPrimitive(path) || ContainsVector(path) || Contains<IdPairs>(path);
+    }
+
+    // Overwrite the store with the provided store.
+    void Set(Store &&other) noexcept {
+        Maps = other.Get();
+        TransientMaps = std::make_unique<TransientStoreMaps>(Transient());
+        TouchedPaths.clear();
+    }
+    void Set(const Store &other) noexcept {
+        Maps = other.Get();
+        TransientMaps = std::make_unique<TransientStoreMaps>(Transient());
+        TouchedPaths.clear();
     }
 
-    // Overwrite the store with the provided store and return the resulting patch.
+    // Same as above, but returns the resulting patch.
     Patch CheckedSet(const Store &store) {
         const auto patch = CreatePatch(store);
         Set(store);
@@ -78,7 +105,12 @@ struct Store : Actionable<Action::Store::Any> {
     // Overwrite the persistent store with all changes since the last commit.
     void Commit() { Set(*this); }
     // Same as `Commit`, but returns the resulting patch.
-    Patch CheckedCommit() { return CheckedSet(Store{*this}); }
+    // Only paths written since the last commit are compared, so this is O(changes) rather than O(store size).
+    Patch CheckedCommit() {
+        auto patch = CreateTouchedPatch(RootPath);
+        Commit();
+        return patch;
+    }
 
     // Create a patch comparing the provided stores.
     Patch CreatePatch(const Store &before, const Store &after, const StorePath &base_path = RootPath) const;
@@ -88,38 +120,34 @@ struct Store : Actionable<Action::Store::Any> {
     // Create a patch comparing the current transient store with the current persistent store.
     // **Resets the transient store to the current persisent store.**
     Patch CreatePatchAndResetTransient(const StorePath &base_path = RootPath) {
-        const auto patch = CreatePatch(*this, Store{*this}, base_path);
+        auto patch = CreateTouchedPatch(base_path);
         TransientMaps = std::make_unique<TransientStoreMaps>(Transient());
+        TouchedPaths.clear();
         return patch;
     }
 
 private:
     StoreMaps Maps;
     std::unique_ptr<TransientStoreMaps> TransientMaps; // If this is non-null, the store is in transient mode.
+    // All paths written (set or erased) in the transient maps since they were last reset to the persistent maps.
+    // A touched path's value may end up unchanged, but every changed path is touched.
+    mutable std::unordered_set<StorePath, PathHash> TouchedPaths;
 
     StoreMaps Get() const { return TransientMaps ? Persistent() : Maps; }
-    void Set(Store &&other) noexcept {
-        Maps = other.Get();
-        TransientMaps = std::make_unique<TransientStoreMaps>(Transient());
-    }
-    void Set(const Store &other) noexcept {
-        Maps = other.Get();
-        TransientMaps = std::make_unique<TransientStoreMaps>(Transient());
-    }
 
     StoreMaps Persistent() const;
     TransientStoreMaps Transient() const;
 
     template<typename ValueType> TransientMap<ValueType> &GetTransientMap() const { return std::get<TransientMap<ValueType>>(*TransientMaps); }
 
-    void ApplyPatch(const Patch &patch) const {
-        for (const auto &[partial_path, op] : patch.Ops) {
-            const auto path = patch.BasePath / partial_path;
-            std::visit([this, &path, &op](auto &&v) {
-                if (op.Op == PatchOpType::Add || op.Op == PatchOpType::Replace) Set(path, std::move(v));
-                else if (op.Op == PatchOpType::Remove) ErasePrimitive(path);
-            },
-                       *op.Value);
-        }
-    }
+    // Create a patch comparing the current transient store with the current persistent store, visiting only `TouchedPaths`.
+    // Produces the same ops as `CreatePatch(*this, Store{*this}, base_path)`.
+    Patch CreateTouchedPatch(const StorePath &base_path) const;
+    template<typename ValueType> void AddTouchedOps(const StorePath &path, const StorePath &relative_path, PatchOps &) const;
+
+    // Ops on vector/set elements (`path/element`) are applied to the container at `path`.
+    void ApplyPatch(const Patch &) const;
+    void ApplyOp(const StorePath &, const PatchOp &) const;
+    template<typename ValueType> void ApplyVectorElementOp(const StorePath &vector_path, u32 index, PatchOpType, const ValueType &) const;
+    template<typename SetType, typename ValueType> void ApplySetElementOp(const StorePath &set_path, PatchOpType, const ValueType &) const;
 };
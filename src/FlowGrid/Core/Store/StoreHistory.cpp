@@ -1,5 +1,6 @@
 #include "StoreHistory.h"
 
+#include <algorithm>
 #include <range/v3/range/conversion.hpp>
 
 #include "immer/map_transient.hpp"
@@ -23,12 +24,18 @@ struct Record {
     Store Store;
     Gesture Gesture;
     StoreHistory::Metrics Metrics;
+    Patch Patch; // From the parent record's store to this record's store.
+    u32 ParentId;
+    u32 Depth; // Distance from the initial record, and the record's index in any branch through it.
+    std::vector<u32> ChildIds{};
+    u32 ActiveChildId{0}; // The most recently added or visited child, followed by redo. Only meaningful if `ChildIds` is non-empty.
 };
 
 struct StoreHistory::Records {
-    Records(const ::Store &initial_store) : Value{{initial_store, Gesture{{}, Clock::now()}, StoreHistory::Metrics{{}}}} {}
+    Records(const ::Store &initial_store) : Value{{initial_store, Gesture{{}, Clock::now()}, StoreHistory::Metrics{{}}, {}, 0, 0}}, Branch{0} {}
 
-    std::vector<Record> Value;
+    std::vector<Record> Value; // Indexed by record ID.
+    std::vector<u32> Branch; // Record IDs of the current branch.
 };
 
 StoreHistory::StoreHistory(const ::Store &store)
@@ -44,51 +51,97 @@ void StoreHistory::Clear() {
 
 void StoreHistory::AddGesture(Gesture &&gesture) {
     const auto store_impl = Store;
-    const auto patch = Store.CreatePatch(CurrentStore(), store_impl);
-    if (patch.Empty()) return;
+    if (auto patch = Store.CreatePatch(CurrentStore(), store_impl); !patch.Empty()) AddGesture(std::move(gesture), patch);
+}
 
+void StoreHistory::AddGesture(Gesture &&gesture, const Patch &patch) {
+    const auto store_impl = Store;
     _Metrics->AddPatch(patch, gesture.CommitTime);
 
-    while (Size() > Index + 1) _Records->Value.pop_back(); // TODO use an undo _tree_ and keep this history
-    _Records->Value.emplace_back(std::move(store_impl), std::move(gesture), *_Metrics);
+    auto &records = _Records->Value;
+    const u32 parent_id = RecordId();
+    const u32 record_id = records.size();
+    records.push_back({std::move(store_impl), std::move(gesture), *_Metrics, patch, parent_id, records[parent_id].Depth + 1});
+    records[parent_id].ChildIds.push_back(record_id);
+    records[parent_id].ActiveChildId = record_id;
+
+    auto &branch = _Records->Branch;
+    branch.resize(Index + 1); // The previous continuation of the branch stays in the tree.
+    branch.push_back(record_id);
     Index = Size() - 1;
 }
 
-u32 StoreHistory::Size() const { return _Records->Value.size(); }
-bool StoreHistory::Empty() const { return Size() <= 1; } // There is always an initial store in the history records.
+u32 StoreHistory::Size() const { return _Records->Branch.size(); }
+u32 StoreHistory::RecordCount() const { return _Records->Value.size(); }
+bool StoreHistory::Empty() const { return RecordCount() <= 1; } // There is always an initial store in the history records.
 bool StoreHistory::CanUndo() const { return Index > 0; }
 bool StoreHistory::CanRedo() const { return Index < Size() - 1; }
 
-const Store &StoreHistory::CurrentStore() const { return _Records->Value[Index].Store; }
+u32 StoreHistory::RecordId() const { return _Records->Branch[Index]; }
+u32 StoreHistory::RecordIdAt(u32 index) const { return _Records->Branch[index]; }
+u32 StoreHistory::ParentRecordId(u32 record_id) const { return _Records->Value[record_id].ParentId; }
+const std::vector<u32> &StoreHistory::ChildRecordIds(u32 record_id) const { return _Records->Value[record_id].ChildIds; }
+
+const Store &StoreHistory::CurrentStore() const { return _Records->Value[RecordId()].Store; }
 
 std::map<StorePath, u32> StoreHistory::GetChangeCountByPath() const {
-    return _Records->Value[Index].Metrics.CommitTimesByPath |
+    return _Records->Value[RecordId()].Metrics.CommitTimesByPath |
         std::views::transform([](const auto &entry) { return std::pair(entry.first, entry.second.size()); }) |
         ranges::to<std::map<StorePath, u32>>;
 }
 
-u32 StoreHistory::GetChangedPathsCount() const { return _Records->Value[Index].Metrics.CommitTimesByPath.size(); }
+u32 StoreHistory::GetChangedPathsCount() const { return _Records->Value[RecordId()].Metrics.CommitTimesByPath.size(); }
 
-Patch StoreHistory::CreatePatch(u32 index) const {
-    return Store.CreatePatch(_Records->Value[index - 1].Store, _Records->Value[index].Store);
-}
+const Patch &StoreHistory::PatchAt(u32 index) const { return _Records->Value[RecordIdAt(index)].Patch; }
 
 StoreHistory::ReferenceRecord StoreHistory::RecordAt(u32 index) const {
-    const auto &record = _Records->Value[index];
+    const auto &record = _Records->Value[RecordIdAt(index)];
     return {record.Store, record.Gesture};
 }
 
 StoreHistory::IndexedGestures StoreHistory::GetIndexedGestures() const {
+    const auto &records = _Records->Value;
     // All recorded gestures except the first, since the first record only holds the initial store with no gestures.
-    Gestures gestures = _Records->Value | std::views::drop(1) | std::views::transform([](const auto &record) { return record.Gesture; }) | ranges::to<std::vector>;
-    return {std::move(gestures), Index};
+    Gestures gestures = records | std::views::drop(1) | std::views::transform([](const auto &record) { return record.Gesture; }) | ranges::to<std::vector>;
+    std::vector<u32> parent_ids = records | std::views::drop(1) | std::views::transform([](const auto &record) { return record.ParentId; }) | ranges::to<std::vector>;
+    // Without branches, each record's parent is the previous record, and the record ID is the branch index.
+    bool is_linear = true;
+    for (u32 i = 0; i < parent_ids.size(); i++) is_linear &= parent_ids[i] == i;
+    if (is_linear) return {std::move(gestures), {}, RecordId()};
+    return {std::move(gestures), std::move(parent_ids), RecordId()};
 }
 
 void StoreHistory::SetIndex(u32 new_index) {
     if (new_index == Index || new_index < 0 || new_index >= Size()) return;
 
     Index = new_index;
-    _Metrics = std::make_unique<Metrics>(_Records->Value[Index].Metrics);
+    if (Index > 0) _Records->Value[RecordIdAt(Index - 1)].ActiveChildId = RecordId();
+    _Metrics = std::make_unique<Metrics>(_Records->Value[RecordId()].Metrics);
+}
+
+void StoreHistory::SetRecordId(u32 record_id) {
+    if (record_id == RecordId() || record_id >= RecordCount()) return;
+
+    SetBranch(record_id);
+    _Metrics = std::make_unique<Metrics>(_Records->Value[record_id].Metrics);
+}
+
+// Make the branch through `record_id` current, with `record_id` as the current record.
+// Only the part of the branch below the nearest ancestor on the current branch is rebuilt,
+// so moving within a branch or to a nearby branch doesn't walk the whole history.
+void StoreHistory::SetBranch(u32 record_id) {
+    auto &records = _Records->Value;
+    auto &branch = _Records->Branch;
+    const auto on_branch = [&](u32 id) { return records[id].Depth < branch.size() && branch[records[id].Depth] == id; };
+
+    u32 ancestor_id = record_id;
+    for (; !on_branch(ancestor_id); ancestor_id = records[ancestor_id].ParentId) {
+        records[records[ancestor_id].ParentId].ActiveChildId = ancestor_id;
+    }
+    branch.resize(records[record_id].Depth + 1);
+    for (u32 id = record_id; id != ancestor_id; id = records[id].ParentId) branch[records[id].Depth] = id;
+    Index = records[record_id].Depth;
+    for (u32 id = record_id; !records[id].ChildIds.empty(); id = records[id].ActiveChildId) branch.push_back(records[id].ActiveChildId);
 }
 
 extern StoreHistory &History; // Global.
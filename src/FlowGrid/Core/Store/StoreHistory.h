@@ -10,6 +10,15 @@ enum Direction {
     Reverse
 };
 
+/**
+The history is a tree of records, each holding a (structurally shared) store snapshot, the gesture that produced it,
+and the patch from its parent record's store.
+Adding a gesture after undoing starts a new branch rather than discarding the undone records.
+
+Index-based methods refer to the _current branch_: the path from the initial record to the current record,
+continuing through the most recently added or visited child of each record after it.
+Undo/redo move along the current branch, and `SetRecordId` switches branches.
+*/
 struct StoreHistory {
     struct Records;
     struct Metrics;
@@ -17,8 +26,9 @@ struct StoreHistory {
     // Used for saving/loading the history.
     // This is all the information needed to reconstruct a project.
     struct IndexedGestures {
-        Gestures Gestures;
-        u32 Index;
+        Gestures Gestures; // All gestures in the tree, in the order they were added. Gesture `i` produced record `i + 1`.
+        std::optional<std::vector<u32>> ParentIds{}; // Parent record ID of each gesture's record. Omitted if the history has no branches.
+        u32 Index; // Current record ID. (Equal to the current branch index if the history has no branches.)
     };
 
     struct ReferenceRecord {
@@ -30,27 +40,40 @@ struct StoreHistory {
     ~StoreHistory();
 
     void Clear();
-    void AddGesture(Gesture &&);
-    void SetIndex(u32);
+    void AddGesture(Gesture &&); // Gestures that don't change the store aren't recorded.
+    // Same as above, but with the patch from the current record's store to the gesture's store provided by the caller,
+    // avoiding a whole-store diff.
+    // Always adds a record, even for an empty patch, so replayed gestures keep the record IDs they were saved with.
+    void AddGesture(Gesture &&, const Patch &);
+    void SetIndex(u32); // Move along the current branch.
+    void SetRecordId(u32); // Move to any record, making its branch current.
 
-    u32 Size() const;
+    u32 Size() const; // Number of records in the current branch.
+    u32 RecordCount() const; // Number of records in the tree.
     bool Empty() const;
     bool CanUndo() const;
     bool CanRedo() const;
 
+    u32 RecordId() const; // ID of the current record.
+    u32 RecordIdAt(u32 index) const; // ID of the record at `index` in the current branch.
+    u32 ParentRecordId(u32 record_id) const; // The initial record is its own parent.
+    const std::vector<u32> &ChildRecordIds(u32 record_id) const; // In the order they were added.
+
     const Store &CurrentStore() const;
-    Patch CreatePatch(u32 index) const; // Create a patch between the store at `index` and the store at `index - 1`.
+    const Patch &PatchAt(u32 index) const; // The patch from the store at `index - 1` to the store at `index` (memoized when the record was added).
     ReferenceRecord RecordAt(u32 index) const;
     IndexedGestures GetIndexedGestures() const; // An action-formmatted project is the result of this method converted directly to JSON.
     std::map<StorePath, u32> GetChangeCountByPath() const; // Ordered by path.
     u32 GetChangedPathsCount() const;
 
-    u32 Index{0};
+    u32 Index{0}; // Index of the current record in the current branch.
 
 private:
+    void SetBranch(u32 record_id);
+
     const Store &Store;
     std::unique_ptr<Records> _Records;
     std::unique_ptr<Metrics> _Metrics;
 };
 
-Json(StoreHistory::IndexedGestures, Gestures, Index);
+Json(StoreHistory::IndexedGestures, Gestures, ParentIds, Index);
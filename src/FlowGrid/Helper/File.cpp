@@ -1,5 +1,6 @@
 #include "File.h"
 
+#include <format>
 #include <fstream>
 #include <optional>
 
@@ -7,7 +8,9 @@
 #include <shlobj.h> // for SHGetFolderPathW
 #include <windows.h>
 #else
+#include <fcntl.h>
 #include <pwd.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <unistd.h>
 #endif
@@ -66,3 +69,32 @@ bool FileIO::write(const fs::path &path, const std::vector<std::uint8_t> &conten
     }
     return false;
 }
+
+FileIO::MappedFile::MappedFile(const fs::path &path) {
+    const fs::path full_path = ExpandPath(path);
+#ifdef _WIN32
+    Contents = read(full_path);
+    Begin = reinterpret_cast<const std::uint8_t *>(Contents.data());
+    Size = Contents.size();
+#else
+    const int fd = open(full_path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error(std::format("Failed to open file: {}", full_path.string()));
+
+    Size = fs::file_size(full_path);
+    if (Size > 0) {
+        void *mapped = mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error(std::format("Failed to memory-map file: {}", full_path.string()));
+        }
+        Begin = static_cast<const std::uint8_t *>(mapped);
+    }
+    close(fd); // The mapping stays valid after the descriptor is closed.
+#endif
+}
+
+FileIO::MappedFile::~MappedFile() {
+#ifndef _WIN32
+    if (Begin) munmap(const_cast<std::uint8_t *>(Begin), Size);
+#endif
+}
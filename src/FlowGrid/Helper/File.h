@@ -1,6 +1,7 @@
 #pragma once
 
 #include <filesystem>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -10,4 +11,20 @@ namespace FileIO {
 std::string read(const fs::path &);
 bool write(const fs::path &, const std::string_view contents);
 bool write(const fs::path &, const std::vector<std::uint8_t> &contents);
+
+// Read-only view of a file's contents, memory-mapped where supported (otherwise read into memory).
+struct MappedFile {
+    explicit MappedFile(const fs::path &); // Throws if the file can't be opened.
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    std::span<const std::uint8_t> Data() const { return {Begin, Size}; }
+
+private:
+    const std::uint8_t *Begin{nullptr};
+    std::size_t Size{0};
+    std::string Contents; // Only used when memory mapping is unavailable.
+};
 } // namespace FileIO
@@ -0,0 +1,101 @@
+#include "PathIds.h"
+
+#include <deque>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+using PathView = std::basic_string_view<StorePath::value_type>;
+
+// FNV-1a, so the hashes of all of a path's prefixes are computed in one pass over it.
+constexpr size_t HashSeed = 14695981039346656037ull;
+constexpr size_t HashStep(size_t hash, StorePath::value_type c) { return (hash ^ size_t(c)) * 1099511628211ull; }
+size_t Hash(PathView path) {
+    size_t hash = HashSeed;
+    for (const auto c : path) hash = HashStep(hash, c);
+    return hash;
+}
+
+// A path (or a prefix of one) with its precomputed hash.
+struct HashedPath {
+    PathView Path;
+    size_t Hash;
+};
+
+struct PathStringHash {
+    using is_transparent = void;
+    size_t operator()(PathView path) const noexcept { return Hash(path); }
+    size_t operator()(const HashedPath &path) const noexcept { return path.Hash; }
+};
+struct PathStringEqual {
+    using is_transparent = void;
+    bool operator()(PathView a, PathView b) const noexcept { return a == b; }
+    bool operator()(const HashedPath &a, PathView b) const noexcept { return a.Path == b; }
+    bool operator()(PathView a, const HashedPath &b) const noexcept { return a == b.Path; }
+};
+
+struct PathEntry {
+    StorePath Path;
+    PathId Parent;
+};
+
+// Function-local statics, so paths can be interned during static initialization.
+std::deque<PathEntry> &Entries() {
+    static std::deque<PathEntry> entries; // A deque keeps `Path` references stable as entries are added.
+    return entries;
+}
+// Keyed by native path string, so prefixes of a path can be looked up without constructing their paths.
+std::unordered_map<StorePath::string_type, PathId, PathStringHash, PathStringEqual> &IdByPath() {
+    static std::unordered_map<StorePath::string_type, PathId, PathStringHash, PathStringEqual> id_by_path;
+    return id_by_path;
+}
+} // namespace
+
+namespace PathIds {
+PathId Intern(const StorePath &path) {
+    auto &id_by_path = IdByPath();
+    if (auto it = id_by_path.find(PathView{path.native()}); it != id_by_path.end()) return it->second;
+
+    auto &entries = Entries();
+    const auto parent_path = path.parent_path();
+    const bool is_root = parent_path == path;
+    const PathId parent_id = is_root ? PathId(entries.size()) : Intern(parent_path);
+    const PathId id = entries.size(); // Interning the parent may have added entries.
+    entries.push_back({path, is_root ? id : parent_id});
+    id_by_path.emplace(path.native(), id);
+    return id;
+}
+
+std::optional<PathId> Find(const StorePath &path) {
+    const auto &id_by_path = IdByPath();
+    if (auto it = id_by_path.find(PathView{path.native()}); it != id_by_path.end()) return it->second;
+    return {};
+}
+
+std::optional<std::pair<PathId, unsigned int>> FindNearest(const StorePath &path) {
+    static constexpr auto Separator = StorePath::value_type('/');
+    const PathView path_view{path.native()};
+
+    // Each ancestor-or-self is a prefix of the path, ending before a separator (or including it, for the root).
+    // Repeated separators are skipped, matching `parent_path`.
+    static std::vector<HashedPath> prefixes; // Reused, since this is only called on the UI thread.
+    prefixes.clear();
+    size_t hash = HashSeed;
+    for (size_t i = 0; i < path_view.size(); ++i) {
+        if (path_view[i] == Separator && i > 0 && path_view[i - 1] != Separator) prefixes.push_back({path_view.substr(0, i), hash});
+        hash = HashStep(hash, path_view[i]);
+        if (i == 0 && path_view[i] == Separator) prefixes.push_back({path_view.substr(0, 1), hash});
+    }
+    if (prefixes.empty() || prefixes.back().Path.size() != path_view.size()) prefixes.push_back({path_view, hash});
+
+    const auto &id_by_path = IdByPath();
+    for (unsigned int depth = 0; depth < prefixes.size(); ++depth) {
+        if (auto it = id_by_path.find(prefixes[prefixes.size() - 1 - depth]); it != id_by_path.end()) return std::pair{it->second, depth};
+    }
+    return {};
+}
+
+PathId Parent(PathId id) { return Entries()[id].Parent; }
+const StorePath &Path(PathId id) { return Entries()[id].Path; }
+} // namespace PathIds
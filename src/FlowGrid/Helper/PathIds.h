@@ -0,0 +1,26 @@
+#pragma once
+
+#include <optional>
+#include <utility>
+
+#include "Path.h"
+
+using PathId = unsigned int;
+
+/**
+Interns paths as compact integer IDs, with a link from each ID to the ID of its parent path.
+A path's full string is hashed once, when it's interned. After that, comparing, hashing, and ancestor walks are integer operations.
+
+IDs are never released, so only intern paths with a bounded lifetime-total count (component paths).
+Look up arbitrary store paths (e.g. patch paths, which include container elements) with `Find`, which never inserts.
+Not thread-safe: only used on the UI thread.
+*/
+namespace PathIds {
+PathId Intern(const StorePath &); // Interns the path and all its ancestors.
+std::optional<PathId> Find(const StorePath &); // The path's ID, if it's interned.
+// The ID of the path's nearest interned ancestor-or-self, and the number of parent steps to reach it.
+// Hashes all of the path's ancestors in one pass over it, without constructing them.
+std::optional<std::pair<PathId, unsigned int>> FindNearest(const StorePath &);
+PathId Parent(PathId); // The root path is its own parent.
+const StorePath &Path(PathId); // Stable for the lifetime of the application.
+} // namespace PathIds
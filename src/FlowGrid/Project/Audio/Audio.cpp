@@ -34,6 +34,7 @@ bool Audio::CanApply(const ActionType &action) const {
 using namespace ImGui;
 
 void Audio::Render() const {
+    Graph.CollectRetired();
     Faust.Draw();
 }
 
@@ -34,7 +34,9 @@ const std::vector<u32> AudioDevice::PrioritizedSampleRates = {
 
 struct Context {
     Context() {
-        if (ma_result result = ma_context_init(nullptr, 0, nullptr, &MaContext); result != MA_SUCCESS) {
+        static const ma_backend offline_backends[]{ma_backend_null};
+        const auto *backends = AudioDevice::Offline ? offline_backends : nullptr;
+        if (ma_result result = ma_context_init(backends, backends ? 1 : 0, nullptr, &MaContext); result != MA_SUCCESS) {
             throw std::runtime_error(std::format("Error initializing audio context: {}", int(result)));
         }
         ScanDevices();
@@ -107,6 +109,11 @@ struct Context {
 
         for (const IO io : IO_All) {
             NativeDataFormats[io].clear();
+            if (AudioDevice::Offline) {
+                // The null backend doesn't report any concrete native formats.
+                for (const u32 sample_rate : AudioDevice::PrioritizedSampleRates) NativeDataFormats[io].emplace_back(ma_format_f32, 2, sample_rate);
+                continue;
+            }
 
             ma_device_info device_info;
             if (result = ma_context_get_device_info(&MaContext, io == IO_In ? ma_device_type_capture : ma_device_type_playback, nullptr, &device_info);
@@ -242,6 +249,8 @@ void AudioDevice::Init() {
         }
     };
 
+    if (Offline) return;
+
     result = ma_device_start(Device.get());
     if (result != MA_SUCCESS) throw std::runtime_error(std::format("Error starting audio {} device: {}", to_string(Type), int(result)));
 
@@ -40,6 +40,11 @@ struct AudioDevice {
     void SetConfig(TargetConfig &&config = {});
 
     static const std::vector<u32> PrioritizedSampleRates;
+
+    // Set before creating any device to render without audio hardware (see `flowgrid_render`).
+    // Offline devices use miniaudio's null backend, report stereo f32 native formats at every prioritized sample rate,
+    // and are never started, so the audio graph is only processed when it's pulled explicitly (see `AudioGraph::RenderOffline`).
+    inline static bool Offline{false};
     static void ScanDevices();
 
     ma_device *Get() const { return Device.get(); }
@@ -30,6 +30,7 @@ bool Faust::CanApply(const ActionType &action) const {
 }
 
 void Faust::Render() const {
+    FaustDsps.ApplyCompileResults();
 }
 
 FaustParamss::FaustParamss(ComponentArgs &&args, const FaustParamsStyle &style)
@@ -66,7 +67,7 @@ FaustGraphs::FaustGraphs(ArgsT &&args, const ::FileDialog &file_dialog, const Fa
       ActionableProducer(std::move(args.Q)),
       FileDialog(file_dialog),
       Style(style), Settings(settings) {
-    Style.FoldComplexity.RegisterChangeListener(this);
+    Style.RegisterChangeListener(this);
     AllInstances.insert(this);
 }
 
@@ -85,6 +86,8 @@ FaustGraph *FaustGraphs::FindGraph(ID dsp_id) const {
 void FaustGraphs::OnComponentChanged() {
     if (Style.FoldComplexity.IsChanged()) {
         for (auto *graph : *this) graph->ResetBox();
+    } else if (Style.IsChanged(true)) {
+        for (auto *graph : *this) graph->InvalidateLayout();
     }
 }
 
@@ -124,10 +127,10 @@ bool FaustGraphs::CanApply(const ActionType &action) const {
 #include "Project/Audio/Sample.h" // Must be included before any Faust includes.
 #include "faust/dsp/llvm-dsp.h"
 
-FaustDSP::FaustDSP(ArgsT &&args, FaustDSPContainer &container, const ::FileDialog &file_dialog)
-    : ActionProducerComponent(std::move(args)), Container(container), FileDialog(file_dialog) {
+FaustDSP::FaustDSP(ArgsT &&args, FaustDSPContainer &container, FaustCompiler &compiler, const ::FileDialog &file_dialog)
+    : ActionProducerComponent(std::move(args)), Container(container), Compiler(compiler), FileDialog(file_dialog) {
     Editor.RegisterChangeListener(this);
-    Init();
+    Update(true);
 }
 
 FaustDSP::~FaustDSP() {
@@ -139,80 +142,76 @@ void FaustDSP::OnComponentChanged() {
     if (Editor.IsChanged()) Update();
 }
 
-void FaustDSP::DestroyDsp() {
-    if (Dsp) {
-        delete Dsp;
-        Dsp = nullptr;
-    }
-    if (DspFactory) {
-        deleteDSPFactory(DspFactory);
-        DspFactory = nullptr;
-    }
+void FaustDSP::Update(bool immediate) {
+    // Changes that leave the code as it was when last requested (e.g. reopening the same file) don't need a recompile.
+    const u64 text_hash = Editor.GetTextHash();
+    if (!immediate && text_hash == RequestedTextHash) return;
+
+    RequestedTextHash = text_hash;
+    Compiler.Request(Id, Editor.GetText(), immediate);
 }
 
-void FaustDSP::Init() {
-    if (Editor.Empty()) return;
-
-    static const std::string libraries_path = fs::relative("../lib/faust/libraries");
-    std::vector<const char *> argv = {"-I", libraries_path.c_str()};
-    if (std::is_same_v<Sample, double>) argv.push_back("-double");
-    const int argc = argv.size();
-
-    const string code = Editor.GetText();
-    static int num_inputs, num_outputs;
-    Box = DSPToBoxes("FlowGrid", code, argc, argv.data(), &num_inputs, &num_outputs, ErrorMessage);
-
-    if (Box && ErrorMessage.empty()) {
-        static const int optimize_level = -1;
-        DspFactory = createDSPFactoryFromBoxes("FlowGrid", Box, argc, argv.data(), "", ErrorMessage, optimize_level);
-        if (DspFactory) {
-            if (ErrorMessage.empty()) {
-                Dsp = DspFactory->createDSPInstance();
-                if (!Dsp) ErrorMessage = "Successfully created Faust DSP factory, but could not create the Faust DSP instance.";
-            } else {
-                deleteDSPFactory(DspFactory);
-                DspFactory = nullptr;
-            }
-        }
-    } else if (!Box && ErrorMessage.empty()) {
-        ErrorMessage = "`DSPToBoxes` returned no error but did not produce a result.";
-    }
-    if (Box && Dsp) Container.NotifyListeners(Added, *this);
+void FaustDSP::OnCompiled(FaustCompileResult &&result) {
+    auto *prev_dsp = Dsp;
+    auto prev_factory = std::move(DspFactory); // Keep the previous factory alive until its DSP instance is destroyed.
+    const bool had_dsp = Box && Dsp;
+    const bool has_dsp = result.Box && result.Dsp;
+    if (had_dsp && !has_dsp) Container.NotifyListeners(Removed, *this);
+
+    Box = result.Box;
+    Dsp = result.Dsp;
+    DspFactory = std::move(result.Factory);
+    ErrorMessage = std::move(result.ErrorMessage);
+
+    // Listeners swap the new DSP into running nodes before the previous DSP is retired.
+    if (had_dsp && has_dsp) Container.NotifyListeners(Changed, *this);
+    else if (has_dsp) Container.NotifyListeners(Added, *this);
+
+    Container.RetireDsp(prev_dsp, std::move(prev_factory));
 }
 
 void FaustDSP::Uninit() {
     Container.NotifyListeners(Removed, *this);
-    if (Dsp || Box) {
-        if (Dsp) DestroyDsp();
-        if (Box) Box = nullptr;
-    }
+    Container.RetireDsp(std::exchange(Dsp, nullptr), std::move(DspFactory));
+    Box = nullptr;
     ErrorMessage = "";
 }
 
-void FaustDSP::Update() {
-    Uninit();
-    Init();
-}
-
 static const string FaustDspPathSegment = "FaustDSP";
 
 FaustDSPs::FaustDSPs(ArgsT &&args, const FileDialog &file_dialog)
     : Vector(std::move(args.Args), [&](auto &&child_args) {
           auto *container = static_cast<Faust *>(child_args.Parent->Parent);
+          const auto *dsps = static_cast<const FaustDSPs *>(child_args.Parent);
           return std::make_unique<FaustDSP>(
-              FaustDSP::ArgsT{std::move(child_args), CreateProducer<FaustDSP::ProducedActionType>()}, *container, file_dialog
+              FaustDSP::ArgsT{std::move(child_args), CreateProducer<FaustDSP::ProducedActionType>()}, *container, *dsps->Compiler, file_dialog
           );
       }),
       ActionableProducer(std::move(args.Q)) {
     createLibContext();
+    Compiler = std::make_unique<FaustCompiler>();
     WindowFlags |= ImGuiWindowFlags_MenuBar;
     EmplaceBack_(FaustDspPathSegment);
 }
 
 FaustDSPs::~FaustDSPs() {
+    Compiler.reset();
     destroyLibContext();
 }
 
+void FaustDSPs::ApplyCompileResults() const {
+    // Listeners walk the new boxes (e.g. to build graphs), so results wait in the queue while the compiler is in the front-end.
+    std::unique_lock front_end_lock{FaustCompiler::FrontEndMutex, std::try_to_lock};
+    if (!front_end_lock) return;
+
+    FaustCompileResult result;
+    while (Compiler->TryDequeue(result)) {
+        auto faust_dsp_it = std::find_if(begin(), end(), [id = result.DspId](const auto *faust_dsp) { return faust_dsp->Id == id; });
+        if (faust_dsp_it != end()) (*faust_dsp_it)->OnCompiled(std::move(result));
+        else delete result.Dsp;
+    }
+}
+
 void Faust::NotifyListeners(NotificationType type, FaustDSP &faust_dsp) {
     const ID id = faust_dsp.Id;
     dsp *dsp = faust_dsp.Dsp;
@@ -262,11 +261,28 @@ void Faust::NotifyListeners(NotificationType type, FaustDSP &faust_dsp) {
     }
 }
 
+void Faust::RetireDsp(dsp *dsp, FaustDspFactory factory) {
+    if (dsp == nullptr) return;
+
+    // The factory is released after its DSP instance is destroyed.
+    std::shared_ptr<::dsp> retired{dsp, [factory = std::move(factory)](::dsp *retired_dsp) { delete retired_dsp; }};
+    for (auto *listener : DspChangeListeners) listener->OnFaustDspRetired(retired);
+}
+
+void Faust::SetParam(dsp *dsp, Real *zone, Real value) {
+    bool applied = false;
+    for (auto *listener : DspChangeListeners) applied |= listener->OnFaustParamChanged(dsp, zone, value);
+    if (!applied) *zone = value;
+}
+
 void FaustDSPs::Apply(const ActionType &action) const {
     std::visit(
         Match{
             [this](const Action::Faust::DSP::Create &) { EmplaceBack(FaustDspPathSegment); },
-            [this](const Action::Faust::DSP::Delete &a) { EraseId(a.id); },
+            [this](const Action::Faust::DSP::Delete &a) {
+                Compiler->Cancel(a.id);
+                EraseId(a.id);
+            },
         },
         action
     );
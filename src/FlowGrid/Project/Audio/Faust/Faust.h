@@ -1,6 +1,7 @@
 #pragma once
 
 #include "FaustAction.h"
+#include "FaustCompiler.h"
 #include "FaustDSPListener.h"
 #include "FaustGraph.h"
 #include "FaustGraphStyle.h"
@@ -85,9 +86,8 @@ private:
     void RenderErrorMessage(string_view error_message) const;
 };
 
-class llvm_dsp_factory;
 enum NotificationType {
-    Changed, // Note: This isn't actually used yet. When the DSP changes, we always Remove/Add the FaustDSP.
+    Changed, // The DSP was recompiled with the same `Id`, and the previous `Dsp` is replaced in place.
     Added,
     Removed
 };
@@ -95,21 +95,29 @@ enum NotificationType {
 struct FaustDSP;
 struct FaustDSPContainer {
     virtual void NotifyListeners(NotificationType, FaustDSP &) = 0;
+    // Destroy a replaced or removed DSP (along with its factory) once no listener is computing it.
+    virtual void RetireDsp(dsp *, FaustDspFactory) = 0;
 };
 
 using FaustDspProducedActionType = Action::Append<Action::Combine<Action::Faust::DSP::Any, Action::TextBuffer::Any>, typename Action::AudioGraph::CreateFaustNode>;
 
 // `FaustDSP` is a wrapper around a Faust DSP and Box.
 // It owns a Faust DSP code buffer, and updates its DSP and Box instances to reflect the current code.
+// Compilation is asynchronous (see `FaustCompiler`): `Box`, `Dsp`, and `ErrorMessage` reflect the latest compiled code,
+// and are updated in `OnCompiled` once a newer compile completes.
 struct FaustDSP : ActionProducerComponent<FaustDspProducedActionType>, Component::ChangeListener {
-    FaustDSP(ArgsT &&, FaustDSPContainer &, const FileDialog &);
+    FaustDSP(ArgsT &&, FaustDSPContainer &, FaustCompiler &, const FileDialog &);
     ~FaustDSP();
 
     void OnComponentChanged() override;
 
+    // Swap in the compiled `Box` and `Dsp`, notifying listeners.
+    void OnCompiled(FaustCompileResult &&);
+
     inline static const std::string FaustDspFileExtension = ".dsp";
 
     FaustDSPContainer &Container;
+    FaustCompiler &Compiler;
     const FileDialog &FileDialog;
     ProducerProp(TextEditor, Editor, FileDialog, fs::path("./res") / "pitch_shifter.dsp");
 
@@ -120,13 +128,11 @@ struct FaustDSP : ActionProducerComponent<FaustDspProducedActionType>, Component
 private:
     void Render() const override;
 
-    void Init();
+    void Update(bool immediate = false); // Request a compile of the current code.
     void Uninit();
-    void Update(); // Sets `Box`, `Dsp`, and `ErrorMessage` based on the current `Code`.
-
-    void DestroyDsp();
 
-    llvm_dsp_factory *DspFactory{nullptr};
+    FaustDspFactory DspFactory{};
+    u64 RequestedTextHash{0}; // See `Update`.
 };
 
 struct FaustDSPs
@@ -140,6 +146,11 @@ struct FaustDSPs
     void Apply(const ActionType &) const override;
     bool CanApply(const ActionType &) const override { return true; }
 
+    // Called every frame to hand off completed compilations to their `FaustDSP`s.
+    void ApplyCompileResults() const;
+
+    std::unique_ptr<FaustCompiler> Compiler;
+
 private:
     void Render() const override;
 };
@@ -163,6 +174,11 @@ struct Faust
     }
 
     void NotifyListeners(NotificationType type, FaustDSP &faust_dsp) override;
+    void RetireDsp(dsp *, FaustDspFactory) override;
+
+    // Set a param zone of `dsp`. Zones of a DSP computed by audio nodes are only written on the audio thread,
+    // so the change is handed to the listeners. Otherwise, nothing is reading the zone concurrently, and it's written immediately.
+    static void SetParam(dsp *, Real *zone, Real value);
 
     inline static std::unordered_set<FaustDSPListener *> DspChangeListeners;
 
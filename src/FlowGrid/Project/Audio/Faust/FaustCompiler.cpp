@@ -0,0 +1,274 @@
+#include "FaustCompiler.h"
+
+#include <format>
+#include <regex>
+#include <unordered_set>
+
+#include "Helper/File.h"
+
+#include "Project/Audio/Sample.h" // Must be included before any Faust includes.
+#include "faust/dsp/llvm-dsp.h"
+
+static const std::string FaustAppName = "FlowGrid";
+
+static const fs::path &GetLibrariesPath() {
+    static const fs::path libraries_path = fs::relative("../lib/faust/libraries");
+    return libraries_path;
+}
+
+static const std::vector<const char *> &GetCompileArgs() {
+    static const std::string libraries_path = GetLibrariesPath().string();
+    static const std::vector<const char *> argv = [] {
+        std::vector<const char *> args = {"-I", libraries_path.c_str()};
+        if (std::is_same_v<Sample, double>) args.push_back("-double");
+        return args;
+    }();
+    return argv;
+}
+
+static std::vector<std::string> FindImports(const std::string &code) {
+    static const std::regex ImportPattern{R"re((?:import|library)\s*\(\s*"([^"]+)"\s*\))re"};
+    std::vector<std::string> imports;
+    for (auto it = std::sregex_iterator(code.begin(), code.end(), ImportPattern); it != std::sregex_iterator(); ++it) {
+        imports.push_back((*it)[1].str());
+    }
+    return imports;
+}
+
+static u64 HashCombine(u64 seed, u64 hash) { return seed ^ (hash + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2)); }
+
+struct ImportedFile {
+    fs::file_time_type WriteTime;
+    u64 Hash;
+    std::vector<std::string> Imports;
+};
+
+// Combine the hashes of all files (transitively) imported by `imports` into `hash`.
+// Imports are resolved like the Faust compiler does: relative to the importing file's directory, then the libraries path.
+// Files are only re-read when their write time changes. Only called on the worker thread.
+static void HashImports(const std::vector<std::string> &imports, const fs::path &dir, std::unordered_set<std::string> &visited, u64 &hash) {
+    static std::unordered_map<std::string, ImportedFile> ImportedFileByPath;
+    for (const auto &import : imports) {
+        std::error_code error;
+        fs::path path = dir / import;
+        if (!fs::exists(path, error)) path = GetLibrariesPath() / import;
+        const auto write_time = fs::last_write_time(path, error);
+        if (error) {
+            // Unresolved imports are reported by the compiler. Still distinguish them from resolved ones.
+            hash = HashCombine(hash, std::hash<std::string>{}(import));
+            continue;
+        }
+        if (!visited.insert(path.string()).second) continue;
+
+        auto it = ImportedFileByPath.find(path.string());
+        if (it == ImportedFileByPath.end() || it->second.WriteTime != write_time) {
+            std::string contents;
+            try {
+                contents = FileIO::read(path);
+            } catch (const std::exception &) {
+                hash = HashCombine(hash, std::hash<std::string>{}(import)); // Unreadable, so hash it like an unresolved import.
+                continue;
+            }
+            it = ImportedFileByPath.insert_or_assign(path.string(), ImportedFile{write_time, std::hash<std::string>{}(contents), FindImports(contents)}).first;
+        }
+        hash = HashCombine(hash, it->second.Hash);
+        HashImports(it->second.Imports, path.parent_path(), visited, hash);
+    }
+}
+
+// The key covers everything that determines the compiled machine code:
+// the code, the contents of all files it imports, the compile arguments, and the machine target.
+// It's stored next to each cached factory on disk, so hash collisions and stale entries are never mistaken for hits.
+static std::string MakeCacheKey(const std::string &code) {
+    static const std::string args_key = [] {
+        std::string key = getDSPMachineTarget();
+        for (const auto *arg : GetCompileArgs()) key += std::format(" {}", arg);
+        return key;
+    }();
+    u64 imports_hash = 0;
+    std::unordered_set<std::string> visited;
+    HashImports(FindImports(code), ".", visited, imports_hash);
+    return std::format("{}\n{:016x}\n{}", args_key, imports_hash, code);
+}
+
+static FaustDspFactory MakeShared(llvm_dsp_factory *factory) {
+    return FaustDspFactory(factory, [](llvm_dsp_factory *f) { deleteDSPFactory(f); });
+}
+
+FaustCompiler::FaustCompiler() : Worker([this] { Run(); }) {}
+
+FaustCompiler::~FaustCompiler() {
+    {
+        std::lock_guard lock{Mutex};
+        Running = false;
+    }
+    JobsChanged.notify_one();
+    Worker.join();
+
+    GenerationResult result;
+    while (Results.try_dequeue(result)) delete result.Result.Dsp;
+}
+
+void FaustCompiler::Request(ID dsp_id, std::string code, bool immediate) {
+    {
+        std::lock_guard lock{Mutex};
+        const u64 generation = ++LatestGeneration[dsp_id];
+        PendingJobs[dsp_id] = {std::move(code), generation, Clock::now() + (immediate ? 0ms : DebounceTime)};
+    }
+    JobsChanged.notify_one();
+}
+
+void FaustCompiler::Cancel(ID dsp_id) {
+    std::lock_guard lock{Mutex};
+    PendingJobs.erase(dsp_id);
+    ++LatestGeneration[dsp_id]; // Drop any in-flight or queued results.
+}
+
+bool FaustCompiler::TryDequeue(FaustCompileResult &result) {
+    GenerationResult generation_result;
+    while (Results.try_dequeue(generation_result)) {
+        bool is_latest;
+        {
+            std::lock_guard lock{Mutex};
+            is_latest = LatestGeneration[generation_result.Result.DspId] == generation_result.Generation;
+        }
+        if (is_latest) {
+            result = std::move(generation_result.Result);
+            return true;
+        }
+        delete generation_result.Result.Dsp;
+    }
+    return false;
+}
+
+bool FaustCompiler::IsIdle() {
+    std::lock_guard lock{Mutex};
+    return PendingJobs.empty() && !Compiling;
+}
+
+void FaustCompiler::Run() {
+    std::unique_lock lock{Mutex};
+    while (true) {
+        JobsChanged.wait(lock, [this] { return !Running || !PendingJobs.empty(); });
+        if (!Running) return;
+
+        // Wait until the earliest pending job is past its debounce window.
+        // New requests replace a DSP's pending job (and reset its window), so we re-check after every wakeup.
+        auto ready_it = std::min_element(PendingJobs.begin(), PendingJobs.end(), [](const auto &a, const auto &b) {
+            return a.second.ReadyTime < b.second.ReadyTime;
+        });
+        if (ready_it->second.ReadyTime > Clock::now()) {
+            JobsChanged.wait_until(lock, ready_it->second.ReadyTime);
+            continue;
+        }
+
+        const ID dsp_id = ready_it->first;
+        Job job = std::move(ready_it->second);
+        PendingJobs.erase(ready_it);
+        Compiling = true;
+
+        lock.unlock();
+        auto result = Compile(dsp_id, job.Code);
+        lock.lock();
+
+        if (LatestGeneration[dsp_id] == job.Generation) Results.enqueue({job.Generation, std::move(result)});
+        else delete result.Dsp; // Cancelled or superseded while compiling.
+        Compiling = false;
+    }
+}
+
+FaustCompileResult FaustCompiler::Compile(ID dsp_id, const std::string &code) const {
+    const auto cache_key = MakeCacheKey(code);
+    FaustCompileResult result{.DspId = dsp_id, .CodeHash = std::hash<std::string>{}(cache_key)};
+    if (code.empty()) return result;
+
+    // Held until the DSP instance is created, since `createDSPFactoryFromBoxes` walks the box too.
+    std::lock_guard front_end_lock{FrontEndMutex};
+    const auto &argv = GetCompileArgs();
+    const int argc = argv.size();
+    static int num_inputs, num_outputs;
+    result.Box = DSPToBoxes(FaustAppName, code, argc, const_cast<const char **>(argv.data()), &num_inputs, &num_outputs, result.ErrorMessage);
+    if (!result.Box) {
+        if (result.ErrorMessage.empty()) result.ErrorMessage = "`DSPToBoxes` returned no error but did not produce a result.";
+        return result;
+    }
+    if (!result.ErrorMessage.empty()) return result;
+
+    result.Factory = FindCachedFactory(result.CodeHash, cache_key);
+    result.CacheHit = bool(result.Factory);
+    if (!result.Factory) {
+        static const int optimize_level = -1;
+        auto *factory = createDSPFactoryFromBoxes(FaustAppName, result.Box, argc, const_cast<const char **>(argv.data()), "", result.ErrorMessage, optimize_level);
+        if (!factory) return result;
+        if (!result.ErrorMessage.empty()) {
+            deleteDSPFactory(factory);
+            return result;
+        }
+        result.Factory = MakeShared(factory);
+        CacheFactory(result.CodeHash, cache_key, result.Factory);
+        WriteCachedFactory(result.CodeHash, cache_key, result.Factory);
+    }
+
+    result.Dsp = result.Factory->createDSPInstance();
+    if (!result.Dsp) result.ErrorMessage = "Successfully created Faust DSP factory, but could not create the Faust DSP instance.";
+    return result;
+}
+
+static fs::path GetCacheFilePath(u64 code_hash, std::string_view extension) { return FaustCompiler::CachePath / std::format("{:016x}.{}", code_hash, extension); }
+
+// The disk cache is best-effort: Any filesystem error (e.g. an unwritable working directory) is treated as a miss,
+// and the in-memory cache still works.
+FaustDspFactory FaustCompiler::FindCachedFactory(u64 code_hash, const std::string &key) const {
+    if (auto it = FactoryByCodeHash.find(code_hash); it != FactoryByCodeHash.end() && it->second.Key == key) {
+        std::erase(FactoryCacheOrder, code_hash);
+        FactoryCacheOrder.push_back(code_hash);
+        return it->second.Factory;
+    }
+
+    const auto cache_file_path = GetCacheFilePath(code_hash, "fbc"), key_file_path = GetCacheFilePath(code_hash, "key");
+    std::error_code error;
+    if (!fs::exists(cache_file_path, error) || !fs::exists(key_file_path, error)) return {};
+
+    llvm_dsp_factory *factory = nullptr;
+    try {
+        if (FileIO::read(key_file_path) != key) return {}; // A different key with the same hash. It will be overwritten.
+
+        std::string error_message;
+        factory = readDSPFactoryFromMachine(FileIO::read(cache_file_path), getDSPMachineTarget(), error_message);
+    } catch (const std::exception &) {
+        return {};
+    }
+    if (!factory) {
+        // Stale or corrupt (e.g. written by a different Faust/LLVM version). It will be recompiled and overwritten.
+        fs::remove(cache_file_path, error);
+        return {};
+    }
+
+    auto shared_factory = MakeShared(factory);
+    CacheFactory(code_hash, key, shared_factory);
+    return shared_factory;
+}
+
+void FaustCompiler::CacheFactory(u64 code_hash, const std::string &key, const FaustDspFactory &factory) const {
+    std::erase(FactoryCacheOrder, code_hash);
+    FactoryCacheOrder.push_back(code_hash);
+    FactoryByCodeHash[code_hash] = {key, factory};
+    while (FactoryCacheOrder.size() > MaxCachedFactories) {
+        FactoryByCodeHash.erase(FactoryCacheOrder.front());
+        FactoryCacheOrder.erase(FactoryCacheOrder.begin());
+    }
+}
+
+void FaustCompiler::WriteCachedFactory(u64 code_hash, const std::string &key, const FaustDspFactory &factory) const {
+    std::error_code error;
+    fs::create_directories(CachePath, error);
+    if (error) return;
+
+    // Remove the key first, and write it last, so a key file only ever describes a complete machine code file.
+    const auto key_file_path = GetCacheFilePath(code_hash, "key");
+    fs::remove(key_file_path, error);
+    if (error) return;
+    if (FileIO::write(GetCacheFilePath(code_hash, "fbc"), writeDSPFactoryToMachine(factory.get(), getDSPMachineTarget()))) {
+        FileIO::write(key_file_path, key);
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "concurrentqueue.h"
+
+#include "Core/Primitive/Scalar.h"
+#include "Helper/Path.h"
+#include "Helper/Time.h"
+
+class CTree;
+typedef CTree *Box;
+class dsp;
+class llvm_dsp_factory;
+
+using FaustDspFactory = std::shared_ptr<llvm_dsp_factory>;
+
+struct FaustCompileResult {
+    ID DspId;
+    u64 CodeHash;
+    Box Box{nullptr};
+    FaustDspFactory Factory{};
+    dsp *Dsp{nullptr}; // Owned by the receiver.
+    std::string ErrorMessage{""};
+    bool CacheHit{false};
+};
+
+/**
+Compiles Faust DSP code on a background thread, so the UI thread never waits on the Faust compiler or LLVM.
+
+* Requests are debounced: A DSP's code is only compiled once no newer code has been requested for it within the debounce window.
+* Stale jobs are cancelled: Only the latest requested code is compiled for each DSP,
+  and results completed after a newer request was made are dropped (but still cached).
+* Factories are cached by the code, the contents of all files it (transitively) imports, and the compile arguments,
+  in memory and on disk (as machine code, see `CachePath`). Disk cache errors are treated as misses.
+  A cache hit still runs the Faust front-end to produce the `Box`, but skips LLVM entirely.
+
+Requests are made, and results are received, on the UI thread.
+Must be destroyed before the Faust lib context.
+*/
+struct FaustCompiler {
+    inline static const auto DebounceTime = 300ms;
+    // Each cached factory is stored as `{hash}.fbc` machine code, next to a `{hash}.key` file holding its full cache key.
+    // Read when compiling.
+    inline static fs::path CachePath = fs::path(".flowgrid") / "faust_cache";
+    inline static const u32 MaxCachedFactories = 16; // In memory. Factories still in use by a `FaustDSP` outlive their cache entry.
+
+    // libfaust's global context and its hash-consed trees are not thread-safe.
+    // The worker holds this mutex for all of its Faust front-end calls, and every other thread must hold it while
+    // calling into the Faust front-end or walking boxes (e.g. building a `FaustGraph`).
+    inline static std::mutex FrontEndMutex;
+
+    FaustCompiler();
+    ~FaustCompiler();
+
+    // Compile `code` for `dsp_id` after the debounce window, or as soon as possible if `immediate`.
+    void Request(ID dsp_id, std::string code, bool immediate = false);
+    void Cancel(ID dsp_id);
+
+    // Returns `false` if there are no (non-stale) results ready.
+    bool TryDequeue(FaustCompileResult &);
+
+    // `true` if no jobs are pending or compiling. Results may still be waiting to be dequeued.
+    bool IsIdle();
+
+private:
+    struct Job {
+        std::string Code;
+        u64 Generation;
+        TimePoint ReadyTime;
+    };
+
+    void Run();
+    FaustCompileResult Compile(ID, const std::string &code) const;
+    FaustDspFactory FindCachedFactory(u64 code_hash, const std::string &key) const;
+    void CacheFactory(u64 code_hash, const std::string &key, const FaustDspFactory &) const; // In memory.
+    void WriteCachedFactory(u64 code_hash, const std::string &key, const FaustDspFactory &) const; // On disk.
+
+    std::mutex Mutex; // Guards `PendingJobs`, `LatestGeneration`, `Running`, and `Compiling`.
+    std::condition_variable JobsChanged;
+    std::unordered_map<ID, Job> PendingJobs;
+    std::unordered_map<ID, u64> LatestGeneration;
+    bool Running{true};
+    bool Compiling{false};
+
+    // Only accessed on the worker thread.
+    struct CachedFactory {
+        std::string Key;
+        FaustDspFactory Factory;
+    };
+    mutable std::unordered_map<u64, CachedFactory> FactoryByCodeHash;
+    mutable std::vector<u64> FactoryCacheOrder; // Least recently used first.
+
+    struct GenerationResult {
+        u64 Generation;
+        FaustCompileResult Result;
+    };
+    moodycamel::ConcurrentQueue<GenerationResult> Results;
+
+    std::thread Worker;
+};
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <memory>
+
+#include "Project/Audio/Sample.h"
+
 using ID = unsigned int;
 
 class dsp;
@@ -7,4 +11,9 @@ struct FaustDSPListener {
     virtual void OnFaustDspChanged(ID, dsp *) = 0;
     virtual void OnFaustDspAdded(ID, dsp *) = 0;
     virtual void OnFaustDspRemoved(ID) = 0;
+    // Called after a replaced or removed DSP's listeners have been notified, with the last reference to it.
+    // Listeners still computing it on another thread keep a reference until they're done, and the DSP is destroyed when the last one is released.
+    virtual void OnFaustDspRetired(std::shared_ptr<dsp>) = 0;
+    // Returns `true` if the listener applies the change (e.g. by handing it to audio nodes computing `dsp`).
+    virtual bool OnFaustParamChanged(dsp *, Real *zone, Real value) = 0;
 };
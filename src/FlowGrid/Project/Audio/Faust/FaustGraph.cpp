@@ -1,8 +1,11 @@
 #include "FaustGraph.h"
 
+#include <atomic>
+#include <memory_resource>
 #include <range/v3/algorithm/contains.hpp>
 #include <range/v3/range/conversion.hpp>
-#include <sstream>
+#include <thread>
+#include <unordered_set>
 
 #include "faust/dsp/libfaust-box.h"
 #include "faust/dsp/libfaust-signal.h"
@@ -10,10 +13,12 @@
 #include "imgui_internal.h"
 
 #include "Core/HelpInfo.h"
+#include "FaustCompiler.h"
 #include "FaustGraphStyle.h"
 #include "Helper/Color.h"
 #include "Helper/File.h"
 #include "Helper/String.h"
+#include "Helper/Variant.h"
 #include "Helper/basen.h"
 #include "Project/Audio/AudioIO.h"
 #include "UI/InvisibleButton.h"
@@ -42,6 +47,10 @@ inline static bool IsLr(const FaustGraphStyle &style, GraphOrientation orientati
     return GlobalDirection(style, orientation) == ImGuiDir_Right;
 }
 
+namespace FlowGrid {
+struct Node;
+}
+
 // Device accepts unscaled positions/sizes.
 struct Device {
     static constexpr float RectLabelPaddingLeft = 3;
@@ -63,6 +72,12 @@ struct Device {
     virtual void Line(const ImVec2 &start, const ImVec2 &end) = 0;
     virtual void Text(const ImVec2 &pos, string_view text, const TextStyle &) = 0;
     virtual void Dot(const ImVec2 &pos, u32 fill_color) = 0;
+    // A box frame. If `interactive`, the fill color reflects the hover/held state of the node being drawn.
+    virtual void Frame(const ImRect &, u32 fill_color, bool interactive) = 0;
+
+    // Wrap the drawing of each node (including its descendents). Drawn relative to the node's position.
+    virtual void BeginNode(const fg::Node &) {}
+    virtual void EndNode(const fg::Node &) {}
 
     virtual void SetCursorPos(const ImVec2 &scaled_cursor_pos) { CursorPosition = scaled_cursor_pos; }
     void AdvanceCursor(const ImVec2 &unscaled_pos) { SetCursorPos(CursorPosition + Scale(unscaled_pos)); }
@@ -70,8 +85,9 @@ struct Device {
     ImVec2 At(const ImVec2 &local_pos) const { return Position + CursorPosition + Scale(local_pos); }
     ImRect At(const ImRect &local_rect) const { return {At(local_rect.Min), At(local_rect.Max)}; }
 
-    ImVec2 Scale(const ImVec2 &p) const { return p * Context.GetScale(); }
-    float Scale(const float f) const { return f * Context.GetScale(); }
+    virtual float GetScale() const { return Context.GetScale(); }
+    ImVec2 Scale(const ImVec2 &p) const { return p * GetScale(); }
+    float Scale(const float f) const { return f * GetScale(); }
 
     const FaustGraph &Context;
     const FaustGraphStyle &Style;
@@ -104,15 +120,18 @@ static inline string GetFontBase64() {
 }
 
 // todo: Fix rendering SVG with `DecorateRootNode = false` (and generally get it back to its former self).
+// Renders into an in-memory buffer, so files can be rendered in parallel, and only written if their contents changed.
+// Only reads ImGui state (font metrics), so it's safe to render multiple SVG devices concurrently
+// as long as the UI thread isn't rendering ImGui (and `GetFontBase64` has been called at least once).
 struct SVGDevice : Device {
-    SVGDevice(const FaustGraph &context, fs::path Directory, string FileName, ImVec2 size)
-        : Device(context), Directory(std::move(Directory)), FileName(std::move(FileName)) {
+    SVGDevice(const FaustGraph &context, float scale, ImVec2 size) : Device(context), ScaleFactor(scale) {
         const auto &[w, h] = Scale(size);
-        Stream << std::format(R"(<svg xmlns="http://www.w3.org/2000/svg" viewBox="0 0 {} {}")", w, h);
-        Stream << (Style.ScaleFillHeight ? R"( height="100%">)" : std::format(R"( width="{}" height="{}">)", w, h));
+        Write(R"(<svg xmlns="http://www.w3.org/2000/svg" viewBox="0 0 {} {}")", w, h);
+        if (Style.ScaleFillHeight) Buffer += R"( height="100%">)";
+        else Write(R"( width="{}" height="{}">)", w, h);
 
         // Embed the current font as a base64-encoded string.
-        Stream << std::format(R"(
+        Write(R"(
         <defs><style>
             @font-face{{
                 font-family:"{}";
@@ -123,12 +142,18 @@ struct SVGDevice : Device {
                               GetFontName(), GetFontBase64());
     }
 
-    ~SVGDevice() override {
-        Stream << "</svg>\n";
-        FileIO::write(Directory / FileName, Stream.str());
+    DeviceType Type() override { return DeviceType_SVG; }
+    float GetScale() const override { return ScaleFactor; }
+
+    // Close the document and return its contents.
+    string Finish() {
+        Buffer += "</svg>\n";
+        return std::move(Buffer);
     }
 
-    DeviceType Type() override { return DeviceType_SVG; }
+    template<typename... Args> void Write(std::format_string<Args...> format, Args &&...args) {
+        std::format_to(std::back_inserter(Buffer), format, std::forward<Args>(args)...);
+    }
 
     static string XmlSanitize(string copy) {
         static std::unordered_map<char, string> Replacements{{'<', "&lt;"}, {'>', "&gt;"}, {'\'', "&apos;"}, {'"', "&quot;"}, {'&', "&amp;"}};
@@ -154,14 +179,14 @@ struct SVGDevice : Device {
     void Rect(const ImRect &local_rect, const RectStyle &style) override {
         const auto &rect = At(local_rect);
         const auto &[fill_color, stroke_color, stroke_width, corner_radius] = style;
-        Stream << std::format(R"(<rect x="{}" y="{}" width="{}" height="{}" rx="{}" style="stroke:{};stroke-width={};fill:{};"/>)", rect.Min.x, rect.Min.y, rect.GetWidth(), rect.GetHeight(), corner_radius, RgbColor(stroke_color), stroke_width, RgbColor(fill_color));
+        Write(R"(<rect x="{}" y="{}" width="{}" height="{}" rx="{}" style="stroke:{};stroke-width={};fill:{};"/>)", rect.Min.x, rect.Min.y, rect.GetWidth(), rect.GetHeight(), corner_radius, RgbColor(stroke_color), stroke_width, RgbColor(fill_color));
     }
 
     // Only SVG device has a rect-with-link method
     void Rect(const ImRect &local_rect, const RectStyle &style, string_view link) {
-        if (!link.empty()) Stream << std::format(R"(<a href="{}">)", XmlSanitize(string(link)));
+        if (!link.empty()) Write(R"(<a href="{}">)", XmlSanitize(string(link)));
         Rect(local_rect, style);
-        if (!link.empty()) Stream << "</a>";
+        if (!link.empty()) Buffer += "</a>";
     }
 
     // todo port ImGui implementation changes here, and use that one arg to make rounded rect path go clockwise (there is one).
@@ -174,7 +199,7 @@ struct SVGDevice : Device {
         const ImVec2 &text_right = {min(text_x + CalcTextSize(string(label)).x, tr.x), tr.y};
         const float r = Scale(rect_style.CornerRadius);
         // Going counter-clockwise instead of clockwise, like in the ImGui implementation, since that's what paths expect for corner rounding to work.
-        Stream << std::format(
+        Write(
             R"(<path d="m{},{} h{} a{},{} 0 00 {},{} v{} a{},{} 0 00 {},{} h{} a{},{} 0 00 {},{} v{} a{},{} 0 00 {},{} h{}" stroke-width="{}" stroke="{}" fill="none"/>)", text_x - Scale(text_style.Padding.Left), tl.y, Scale(text_style.Padding.Right - label_offset) + r, r, r, -r, r, // before text to top-left
             rect.GetHeight() - 2 * r, r, r, r, r, // top-left to bottom-left
             rect.GetWidth() - 2 * r, r, r, r, -r, // bottom-left to bottom-right
@@ -182,20 +207,20 @@ struct SVGDevice : Device {
             -(tr.x - r - text_right.x), // top-right to after text
             Scale(rect_style.StrokeWidth), RgbColor(rect_style.StrokeColor)
         );
-        Stream << std::format(R"(<text x="{}" y="{}" font-family="{}" font-size="{}" fill="{}" dominant-baseline="middle">{}</text>)", text_x, tl.y, GetFontName(), GetFontSize(), RgbColor(text_style.Color), XmlSanitize(string(label)));
+        Write(R"(<text x="{}" y="{}" font-family="{}" font-size="{}" fill="{}" dominant-baseline="middle">{}</text>)", text_x, tl.y, GetFontName(), GetFontSize(), RgbColor(text_style.Color), XmlSanitize(string(label)));
     }
 
     void Triangle(const ImVec2 &p1, const ImVec2 &p2, const ImVec2 &p3, u32 color) override {
-        Stream << CreateTriangle(At(p1), At(p2), At(p3), Col32(0, 0, 0, 0), color);
+        Buffer += CreateTriangle(At(p1), At(p2), At(p3), Col32(0, 0, 0, 0), color);
     }
 
     void Circle(const ImVec2 &pos, float radius, u32 fill_color, u32 stroke_color) override {
         const auto [x, y] = At(pos);
-        Stream << std::format(R"(<circle fill="{}" stroke="{}" stroke-width=".5" cx="{}" cy="{}" r="{}"/>)", RgbColor(fill_color), RgbColor(stroke_color), x, y, radius);
+        Write(R"(<circle fill="{}" stroke="{}" stroke-width=".5" cx="{}" cy="{}" r="{}"/>)", RgbColor(fill_color), RgbColor(stroke_color), x, y, radius);
     }
 
     void Arrow(const ImVec2 &pos, GraphOrientation orientation) override {
-        Stream << ArrowPointingAt(At(pos), Scale(Style.ArrowSize), orientation, Style.Colors[FlowGridGraphCol_Line]);
+        Buffer += ArrowPointingAt(At(pos), Scale(Style.ArrowSize), orientation, Style.Colors[FlowGridGraphCol_Line]);
     }
 
     void Line(const ImVec2 &start, const ImVec2 &end) override {
@@ -203,7 +228,7 @@ struct SVGDevice : Device {
         const auto start_scaled = At(start), end_scaled = At(end);
         const auto color = RgbColor(Style.Colors[FlowGridGraphCol_Line]);
         const auto width = Scale(Style.WireThickness);
-        Stream << std::format(R"(<line x1="{}" y1="{}" x2="{}" y2="{}"  style="stroke:{}; stroke-linecap:{}; stroke-width:{};"/>)", start_scaled.x, start_scaled.y, end_scaled.x, end_scaled.y, color, line_cap, width);
+        Write(R"(<line x1="{}" y1="{}" x2="{}" y2="{}"  style="stroke:{}; stroke-linecap:{}; stroke-width:{};"/>)", start_scaled.x, start_scaled.y, end_scaled.x, end_scaled.y, color, line_cap, width);
     }
 
     void Text(const ImVec2 &pos, string_view text, const TextStyle &style) override {
@@ -212,27 +237,29 @@ struct SVGDevice : Device {
         const string font_formatted = font == FontStyle_Italic ? "italic" : "normal";
         const string weight = font == FontStyle_Bold ? "bold" : "normal";
         const auto &p = At(pos - ImVec2{style.Padding.Right, style.Padding.Bottom});
-        Stream << std::format(R"(<text x="{}" y="{}" font-family="{}" font-style="{}" font-weight="{}" font-size="{}" text-anchor="{}" fill="{}" dominant-baseline="middle">{}</text>)", p.x, p.y, GetFontName(), font_formatted, weight, GetFontSize(), anchor, RgbColor(color), XmlSanitize(string(text)));
+        Write(R"(<text x="{}" y="{}" font-family="{}" font-style="{}" font-weight="{}" font-size="{}" text-anchor="{}" fill="{}" dominant-baseline="middle">{}</text>)", p.x, p.y, GetFontName(), font_formatted, weight, GetFontSize(), anchor, RgbColor(color), XmlSanitize(string(text)));
     }
 
     // Only SVG device has a text-with-link method
     void Text(const ImVec2 &pos, string_view str, const TextStyle &style, string_view link) {
-        if (!link.empty()) Stream << std::format(R"(<a href="{}">)", XmlSanitize(string(link)));
+        if (!link.empty()) Write(R"(<a href="{}">)", XmlSanitize(string(link)));
         Text(pos, str, style);
-        if (!link.empty()) Stream << "</a>";
+        if (!link.empty()) Buffer += "</a>";
     }
 
     void Dot(const ImVec2 &pos, u32 fill_color) override {
         const auto &p = At(pos);
         const float radius = Scale(Style.OrientationMarkRadius);
-        Stream << std::format(R"(<circle cx="{}" cy="{}" r="{}" fill="{}"/>)", p.x, p.y, radius, RgbColor(fill_color));
+        Write(R"(<circle cx="{}" cy="{}" r="{}" fill="{}"/>)", p.x, p.y, radius, RgbColor(fill_color));
     }
 
-    fs::path Directory;
-    string FileName;
+    void Frame(const ImRect &local_rect, u32 fill_color, bool) override {
+        Rect(local_rect, {.FillColor = fill_color, .CornerRadius = Style.BoxCornerRadius});
+    }
 
 private:
-    std::stringstream Stream;
+    float ScaleFactor;
+    string Buffer;
 };
 
 struct ImGuiDevice : Device {
@@ -328,6 +355,12 @@ struct ImGuiDevice : Device {
         DrawList->AddCircleFilled(At(p), radius, fill_color);
     }
 
+    void Frame(const ImRect &local_rect, u32 fill_color, bool interactive) override {
+        if (interactive) fill_color = GetColorU32(NodeFlags & InteractionFlags_Held ? ImGuiCol_ButtonActive : (NodeFlags & InteractionFlags_Hovered ? ImGuiCol_ButtonHovered : ImGuiCol_Button));
+        RenderFrame(At(local_rect.Min), At(local_rect.Max), fill_color, false, Style.BoxCornerRadius);
+    }
+
+    InteractionFlags NodeFlags{InteractionFlags_None}; // Interaction state of the node being drawn.
     ImGuiWindowTempData &DC; // Safe to store directly, since the device is recreated each frame.
     ImDrawList *DrawList;
 };
@@ -446,20 +479,21 @@ struct Node {
     const FaustGraph &Context;
     const FaustGraphStyle &Style;
     const Tree FaustTree;
+    const string TreeName; // Cached, so boxes aren't walked outside of building the graph.
     const string Id, Text, BoxTypeLabel; // TODO can we get rid of `Id` now that we have `ImGuiId`?
     const u32 InCount, OutCount;
     const u32 Descendents = 0; // The number of boxes within this node (recursively).
     Node *A{}, *B{}; // Nodes have at most two children.
 
     u32 Index{0}; // Position in the parent's list of children.
-    ID ImGuiId;
+    ID ImGuiId{0};
 
     ImVec2 Size;
     ImVec2 Position; // Relative to parent.
     GraphOrientation Orientation = GraphForward;
 
     Node(const FaustGraph &context, Tree tree, u32 in_count, u32 out_count, Node *a = nullptr, Node *b = nullptr, string text = "", bool is_block = false)
-        : Context(context), Style(context.Style), FaustTree(tree), Id(UniqueId(FaustTree)), Text(!text.empty() ? std::move(text) : GetTreeName(FaustTree)),
+        : Context(context), Style(context.Style), FaustTree(tree), TreeName(GetTreeName(FaustTree)), Id(UniqueId(FaustTree)), Text(!text.empty() ? std::move(text) : TreeName),
           BoxTypeLabel(GetBoxType(FaustTree)), InCount(in_count), OutCount(out_count),
           Descendents((is_block ? 1 : 0) + (a ? a->Descendents : 0) + (b ? b->Descendents : 0)), A(a), B(b) {
         if (A) A->Index = 0;
@@ -474,13 +508,16 @@ struct Node {
     virtual void GenerateIds(ID parent_id) {
         ImGuiId = GenerateId(parent_id, Index);
         Context.NodeByImGuiId[ImGuiId] = this;
-        HelpInfo::ById.emplace(ImGuiId, HelpInfo{.Name = GetBoxType(FaustTree), .Help = ""});
+        HelpInfo::ById.emplace(ImGuiId, HelpInfo{.Name = BoxTypeLabel, .Help = ""});
         if (A) A->GenerateIds(ImGuiId);
         if (B) B->GenerateIds(ImGuiId);
     }
 
     u32 IoCount(IO io) const { return io == IO_In ? InCount : OutCount; };
 
+    // All owned child nodes, including ones that aren't drawn inline (like a folded `BlockNode`'s inner node).
+    virtual std::array<Node *, 2> Children() const { return {A, B}; }
+
     // IO point relative to self.
     virtual ImVec2 Point(IO io, u32 channel) const {
         return {
@@ -491,41 +528,43 @@ struct Node {
     // IO point relative to parent.
     ImVec2 ChildPoint(IO io, u32 channel) const { return Position + Point(io, channel); }
 
-    virtual void Place(const DeviceType) = 0;
+    u32 PlacedGeneration{0};
+    DeviceType PlacedDeviceType;
+    GraphOrientation PlacedOrientation;
+
+    // Only re-places if the graph's layout was invalidated, or the device type or orientation changed since the last placement.
+    void Place(const DeviceType type) {
+        if (PlacedGeneration == Context.LayoutGeneration && PlacedDeviceType == type && PlacedOrientation == Orientation) return;
+
+        DoPlace(type);
+        PlacedGeneration = Context.LayoutGeneration;
+        PlacedDeviceType = type;
+        PlacedOrientation = Orientation;
+    }
 
     void Draw(Device &device) const {
-        const bool is_imgui = device.Type() == DeviceType_ImGui;
         const auto before_cursor = device.CursorPosition;
         device.AdvanceCursor(Position);
-
-        InteractionFlags flags = InteractionFlags_None;
-        if (is_imgui) {
-            PushOverrideID(ImGuiId);
-            const auto before_cursor_inner = device.CursorPosition;
-            const auto &local_rect = GetFrameRect();
-            device.AdvanceCursor(local_rect.Min);
-            flags |= fg::InvisibleButton(local_rect.GetSize() * Context.GetScale(), "");
-            SetItemAllowOverlap();
-            device.SetCursorPos(before_cursor_inner);
-        }
-
-        Render(device, flags);
+        device.BeginNode(*this);
+        Render(device);
         if (A) A->Draw(device);
         if (B) B->Draw(device);
-
-        if (flags & InteractionFlags_Hovered) {
-            const auto &flags = Context.Settings.HoverFlags;
-            // todo get abs pos by traversing through ancestors
-            if (flags & FaustGraphHoverFlags_ShowRect) DrawRect(device);
-            if (flags & FaustGraphHoverFlags_ShowType) DrawType(device);
-            if (flags & FaustGraphHoverFlags_ShowChannels) DrawChannelLabels(device);
-            if (flags & FaustGraphHoverFlags_ShowChildChannels) DrawChildChannelLabels(device);
-        }
-
-        if (is_imgui) PopID();
+        device.EndNode(*this);
         device.SetCursorPos(before_cursor);
     };
 
+    virtual void OnInteraction(InteractionFlags) const {}
+
+    void DrawHovered(Device &device) const {
+        const auto &flags = Context.Settings.HoverFlags;
+        if (flags & FaustGraphHoverFlags_ShowRect) DrawRect(device);
+        if (flags & FaustGraphHoverFlags_ShowType) DrawType(device);
+        if (flags & FaustGraphHoverFlags_ShowChannels) DrawChannelLabels(device);
+        if (flags & FaustGraphHoverFlags_ShowChildChannels) DrawChildChannelLabels(device);
+    }
+
+    ImRect GetFrameRect() const { return {Margin(), Size - Margin()}; }
+
     virtual ImVec2 Margin() const { return Style.NodeMargin; }
     virtual ImVec2 Padding() const { return Style.NodePadding; } // Currently only actually used for `BlockNode` text
 
@@ -586,24 +625,24 @@ struct Node {
     // If this is not the (singular) process node, append its tree's hex address (without the '0x' prefix) to make the file name unique.
     string SvgFileName() const {
         if (!FaustTree) return "";
+        if (TreeName == "process") return TreeName + SvgFileExtension;
 
-        const string tree_name = GetTreeName(FaustTree);
-        if (tree_name == "process") return tree_name + SvgFileExtension;
-
-        const string name_limited = std::views::take_while(tree_name, [](char c) { return std::isalnum(c); }) | std::views::take(16) | ranges::to<string>;
+        const string name_limited = std::views::take_while(TreeName, [](char c) { return std::isalnum(c); }) | std::views::take(16) | ranges::to<string>;
         return std::format("{}-{}{}", name_limited, Id, SvgFileExtension);
     }
 
-    void WriteSvg(const fs::path &path) const {
-        SVGDevice device(Context, path, SvgFileName(), Size);
+    // Assumes the node has been placed for the SVG device.
+    // Folded nodes only link to their inner node's file. See `FaustGraph::SaveBoxSvg`.
+    string RenderSvg(float scale) const {
+        SVGDevice device(Context, scale, Size);
         device.Rect(*this, {.FillColor = Style.Colors[FlowGridGraphCol_Bg]}); // todo this should be done in both cases
         Draw(device);
+        return device.Finish();
     }
 
 protected:
-    virtual void Render(Device &, InteractionFlags flags = InteractionFlags_None) const = 0;
-
-    ImRect GetFrameRect() const { return {Margin(), Size - Margin()}; }
+    virtual void DoPlace(const DeviceType) = 0;
+    virtual void Render(Device &) const = 0;
 
     // Draw the orientation mark in the corner on the inputs side (respecting global direction setting), like in integrated circuits.
     // Marker on top: Forward orientation. Inputs go from top to bottom.
@@ -620,6 +659,239 @@ protected:
 
 using namespace fg;
 
+/**
+Owns all nodes of a graph, allocated from a pool resource, so rebuilding a graph recycles the memory of its previous nodes.
+
+Nodes built by `FaustGraph::Tree2Node` are memoized by their box, and reused across rebuilds (e.g. after recompiling),
+so unchanged regions of the program keep their nodes (and cached layout).
+This relies on Faust boxes being hash-consed: The same (sub)expression always maps to the same `Box`
+for the lifetime of the Faust lib context.
+
+Since each node has a single parent, a memoized node is only reused if neither it nor any of its descendents
+is already claimed by the tree being built.
+*/
+struct FaustGraphNodeArena {
+    ~FaustGraphNodeArena() {
+        for (auto &[node, allocation] : AllocationByNode) Destroy(node, allocation);
+    }
+
+    template<typename NodeType, typename... Args> NodeType *New(Args &&...args) {
+        void *memory = Resource.allocate(sizeof(NodeType), alignof(NodeType));
+        auto *node = new (memory) NodeType(std::forward<Args>(args)...);
+        AllocationByNode.emplace(node, Allocation{memory, sizeof(NodeType), alignof(NodeType)});
+        FaustGraph::LiveNodeCount++;
+        FaustGraph::CreatedNodeCount++;
+        return node;
+    }
+
+    u32 Size() const { return AllocationByNode.size(); }
+
+    // Start building a new tree. Nodes of the previous tree become available for reuse.
+    void BeginBuild() {
+        Claimed.clear();
+        IsPureRoutingByBox.clear();
+    }
+
+    // Returns a node previously built for `box`, with no claimed nodes in its subtree (claiming them all), or `nullptr`.
+    Node *Reuse(Box box) {
+        auto it = NodesByBox.find(box);
+        if (it == NodesByBox.end()) return nullptr;
+
+        for (auto *node : it->second) {
+            if (IsSubtreeUnclaimed(node)) {
+                Claim(node);
+                return node;
+            }
+        }
+        return nullptr;
+    }
+
+    void Memoize(Box box, Node *node) {
+        auto &nodes = NodesByBox[box];
+        if (std::ranges::find(nodes, node) == nodes.end()) nodes.push_back(node);
+        Claimed.insert(node);
+    }
+
+    // Forget all memoized boxes, so the next build creates all-new nodes (e.g. after a change to how boxes are folded).
+    void Clear() {
+        NodesByBox.clear();
+        Claimed.clear();
+        IsPureRoutingByBox.clear();
+    }
+
+    // Trees only made of cuts, wires, or slots ("pure routing" trees). Memoized for the tree being built.
+    bool IsPureRouting(Box box) {
+        if (auto it = IsPureRoutingByBox.find(box); it != IsPureRoutingByBox.end()) return it->second;
+
+        Tree x, y;
+        const bool is_pure_routing = isBoxCut(box) || isBoxWire(box) || isBoxInverter(box) || isBoxSlot(box) ||
+            (isBoxBinary(box, x, y) && IsPureRouting(x) && IsPureRouting(y));
+        IsPureRoutingByBox.emplace(box, is_pure_routing);
+        return is_pure_routing;
+    }
+
+    // Destroy all nodes not reachable from `root`.
+    void Sweep(const Node *root) {
+        std::unordered_set<const Node *> reachable;
+        std::vector<const Node *> stack;
+        if (root) stack.push_back(root);
+        while (!stack.empty()) {
+            const auto *node = stack.back();
+            stack.pop_back();
+            if (!reachable.insert(node).second) continue;
+            for (const auto *child : node->Children()) {
+                if (child) stack.push_back(child);
+            }
+        }
+
+        std::erase_if(AllocationByNode, [this, &reachable](const auto &entry) {
+            if (reachable.contains(entry.first)) return false;
+            Destroy(entry.first, entry.second);
+            return true;
+        });
+        for (auto &[box, nodes] : NodesByBox) std::erase_if(nodes, [&reachable](const auto *node) { return !reachable.contains(node); });
+        std::erase_if(NodesByBox, [](const auto &entry) { return entry.second.empty(); });
+        std::erase_if(Claimed, [&reachable](const auto *node) { return !reachable.contains(node); });
+    }
+
+private:
+    struct Allocation {
+        void *Memory;
+        size_t Size, Alignment;
+    };
+
+    bool IsSubtreeUnclaimed(const Node *node) const {
+        if (Claimed.contains(node)) return false;
+        for (const auto *child : node->Children()) {
+            if (child && !IsSubtreeUnclaimed(child)) return false;
+        }
+        return true;
+    }
+
+    void Claim(Node *node) {
+        Claimed.insert(node);
+        for (auto *child : node->Children()) {
+            if (child) Claim(child);
+        }
+    }
+
+    void Destroy(Node *node, const Allocation &allocation) {
+        node->~Node();
+        Resource.deallocate(allocation.Memory, allocation.Size, allocation.Alignment);
+        FaustGraph::LiveNodeCount--;
+    }
+
+    std::pmr::unsynchronized_pool_resource Resource;
+    std::unordered_map<Node *, Allocation> AllocationByNode;
+    std::unordered_map<Box, std::vector<Node *>> NodesByBox;
+    std::unordered_set<const Node *> Claimed; // Nodes in the tree being built (or most recently built).
+    std::unordered_map<Box, bool> IsPureRoutingByBox;
+};
+
+template<typename NodeType, typename... Args> static NodeType *MakeNode(const FaustGraph &context, Args &&...args) {
+    return context.Arena->New<NodeType>(context, std::forward<Args>(args)...);
+}
+
+namespace DrawCommand {
+// `Bounds` covers the node and all its descendents. `EndIndex` is the index of the matching `EndNode`.
+struct BeginNode {
+    const Node *GraphNode;
+    ImRect Bounds;
+    u32 EndIndex{0};
+};
+struct EndNode {
+    const Node *GraphNode;
+    ImVec2 Origin;
+};
+struct Rect {
+    ImRect Area;
+    RectStyle Style;
+};
+struct LabeledRect {
+    ImRect Area;
+    string Label;
+    RectStyle Style;
+    TextStyle LabelStyle;
+};
+struct Triangle {
+    ImVec2 P1, P2, P3;
+    u32 Color;
+};
+struct Circle {
+    ImVec2 Position;
+    float Radius;
+    u32 FillColor, StrokeColor;
+};
+struct Arrow {
+    ImVec2 Position;
+    GraphOrientation Orientation;
+};
+struct Line {
+    ImVec2 Start, End;
+};
+struct Text {
+    ImVec2 Position;
+    string Value;
+    TextStyle Style;
+};
+struct Dot {
+    ImVec2 Position;
+    u32 FillColor;
+};
+struct Frame {
+    ImRect Area;
+    u32 FillColor;
+    bool Interactive;
+};
+
+using Any = std::variant<BeginNode, EndNode, Rect, LabeledRect, Triangle, Circle, Arrow, Line, Text, Dot, Frame>;
+} // namespace DrawCommand
+
+// The flattened, unscaled draw commands of the focused node, relative to its origin.
+// Replayed every frame with viewport culling, and only re-recorded when the focused node, font size, or layout changes.
+struct FaustGraphDrawList {
+    const Node *Focused;
+    float FontSize;
+    u32 LayoutGeneration;
+    std::vector<DrawCommand::Any> Commands;
+};
+
+// Records unscaled draw commands into a `FaustGraphDrawList`, to be replayed into an `ImGuiDevice`.
+struct RecordingDevice : Device {
+    RecordingDevice(const FaustGraph &context, FaustGraphDrawList &draw_list) : Device(context), DrawList(draw_list) {}
+
+    DeviceType Type() override { return DeviceType_ImGui; }
+    float GetScale() const override { return 1; }
+
+    void Rect(const ImRect &local_rect, const RectStyle &style) override { Record(DrawCommand::Rect{At(local_rect), style}); }
+    void LabeledRect(const ImRect &local_rect, string_view label, const RectStyle &rect_style, const TextStyle &text_style) override {
+        Record(DrawCommand::LabeledRect{At(local_rect), string(label), rect_style, text_style});
+    }
+    void Triangle(const ImVec2 &p1, const ImVec2 &p2, const ImVec2 &p3, u32 color) override { Record(DrawCommand::Triangle{At(p1), At(p2), At(p3), color}); }
+    void Circle(const ImVec2 &pos, float radius, u32 fill_color, u32 stroke_color) override { Record(DrawCommand::Circle{At(pos), radius, fill_color, stroke_color}); }
+    void Arrow(const ImVec2 &pos, GraphOrientation orientation) override { Record(DrawCommand::Arrow{At(pos), orientation}); }
+    void Line(const ImVec2 &start, const ImVec2 &end) override { Record(DrawCommand::Line{At(start), At(end)}); }
+    void Text(const ImVec2 &pos, string_view text, const TextStyle &style) override { Record(DrawCommand::Text{At(pos), string(text), style}); }
+    void Dot(const ImVec2 &pos, u32 fill_color) override { Record(DrawCommand::Dot{At(pos), fill_color}); }
+    void Frame(const ImRect &local_rect, u32 fill_color, bool interactive) override { Record(DrawCommand::Frame{At(local_rect), fill_color, interactive}); }
+
+    void BeginNode(const Node &node) override {
+        BeginIndices.push_back(DrawList.Commands.size());
+        Record(DrawCommand::BeginNode{&node, At(ImRect(node))});
+    }
+    void EndNode(const Node &node) override {
+        std::get<DrawCommand::BeginNode>(DrawList.Commands[BeginIndices.back()]).EndIndex = DrawList.Commands.size();
+        BeginIndices.pop_back();
+        Record(DrawCommand::EndNode{&node, At({0, 0})});
+    }
+
+private:
+    void Record(DrawCommand::Any &&command) { DrawList.Commands.emplace_back(std::move(command)); }
+
+    FaustGraphDrawList &DrawList;
+    std::vector<u32> BeginIndices;
+};
+
 // A simple rectangular box with text and inputs/outputs.
 struct BlockNode : Node {
     BlockNode(const FaustGraph &context, Tree tree, u32 in_count, u32 out_count, string text, FlowGridGraphCol color = FlowGridGraphCol_Normal, Node *inner = nullptr)
@@ -632,18 +904,19 @@ struct BlockNode : Node {
         if (Inner) Inner->GenerateIds(ImGuiId);
     }
 
-    void Place(const DeviceType type) override {
+    std::array<Node *, 2> Children() const override { return {Inner, nullptr}; }
+
+    void DoPlace(const DeviceType type) override {
         const auto text_size = CalcTextSize(string(Text));
         Size = Margin() * 2 +
             ImVec2{
                 max(Style.NodeMinSize.X(), text_size.x + Padding().x * 2),
                 max(Style.NodeMinSize.Y(), max(text_size.y, float(max(InCount, OutCount)) * WireGap())),
             };
-        if (Inner && type == DeviceType_SVG) Inner->Place(type);
     }
 
-    void Render(Device &device, InteractionFlags flags) const override {
-        u32 fill_color = Style.Colors[Color];
+    void Render(Device &device) const override {
+        const u32 fill_color = Style.Colors[Color];
         const u32 text_color = Style.Colors[FlowGridGraphCol_Text];
         const auto &local_rect = GetFrameRect();
         const auto &size = local_rect.GetSize();
@@ -652,18 +925,11 @@ struct BlockNode : Node {
 
         if (device.Type() == DeviceType_SVG) {
             auto &svg_device = static_cast<SVGDevice &>(device);
-            if (Inner && !fs::exists(svg_device.Directory / Inner->SvgFileName())) Inner->WriteSvg(svg_device.Directory);
             const string link = Inner ? SvgFileName() : "";
             svg_device.Rect({{0, 0}, size}, {.FillColor = fill_color, .CornerRadius = Style.BoxCornerRadius}, link);
             svg_device.Text(size / 2, Text, {.Color = text_color}, link);
         } else {
-            if (Inner) {
-                if (flags & InteractionFlags_Clicked) {
-                    Context.NodeNavigationHistory.IssuePush(Inner->ImGuiId);
-                }
-                fill_color = GetColorU32(flags & InteractionFlags_Held ? ImGuiCol_ButtonActive : (flags & InteractionFlags_Hovered ? ImGuiCol_ButtonHovered : ImGuiCol_Button));
-            }
-            RenderFrame(device.At({0, 0}), device.At(size), fill_color, false, Style.BoxCornerRadius);
+            device.Frame({{0, 0}, size}, fill_color, Inner != nullptr);
             device.Text(size / 2, Text, {.Color = text_color});
         }
 
@@ -682,6 +948,10 @@ struct BlockNode : Node {
         }
     }
 
+    void OnInteraction(InteractionFlags flags) const override {
+        if (Inner && (flags & InteractionFlags_Clicked)) Context.NodeNavigationHistory.IssuePush(Inner->ImGuiId);
+    }
+
     const FlowGridGraphCol Color;
     Node *Inner;
 };
@@ -691,8 +961,8 @@ struct CableNode : Node {
     CableNode(const FaustGraph &context, Tree tree, u32 n = 1) : Node(context, tree, n, n) {}
 
     // The width of a cable is null, so its input and output connection points are the same.
-    void Place(const DeviceType) override { Size = {0, float(InCount) * WireGap()}; }
-    void Render(Device &, InteractionFlags) const override {}
+    void DoPlace(const DeviceType) override { Size = {0, float(InCount) * WireGap()}; }
+    void Render(Device &) const override {}
 
     // Cable points are vertically spaced by `WireGap`.
     ImVec2 Point(IO, u32 i) const override {
@@ -706,9 +976,9 @@ struct CableNode : Node {
 struct InverterNode : BlockNode {
     InverterNode(const FaustGraph &context, Tree tree) : BlockNode(context, tree, 1, 1, "-1", FlowGridGraphCol_Inverter) {}
 
-    void Place(const DeviceType) override { Size = ImVec2{2.5f, 1} * WireGap(); }
+    void DoPlace(const DeviceType) override { Size = ImVec2{2.5f, 1} * WireGap(); }
 
-    void Render(Device &device, InteractionFlags) const override {
+    void Render(Device &device) const override {
         const float radius = Style.InverterRadius;
         const ImVec2 p1 = {W() - 2 * XMargin(), 1 + (H() - 1) / 2};
         const auto tri_a = ImVec2{XMargin() + (IsLr() ? 0 : p1.x), 0};
@@ -726,10 +996,10 @@ struct CutNode : Node {
     CutNode(const FaustGraph &context, Tree tree) : Node(context, tree, 1, 0) {}
 
     // 0 width and 1 height, for the wire.
-    void Place(const DeviceType) override { Size = {0, 1}; }
+    void DoPlace(const DeviceType) override { Size = {0, 1}; }
 
     // A cut is represented by a small black dot.
-    void Render(Device &, InteractionFlags) const override {
+    void Render(Device &) const override {
         // device.Circle(point, WireGap() / 8);
     }
 
@@ -775,7 +1045,7 @@ struct BinaryNode : Node {
     }
 
     // Place the two components horizontally, centered, with enough space for the connections.
-    void Place(const DeviceType device_type) override {
+    void DoPlace(const DeviceType device_type) override {
         if (Type == ParallelNode || Type == RecursiveNode) {
             // For parallel, A is top and B is bottom. For recursive, this is reversed.
             // In both cases, flip the order if this node is oriented in reverse.
@@ -814,7 +1084,7 @@ struct BinaryNode : Node {
         }
     }
 
-    void Render(Device &device, InteractionFlags) const override {
+    void Render(Device &device) const override {
         if (Type == ParallelNode) {
             for (const IO io : IO_All) {
                 for (u32 i = 0; i < IoCount(io); i++) {
@@ -929,10 +1199,10 @@ struct BinaryNode : Node {
 
 Node *MakeSequential(const FaustGraph &context, Tree tree, Node *a, Node *b) {
     const u32 o = a->OutCount, i = b->InCount;
-    return new BinaryNode(
+    return MakeNode<BinaryNode>(
         context, tree,
-        o < i ? new BinaryNode(context, tree, a, new CableNode(context, tree, i - o), ParallelNode) : a,
-        o > i ? new BinaryNode(context, tree, b, new CableNode(context, tree, o - i), ParallelNode) : b,
+        o < i ? MakeNode<BinaryNode>(context, tree, a, MakeNode<CableNode>(context, tree, i - o), ParallelNode) : a,
+        o > i ? MakeNode<BinaryNode>(context, tree, b, MakeNode<CableNode>(context, tree, o - i), ParallelNode) : b,
         SequentialNode
     );
 }
@@ -977,19 +1247,14 @@ struct GroupNode : Node {
         : Node(context, tree, inner->InCount, inner->OutCount, inner, nullptr, std::move(text)), Type(type) {}
     ~GroupNode() override = default;
 
-    void Place(const DeviceType type) override {
+    void DoPlace(const DeviceType type) override {
+        A->Orientation = Orientation;
         A->Place(type);
         Size = A->Size + (Margin() + Padding()) * 2 + ImVec2{LineWidth() * 2, LineWidth() * 2 + GetFontSize()};
-
-        if (!ShouldDecorate()) {
-            A->Orientation = Orientation;
-        } else {
-            A->Position = Margin() + Padding() + ImVec2{LineWidth(), LineWidth() + GetFontSize() / 2};
-            A->Orientation = Orientation;
-        }
+        if (ShouldDecorate()) A->Position = Margin() + Padding() + ImVec2{LineWidth(), LineWidth() + GetFontSize() / 2};
     }
 
-    void Render(Device &device, InteractionFlags) const override {
+    void Render(Device &device) const override {
         if (ShouldDecorate()) {
             device.LabeledRect(
                 {Margin() + LineWidth() / 2, Size - Margin() - LineWidth() / 2}, Text,
@@ -1035,12 +1300,12 @@ struct RouteNode : Node {
     RouteNode(const FaustGraph &context, Tree tree, u32 in_count, u32 out_count, std::vector<int> routes)
         : Node(context, tree, in_count, out_count), Routes(std::move(routes)) {}
 
-    void Place(const DeviceType) override {
+    void DoPlace(const DeviceType) override {
         const float h = 2 * YMargin() + max(Style.NodeMinSize.Y(), float(max(InCount, OutCount)) * WireGap());
         Size = {2 * XMargin() + max(Style.NodeMinSize.X(), h * 0.75f), h};
     }
 
-    void Render(Device &device, InteractionFlags) const override {
+    void Render(Device &device) const override {
         if (Style.RouteFrame) {
             device.Rect(GetFrameRect(), {.FillColor = RouteFrameBgColor});
             DrawOrientationMark(device);
@@ -1087,7 +1352,7 @@ static string GetUiDescription(Box box) {
 }
 
 // Generate a 1->0 block node for an input slot.
-static Node *MakeInputSlot(const FaustGraph &context, Tree tree) { return new BlockNode(context, tree, 1, 0, "", FlowGridGraphCol_Slot); }
+static Node *MakeInputSlot(const FaustGraph &context, Tree tree) { return MakeNode<BlockNode>(context, tree, 1, 0, "", FlowGridGraphCol_Slot); }
 
 // Collect the leaf numbers `tree` into `v`.
 // Return `true` if `tree` is a number or a parallel tree of numbers.
@@ -1110,73 +1375,58 @@ static bool isBoxInts(Box box, std::vector<int> &v) {
     throw std::runtime_error("Not a valid list of numbers : " + PrintTree(box));
 }
 
-// Track trees only made of cut, wires, or slots ("pure routing" trees).
-static std::unordered_map<Tree, bool> IsTreePureRouting{};
-static bool IsPureRouting(Tree t) {
-    if (IsTreePureRouting.contains(t)) return IsTreePureRouting[t];
-
-    Tree x, y;
-    if (isBoxCut(t) || isBoxWire(t) || isBoxInverter(t) || isBoxSlot(t) || (isBoxBinary(t, x, y) && IsPureRouting(x) && IsPureRouting(y))) {
-        IsTreePureRouting.emplace(t, true);
-        return true;
-    }
-
-    IsTreePureRouting.emplace(t, false);
-    return false;
-}
-
 // Generate the inside node of a block graph according to its type.
 Node *FaustGraph::Tree2NodeInner(Tree t) const {
-    if (getUserData(t) != nullptr) return new BlockNode(*this, t, xtendedArity(t), 1, xtendedName(t));
-    if (isBoxInverter(t)) return new InverterNode(*this, t);
-    if (isBoxButton(t) || isBoxCheckbox(t) || isBoxVSlider(t) || isBoxHSlider(t) || isBoxNumEntry(t)) return new BlockNode(*this, t, 0, 1, GetUiDescription(t), FlowGridGraphCol_Ui);
-    if (isBoxVBargraph(t) || isBoxHBargraph(t)) return new BlockNode(*this, t, 1, 1, GetUiDescription(t), FlowGridGraphCol_Ui);
-    if (isBoxWaveform(t)) return new BlockNode(*this, t, 0, 2, "waveform{...}");
-    if (isBoxWire(t)) return new CableNode(*this, t);
-    if (isBoxCut(t)) return new CutNode(*this, t);
-    if (isBoxEnvironment(t)) return new BlockNode(*this, t, 0, 0, "environment{...}");
-    if (const auto count_and_name = GetBoxPrimCountAndName(t)) return new BlockNode(*this, t, (*count_and_name).first, 1, (*count_and_name).second);
+    if (getUserData(t) != nullptr) return MakeNode<BlockNode>(*this, t, xtendedArity(t), 1, xtendedName(t));
+    if (isBoxInverter(t)) return MakeNode<InverterNode>(*this, t);
+    if (isBoxButton(t) || isBoxCheckbox(t) || isBoxVSlider(t) || isBoxHSlider(t) || isBoxNumEntry(t)) return MakeNode<BlockNode>(*this, t, 0, 1, GetUiDescription(t), FlowGridGraphCol_Ui);
+    if (isBoxVBargraph(t) || isBoxHBargraph(t)) return MakeNode<BlockNode>(*this, t, 1, 1, GetUiDescription(t), FlowGridGraphCol_Ui);
+    if (isBoxWaveform(t)) return MakeNode<BlockNode>(*this, t, 0, 2, "waveform{...}");
+    if (isBoxWire(t)) return MakeNode<CableNode>(*this, t);
+    if (isBoxCut(t)) return MakeNode<CutNode>(*this, t);
+    if (isBoxEnvironment(t)) return MakeNode<BlockNode>(*this, t, 0, 0, "environment{...}");
+    if (const auto count_and_name = GetBoxPrimCountAndName(t)) return MakeNode<BlockNode>(*this, t, (*count_and_name).first, 1, (*count_and_name).second);
 
     Tree a, b;
     if (isBoxMetadata(t, a, b)) return Tree2Node(a);
     if (isBoxSeq(t, a, b)) return MakeSequential(*this, t, Tree2Node(a), Tree2Node(b));
-    if (isBoxPar(t, a, b)) return new BinaryNode(*this, t, Tree2Node(a), Tree2Node(b), ParallelNode);
-    if (isBoxSplit(t, a, b)) return new BinaryNode(*this, t, Tree2Node(a), Tree2Node(b), SplitNode);
-    if (isBoxMerge(t, a, b)) return new BinaryNode(*this, t, Tree2Node(a), Tree2Node(b), MergeNode);
-    if (isBoxRec(t, a, b)) return new BinaryNode(*this, t, Tree2Node(a), Tree2Node(b), RecursiveNode);
+    if (isBoxPar(t, a, b)) return MakeNode<BinaryNode>(*this, t, Tree2Node(a), Tree2Node(b), ParallelNode);
+    if (isBoxSplit(t, a, b)) return MakeNode<BinaryNode>(*this, t, Tree2Node(a), Tree2Node(b), SplitNode);
+    if (isBoxMerge(t, a, b)) return MakeNode<BinaryNode>(*this, t, Tree2Node(a), Tree2Node(b), MergeNode);
+    if (isBoxRec(t, a, b)) return MakeNode<BinaryNode>(*this, t, Tree2Node(a), Tree2Node(b), RecursiveNode);
     if (isBoxSymbolic(t, a, b)) {
         // Generate an abstraction node by placing the input slots and body in sequence.
         auto *input_slots = MakeInputSlot(*this, a);
         Tree _a, _b;
         while (isBoxSymbolic(b, _a, _b)) {
-            input_slots = new BinaryNode(*this, b, input_slots, MakeInputSlot(*this, _a), ParallelNode);
+            input_slots = MakeNode<BinaryNode>(*this, b, input_slots, MakeInputSlot(*this, _a), ParallelNode);
             b = _b;
         }
         auto *abstraction = MakeSequential(*this, b, input_slots, Tree2Node(b));
-        return !GetTreeName(t).empty() ? abstraction : new GroupNode(*this, NodeType_Group, t, abstraction, "Abstraction");
+        return !GetTreeName(t).empty() ? abstraction : MakeNode<GroupNode>(*this, NodeType_Group, t, abstraction, "Abstraction");
     }
 
     int i;
-    if (double r; isBoxInt(t, &i) || isBoxReal(t, &r)) return new BlockNode(*this, t, 0, 1, isBoxInt(t) ? std::to_string(i) : std::to_string(r), FlowGridGraphCol_Number);
-    if (isBoxSlot(t, &i)) return new BlockNode(*this, t, 0, 1, "", FlowGridGraphCol_Slot);
+    if (double r; isBoxInt(t, &i) || isBoxReal(t, &r)) return MakeNode<BlockNode>(*this, t, 0, 1, isBoxInt(t) ? std::to_string(i) : std::to_string(r), FlowGridGraphCol_Number);
+    if (isBoxSlot(t, &i)) return MakeNode<BlockNode>(*this, t, 0, 1, "", FlowGridGraphCol_Slot);
 
-    if (Tree ff; isBoxFFun(t, ff)) return new BlockNode(*this, t, ffarity(ff), 1, ffname(ff));
-    if (Tree type, name, file; isBoxFConst(t, type, name, file) || isBoxFVar(t, type, name, file)) return new BlockNode(*this, t, 0, 1, tree2str(name));
+    if (Tree ff; isBoxFFun(t, ff)) return MakeNode<BlockNode>(*this, t, ffarity(ff), 1, ffname(ff));
+    if (Tree type, name, file; isBoxFConst(t, type, name, file) || isBoxFVar(t, type, name, file)) return MakeNode<BlockNode>(*this, t, 0, 1, tree2str(name));
 
     Tree label, chan;
-    if (isBoxSoundfile(t, label, chan)) return new BlockNode(*this, t, 2, 2 + tree2int(chan), GetUiDescription(t), FlowGridGraphCol_Ui);
+    if (isBoxSoundfile(t, label, chan)) return MakeNode<BlockNode>(*this, t, 2, 2 + tree2int(chan), GetUiDescription(t), FlowGridGraphCol_Ui);
 
     const bool is_vgroup = isBoxVGroup(t, label, a), is_hgroup = isBoxHGroup(t, label, a), is_tgroup = isBoxTGroup(t, label, a);
     if (is_vgroup || is_hgroup || is_tgroup) {
         const char prefix = is_vgroup ? 'v' : (is_hgroup ? 'h' : 't');
-        return new GroupNode(*this, NodeType_Group, t, Tree2Node(a), std::format("{}group({})", prefix, extractName(label)));
+        return MakeNode<GroupNode>(*this, NodeType_Group, t, Tree2Node(a), std::format("{}group({})", prefix, extractName(label)));
     }
 
     if (Tree route; isBoxRoute(t, a, b, route)) {
         int ins, outs;
         std::vector<int> routes;
         // Build `ins`x`outs` cable routing.
-        if (isBoxInt(a, &ins) && isBoxInt(b, &outs) && isBoxInts(route, routes)) return new RouteNode(*this, t, ins, outs, routes);
+        if (isBoxInt(a, &ins) && isBoxInt(b, &outs) && isBoxInts(route, routes)) return MakeNode<RouteNode>(*this, t, ins, outs, routes);
         throw std::runtime_error("Invalid route expression : " + PrintTree(t));
     }
 
@@ -1186,20 +1436,25 @@ Node *FaustGraph::Tree2NodeInner(Tree t) const {
 // This method calls itself through `Tree2NodeInner`.
 // (Keeping these bad names to remind me to clean this up, likely into a `Node` ctor.)
 Node *FaustGraph::Tree2Node(Tree t) const {
-    auto *node = Tree2NodeInner(t);
-    if (GetTreeName(t).empty()) return node; // Normal case
+    if (auto *node = Arena->Reuse(t)) return node;
 
-    // `FoldComplexity == 0` means no folding.
-    if (Style.FoldComplexity != 0u && node->Descendents >= u32(Style.FoldComplexity)) {
-        int ins, outs;
-        getBoxType(t, &ins, &outs);
-        return new BlockNode(*this, t, ins, outs, "", FlowGridGraphCol_Link, new GroupNode(*this, NodeType_Decorate, t, node));
+    auto *node = Tree2NodeInner(t);
+    if (!GetTreeName(t).empty()) {
+        // `FoldComplexity == 0` means no folding.
+        if (Style.FoldComplexity != 0u && node->Descendents >= u32(Style.FoldComplexity)) {
+            int ins, outs;
+            getBoxType(t, &ins, &outs);
+            node = MakeNode<BlockNode>(*this, t, ins, outs, "", FlowGridGraphCol_Link, MakeNode<GroupNode>(*this, NodeType_Decorate, t, node));
+        } else if (!Arena->IsPureRouting(t)) {
+            node = MakeNode<GroupNode>(*this, NodeType_Group, t, node);
+        }
     }
-    return IsPureRouting(t) ? node : new GroupNode(*this, NodeType_Group, t, node);
+    Arena->Memoize(t, node);
+    return node;
 }
 
 FaustGraph::FaustGraph(ArgsT &&args, const FaustGraphStyle &style, const FaustGraphSettings &settings)
-    : ActionProducerComponent(std::move(args)), Style(style), Settings(settings) {}
+    : ActionProducerComponent(std::move(args)), Style(style), Settings(settings), Arena(std::make_unique<FaustGraphNodeArena>()) {}
 
 FaustGraph::~FaustGraph() {}
 
@@ -1211,28 +1466,166 @@ float FaustGraph::GetScale() const {
 void FaustGraph::SaveBoxSvg(const fs::path &dir_path) const {
     if (!RootNode) return;
 
-    fs::remove_all(dir_path);
-    fs::create_directory(dir_path);
+    std::lock_guard front_end_lock{FaustCompiler::FrontEndMutex}; // For building the tree.
+    if (dir_path != SvgDirectory) {
+        SvgHashByFileName.clear();
+        SvgDirectory = dir_path;
+    }
+    fs::create_directories(dir_path);
+
+    // Build a separate tree, since SVG placement differs from ImGui placement.
+    // Nodes in the current tree are claimed, so they aren't reused.
+    auto *root = MakeNode<GroupNode>(*this, NodeType_Decorate, RootNode->FaustTree, Tree2NodeInner(RootNode->FaustTree));
+
+    // One file per folded node (and one for the root), each linking to the files of the folded nodes it contains.
+    // Folded nodes with the same box have the same file, so only the first is exported.
+    std::vector<Node *> file_roots{root};
+    std::unordered_set<string> file_names{root->SvgFileName()};
+    for (u32 i = 0; i < file_roots.size(); i++) {
+        std::vector<const Node *> stack{file_roots[i]};
+        while (!stack.empty()) {
+            const auto *node = stack.back();
+            stack.pop_back();
+            if (node->A) stack.push_back(node->A);
+            if (node->B) stack.push_back(node->B);
+            if (const auto *block = dynamic_cast<const BlockNode *>(node); block && block->Inner) {
+                if (file_names.insert(block->Inner->SvgFileName()).second) file_roots.push_back(block->Inner);
+            }
+        }
+    }
 
-    GroupNode node{*this, NodeType_Decorate, RootNode->FaustTree, Tree2NodeInner(RootNode->FaustTree)};
-    node.Place(DeviceType_SVG);
-    node.WriteSvg(dir_path);
+    // Each file's nodes are disjoint, so files are placed, rendered, and written in parallel.
+    // This thread waits for all workers, so ImGui state is only read while they run.
+    GetFontBase64(); // Fill the font cache before reading it concurrently.
+    const float scale = GetScale();
+    std::vector<u64> hashes(file_roots.size());
+    std::atomic<u32> next_index{0};
+    const auto export_files = [&] {
+        for (u32 i = next_index++; i < file_roots.size(); i = next_index++) {
+            auto *node = file_roots[i];
+            node->Place(DeviceType_SVG);
+            const auto svg = node->RenderSvg(scale);
+            const auto file_name = node->SvgFileName();
+            hashes[i] = std::hash<string>{}(svg);
+            const auto path = dir_path / file_name;
+            // Skip rewriting files with unchanged contents.
+            if (auto it = SvgHashByFileName.find(file_name); it != SvgHashByFileName.end() && it->second == hashes[i] && fs::exists(path)) continue;
+
+            FileIO::write(path, svg);
+        }
+    };
+    const u32 max_thread_count = SvgExportThreadCount != 0 ? SvgExportThreadCount : std::max(1u, std::thread::hardware_concurrency());
+    const u32 thread_count = std::min(u32(file_roots.size()), max_thread_count);
+    std::vector<std::thread> workers;
+    for (u32 i = 1; i < thread_count; i++) workers.emplace_back(export_files);
+    export_files();
+    for (auto &worker : workers) worker.join();
+
+    SvgHashByFileName.clear();
+    for (u32 i = 0; i < file_roots.size(); i++) SvgHashByFileName[file_roots[i]->SvgFileName()] = hashes[i];
+    // Remove files from previous exports that are no longer part of the graph.
+    std::vector<fs::path> stale_paths;
+    for (const auto &entry : fs::directory_iterator(dir_path)) {
+        if (!file_names.contains(entry.path().filename().string())) stale_paths.push_back(entry.path());
+    }
+    for (const auto &path : stale_paths) fs::remove_all(path);
+
+    Arena->Sweep(RootNode);
 }
 
 void FaustGraph::SetBox(Box box) {
-    IsTreePureRouting.clear();
     NodeNavigationHistory.Clear_();
-    RootNode.reset();
-    if (box) {
-        RootNode = std::make_unique<GroupNode>(*this, NodeType_Decorate, box, Tree2NodeInner(box));
-        NodeByImGuiId.clear();
+    DrawList.reset();
+    for (const auto &[id, _] : NodeByImGuiId) HelpInfo::ById.erase(id);
+    NodeByImGuiId.clear();
+
+    // Unchanged subtrees of the previous tree are reused (see `FaustGraphNodeArena`).
+    Arena->BeginBuild();
+    RootNode = box ? MakeNode<GroupNode>(*this, NodeType_Decorate, box, Tree2NodeInner(box)) : nullptr;
+    Arena->Sweep(RootNode);
+    if (RootNode) {
         RootNode->GenerateIds(Id);
         NodeNavigationHistory.Push_(RootNode->ImGuiId);
     }
 }
 
 void FaustGraph::ResetBox() {
-    if (RootNode) SetBox(RootNode->FaustTree);
+    if (!RootNode) return;
+
+    std::lock_guard front_end_lock{FaustCompiler::FrontEndMutex};
+    Arena->Clear();
+    SetBox(RootNode->FaustTree);
+}
+
+u32 FaustGraph::NodeCount() const { return Arena->Size(); }
+
+void FaustGraph::InvalidateLayout() const {
+    LayoutGeneration++;
+    DrawList.reset();
+}
+
+const FaustGraphDrawList &FaustGraph::GetDrawList(Node &focused) const {
+    if (DrawList && DrawList->FontSize != GetFontSize()) InvalidateLayout(); // Text sizes changed.
+    if (!DrawList || DrawList->Focused != &focused || DrawList->LayoutGeneration != LayoutGeneration) {
+        focused.Place(DeviceType_ImGui);
+        DrawList = std::make_unique<FaustGraphDrawList>(&focused, GetFontSize(), LayoutGeneration);
+        RecordingDevice device{*this, *DrawList};
+        focused.Draw(device);
+    }
+    return *DrawList;
+}
+
+// Replay the recorded commands, skipping nodes (and all their descendents) outside the window's clip rect.
+static void ReplayDrawList(ImGuiDevice &device, const FaustGraphDrawList &draw_list) {
+    static const float CullPadding = 8; // Arrows and line caps can extend slightly beyond a node's bounds.
+    ImRect clip_rect = GetCurrentWindowRead()->ClipRect;
+    clip_rect.Expand(CullPadding);
+
+    std::vector<InteractionFlags> node_flags;
+    const auto &commands = draw_list.Commands;
+    for (u32 i = 0; i < commands.size(); i++) {
+        std::visit(
+            Match{
+                [&](const DrawCommand::BeginNode &c) {
+                    if (!clip_rect.Overlaps(device.At(c.Bounds))) {
+                        i = c.EndIndex; // Skip to the matching `EndNode`.
+                        return;
+                    }
+
+                    const auto &node = *c.GraphNode;
+                    PushOverrideID(node.ImGuiId);
+                    const auto &frame_rect = node.GetFrameRect();
+                    device.SetCursorPos(device.Scale(c.Bounds.Min + frame_rect.Min));
+                    const auto flags = fg::InvisibleButton(device.Scale(frame_rect.GetSize()), "");
+                    SetItemAllowOverlap();
+                    device.SetCursorPos({0, 0});
+                    node.OnInteraction(flags);
+                    node_flags.push_back(flags);
+                    device.NodeFlags = flags;
+                },
+                [&](const DrawCommand::EndNode &c) {
+                    if (node_flags.back() & InteractionFlags_Hovered) {
+                        device.SetCursorPos(device.Scale(c.Origin));
+                        c.GraphNode->DrawHovered(device);
+                        device.SetCursorPos({0, 0});
+                    }
+                    node_flags.pop_back();
+                    device.NodeFlags = node_flags.empty() ? InteractionFlags_None : node_flags.back();
+                    PopID();
+                },
+                [&](const DrawCommand::Rect &c) { device.Rect(c.Area, c.Style); },
+                [&](const DrawCommand::LabeledRect &c) { device.LabeledRect(c.Area, c.Label, c.Style, c.LabelStyle); },
+                [&](const DrawCommand::Triangle &c) { device.Triangle(c.P1, c.P2, c.P3, c.Color); },
+                [&](const DrawCommand::Circle &c) { device.Circle(c.Position, c.Radius, c.FillColor, c.StrokeColor); },
+                [&](const DrawCommand::Arrow &c) { device.Arrow(c.Position, c.Orientation); },
+                [&](const DrawCommand::Line &c) { device.Line(c.Start, c.End); },
+                [&](const DrawCommand::Text &c) { device.Text(c.Position, c.Value, c.Style); },
+                [&](const DrawCommand::Dot &c) { device.Dot(c.Position, c.FillColor); },
+                [&](const DrawCommand::Frame &c) { device.Frame(c.Area, c.FillColor, c.Interactive); },
+            },
+            commands[i]
+        );
+    }
 }
 
 void FaustGraph::Render() const {
@@ -1265,7 +1658,7 @@ void FaustGraph::Render() const {
     }
 
     auto *focused = NodeByImGuiId.at(*NodeNavigationHistory);
-    focused->Place(DeviceType_ImGui);
+    const auto &draw_list = GetDrawList(*focused);
     if (!Style.ScaleFillHeight) SetNextWindowContentSize(focused->Size * GetScale());
 
     BeginChild("##RootNode", {0, 0}, false, ImGuiWindowFlags_HorizontalScrollbar);
@@ -1273,7 +1666,7 @@ void FaustGraph::Render() const {
     GetWindowDrawList()->AddRectFilled(GetWindowPos(), GetWindowPos() + GetWindowSize(), Style.Colors[FlowGridGraphCol_Bg]);
 
     ImGuiDevice device{*this};
-    focused->Draw(device);
+    ReplayDrawList(device, draw_list);
 
     EndChild();
 }
@@ -13,6 +13,8 @@ struct Node;
 
 struct FaustGraphStyle;
 struct FaustGraphSettings;
+struct FaustGraphDrawList;
+struct FaustGraphNodeArena;
 
 struct FaustGraph : ActionProducerComponent<Action::Combine<Action::Faust::Graph::Any, Navigable<ID>::ProducedActionType>> {
     FaustGraph(ArgsT &&, const FaustGraphStyle &, const FaustGraphSettings &);
@@ -21,8 +23,16 @@ struct FaustGraph : ActionProducerComponent<Action::Combine<Action::Faust::Graph
     float GetScale() const;
 
     void SaveBoxSvg(const fs::path &dir_path) const;
-    void SetBox(Box);
+    // Number of threads used to export SVG files, including the calling thread. Zero means one thread per hardware thread.
+    inline static u32 SvgExportThreadCount{0};
+    void SetBox(Box); // The caller must hold `FaustCompiler::FrontEndMutex`.
     void ResetBox(); // Set to the box of the current root node.
+    void InvalidateLayout() const; // Re-place and re-record nodes before the next render (e.g. after a style change).
+
+    u32 NodeCount() const; // Number of live nodes owned by this graph's arena.
+    // Across all graphs. Nodes are only created and destroyed on the UI thread.
+    inline static u32 LiveNodeCount{0};
+    inline static u64 CreatedNodeCount{0};
 
     Prop(UInt, DspId);
     ProducerProp(Navigable<ID>, NodeNavigationHistory);
@@ -32,11 +42,21 @@ struct FaustGraph : ActionProducerComponent<Action::Combine<Action::Faust::Graph
 
     Box _Box;
     mutable std::unordered_map<ID, fg::Node *> NodeByImGuiId;
-    std::unique_ptr<fg::Node> RootNode{};
+    std::unique_ptr<FaustGraphNodeArena> Arena; // Owns all nodes.
+    fg::Node *RootNode{nullptr};
+    // Nodes cache their placement until this changes.
+    mutable u32 LayoutGeneration{1};
 
 private:
     void Render() const override;
+    const FaustGraphDrawList &GetDrawList(fg::Node &focused) const;
 
     fg::Node *Tree2Node(Box) const;
     fg::Node *Tree2NodeInner(Box) const;
+
+    mutable std::unique_ptr<FaustGraphDrawList> DrawList;
+
+    // Content hash of each file written by the most recent `SaveBoxSvg` to `SvgDirectory`, to skip rewriting unchanged files.
+    mutable fs::path SvgDirectory;
+    mutable std::unordered_map<std::string, u64> SvgHashByFileName;
 };
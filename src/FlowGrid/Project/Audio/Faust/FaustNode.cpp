@@ -10,44 +10,48 @@ struct FaustMaNode : MaNode, Component, Component::ChangeListener {
     FaustMaNode(ComponentArgs &&args, AudioGraph *graph, ID dsp_id = 0)
         : MaNode(), Component(std::move(args)), Graph(graph), ParentNode(static_cast<AudioGraphNode *>(Parent)) {
         if (dsp_id != 0 && DspId == 0u) DspId.Set_(dsp_id);
-        Init(Graph->GetFaustDsp(DspId), Graph->SampleRate);
+        _Node = Create(Graph->GetFaustDsp(DspId), Graph->SampleRate);
+        Node = _Node.get();
         DspId.RegisterChangeListener(this);
     }
     ~FaustMaNode() {
         UnregisterChangeListener(this);
-        Uninit();
+        Graph->RetireNode(std::move(_Node), ma_faust_node_uninit);
     }
 
     void OnComponentChanged() override {
         if (DspId.IsChanged()) UpdateDsp();
     }
 
-    void Init(dsp *dsp, u32 sample_rate) {
+    std::unique_ptr<ma_faust_node> Create(dsp *dsp, u32 sample_rate) const {
+        auto faust_node = std::make_unique<ma_faust_node>();
         auto config = ma_faust_node_config_init(dsp, sample_rate, Graph->GetBufferFrames());
-        ma_result result = ma_faust_node_init(Graph->Get(), &config, nullptr, &_Node);
+        ma_result result = ma_faust_node_init(Graph->Get(), &config, nullptr, faust_node.get());
         if (result != MA_SUCCESS) throw std::runtime_error(std::format("Failed to initialize the Faust audio graph node: {}", int(result)));
-
-        Node = &_Node;
-    }
-    void Uninit() {
-        ma_faust_node_uninit(&_Node, nullptr);
+        return faust_node;
     }
 
     void UpdateDsp() {
         auto *new_dsp = Graph->GetFaustDsp(DspId);
-        auto *current_dsp = ma_faust_node_get_dsp(&_Node);
+        auto *current_dsp = ma_faust_node_get_dsp(_Node.get());
         if (!new_dsp && !current_dsp) return;
 
         auto new_in_channels = ma_faust_dsp_get_in_channels(new_dsp);
         auto new_out_channels = ma_faust_dsp_get_out_channels(new_dsp);
-        auto current_in_channels = ma_faust_node_get_in_channels(&_Node);
-        auto current_out_channels = ma_faust_node_get_out_channels(&_Node);
+        auto current_in_channels = ma_faust_node_get_in_channels(_Node.get());
+        auto current_out_channels = ma_faust_node_get_out_channels(_Node.get());
         if ((new_dsp && !current_dsp) || (!new_dsp && current_dsp) || current_in_channels != new_in_channels || current_out_channels != new_out_channels) {
-            Uninit();
-            Init(new_dsp, ma_faust_node_get_sample_rate(&_Node));
+            // Replace the node rather than re-initializing it in place, since the audio thread may still be processing it.
+            // The previous DSP is retired to the graph after this (see `AudioGraph::OnFaustDspRetired`), so it outlives the retired node's reads.
+            auto prev_node = std::exchange(_Node, Create(new_dsp, ma_faust_node_get_sample_rate(_Node.get())));
+            Node = _Node.get();
+            Graph->RetireNode(std::move(prev_node), ma_faust_node_uninit);
             ParentNode->NotifyConnectionsChanged();
         } else {
-            ma_faust_node_set_dsp(&_Node, new_dsp);
+            ma_faust_dsp_params *prev_params;
+            if (ma_faust_node_set_dsp(_Node.get(), new_dsp, &prev_params) == MA_SUCCESS) {
+                Graph->Retire(std::shared_ptr<ma_faust_dsp_params>(prev_params, ma_faust_dsp_params_free));
+            }
         }
     }
 
@@ -61,7 +65,7 @@ struct FaustMaNode : MaNode, Component, Component::ChangeListener {
 
     Prop(UInt, DspId);
 
-    ma_faust_node _Node;
+    std::unique_ptr<ma_faust_node> _Node;
 };
 
 FaustNode::FaustNode(ComponentArgs &&args, ID dsp_id) : AudioGraphNode(std::move(args), [this, dsp_id] { return CreateNode(dsp_id); }) {}
@@ -75,3 +79,14 @@ void FaustNode::OnSampleRateChanged() {
 
 ID FaustNode::GetDspId() const { return reinterpret_cast<FaustMaNode *>(Node.get())->DspId; }
 void FaustNode::SetDsp(ID id) { reinterpret_cast<FaustMaNode *>(Node.get())->SetDsp(id); }
+
+bool FaustNode::SetParam(dsp *dsp, Real *zone, Real value) {
+    auto *faust_node = (ma_faust_node *)Get();
+    if (ma_faust_node_get_dsp(faust_node) != dsp) return false;
+
+    // Changes are coalesced per zone, and there is a slot for each of the DSP's zones, so this only fails if `zone` isn't one of them.
+    if (const auto result = ma_faust_node_push_param(faust_node, zone, value); result != MA_SUCCESS) {
+        throw std::runtime_error(std::format("Failed to queue a Faust param change: {}", int(result)));
+    }
+    return true;
+}
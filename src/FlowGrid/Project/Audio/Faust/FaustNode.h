@@ -3,6 +3,7 @@
 // An audio graph node that uses Faust to generate audio, not to be confused with Faust's graph UI nodes (in `FaustGraphs`).
 
 #include "Project/Audio/Graph/AudioGraphNode.h"
+#include "Project/Audio/Sample.h"
 
 class dsp;
 
@@ -14,6 +15,10 @@ struct FaustNode : AudioGraphNode {
     ID GetDspId() const;
     void SetDsp(ID);
 
+    // If this node is computing `dsp`, queue a change of its param `zone`, to be applied by the audio thread at the start of its next processed block.
+    // Returns `false` if the node isn't computing `dsp`, and throws if `zone` isn't one of its zones.
+    bool SetParam(dsp *, Real *zone, Real value);
+
 private:
     std::unique_ptr<MaNode> CreateNode(ID dsp_id = 0);
 };
@@ -1,6 +1,7 @@
 #include "FaustParam.h"
 
 #include "Core/Store/Store.h"
+#include "Faust.h"
 #include "FaustParamsStyle.h"
 #include "UI/Widgets.h"
 
@@ -14,8 +15,8 @@ using namespace fg;
 using enum FaustParamType;
 using std::min, std::max;
 
-FaustParam::FaustParam(ComponentArgs &&args, const FaustParamsStyle &style, const FaustParamType type, std::string_view label, Real *zone, Real min, Real max, Real init, Real step, const char *tooltip, NamesAndValues names_and_values)
-    : FaustParamBase(style, type, label), Float(std::move(args), init), Zone(zone), Min(min), Max(max), Init(init), Step(step), Tooltip(tooltip), names_and_values(std::move(names_and_values)) {}
+FaustParam::FaustParam(ComponentArgs &&args, const FaustParamsStyle &style, dsp *dsp, const FaustParamType type, std::string_view label, Real *zone, Real min, Real max, Real init, Real step, const char *tooltip, NamesAndValues names_and_values)
+    : FaustParamBase(style, type, label), Float(std::move(args), init), Dsp(dsp), Zone(zone), Min(min), Max(max), Init(init), Step(step), Tooltip(tooltip), names_and_values(std::move(names_and_values)) {}
 
 // todo config to place labels above horizontal params
 float FaustParam::CalcWidth(bool include_label) const {
@@ -56,7 +57,7 @@ float FaustParam::CalcWidth(bool include_label) const {
 
 void FaustParam::Refresh() {
     Float::Refresh();
-    *Zone = std::clamp(Real(Value), Real(Min), Real(Max));
+    Faust::SetParam(Dsp, Zone, std::clamp(Real(Value), Real(Min), Real(Max)));
 }
 
 void FaustParam::Render(float suggested_height, bool no_label) const {
@@ -83,36 +84,37 @@ void FaustParam::Render(float suggested_height, bool no_label) const {
 
     if (Type == Type_Button) {
         Button(label);
-        if (IsItemActivated() && *Zone == 0.0) IssueSet(1.0);
-        else if (IsItemDeactivated() && *Zone == 1.0) IssueSet(0.0);
+        if (IsItemActivated() && Value == 0.0) IssueSet(1.0);
+        else if (IsItemDeactivated() && Value == 1.0) IssueSet(0.0);
     } else if (Type == Type_CheckButton) {
-        auto value = bool(*Zone);
+        auto value = bool(Value);
         if (Checkbox(label, &value)) IssueSet(Real(value));
     } else if (Type == Type_NumEntry) {
-        auto value = int(*Zone);
+        auto value = int(Value);
         if (InputInt(label, &value, int(Step))) IssueSet(std::clamp(Real(value), Min, Max));
     } else if (Type == Type_HSlider || Type == Type_VSlider || Type == Type_HBargraph || Type == Type_VBargraph) {
-        auto value = float(*Zone);
+        // Bargraphs display the DSP's output. Racy, but only for display.
+        auto value = float(Type == Type_HBargraph || Type == Type_VBargraph ? *Zone : Value);
         ValueBarFlags flags = ValueBarFlags_None;
         if (Type == Type_HBargraph || Type == Type_VBargraph) flags |= ValueBarFlags_ReadOnly;
         if (Type == Type_VBargraph || Type == Type_VSlider) flags |= ValueBarFlags_Vertical;
         if (!has_label) flags |= ValueBarFlags_NoTitle;
         if (ValueBar(Label.c_str(), &value, item_size.y - label_height, float(Min), float(Max), flags, justify.h)) IssueSet(Real(value));
     } else if (Type == Type_Knob) {
-        auto value = float(*Zone);
+        auto value = float(Value);
         KnobFlags flags = has_label ? KnobFlags_None : KnobFlags_NoTitle;
         const int steps = Step == 0 ? 0 : int((Max - Min) / Step);
         if (Knob(Label.c_str(), &value, float(Min), float(Max), 0, nullptr, justify.h, steps == 0 || steps > 10 ? KnobType_WiperDot : KnobType_Stepped, flags, steps)) {
             IssueSet(Real(value));
         }
     } else if (Type == Type_HRadioButtons || Type == Type_VRadioButtons) {
-        auto value = float(*Zone);
+        auto value = float(Value);
         RadioButtonsFlags flags = has_label ? RadioButtonsFlags_None : RadioButtonsFlags_NoTitle;
         if (Type == Type_VRadioButtons) flags |= ValueBarFlags_Vertical;
         SetNextItemWidth(item_size.x); // Include label in param width for radio buttons (inconsistent but just makes things easier).
         if (RadioButtons(Label.c_str(), &value, names_and_values, flags, justify)) IssueSet(Real(value));
     } else if (Type == Type_Menu) {
-        auto value = float(*Zone);
+        auto value = float(Value);
         // todo handle not present
         const auto selected_index = find(names_and_values.values.begin(), names_and_values.values.end(), value) - names_and_values.values.begin();
         if (BeginCombo(Label.c_str(), names_and_values.names[selected_index].c_str())) {
@@ -6,12 +6,17 @@
 #include "FaustParamBase.h"
 #include "UI/NamesAndValues.h"
 
+class dsp;
+
 struct FaustParam : FaustParamBase, Float {
-    FaustParam(ComponentArgs &&, const FaustParamsStyle &style, const FaustParamType type = Type_None, std::string_view label = "", Real *zone = nullptr, Real min = 0, Real max = 0, Real init = 0, Real step = 0, const char *tooltip = nullptr, NamesAndValues names_and_values = {});
+    FaustParam(ComponentArgs &&, const FaustParamsStyle &style, dsp *, const FaustParamType type = Type_None, std::string_view label = "", Real *zone = nullptr, Real min = 0, Real max = 0, Real init = 0, Real step = 0, const char *tooltip = nullptr, NamesAndValues names_and_values = {});
 
     void Render(const float suggested_height, bool no_label = false) const override;
 
-    Real *Zone; // Only meaningful for widget params (not groups).
+    dsp *Dsp; // The DSP owning `Zone`.
+    // Only meaningful for widget params (not groups).
+    // Only written on the audio thread while a Faust node is computing `Dsp` (see `Faust::SetParam`).
+    Real *Zone;
     const Real Min, Max; // Only meaningful for sliders, num-entries, and bar graphs.
     const Real Init, Step; // Only meaningful for sliders and num-entries.
     const char *Tooltip; // Only populated for params (not groups).
@@ -33,7 +33,7 @@ private:
             AllParams.emplace_back(std::make_unique<FaustParamGroup>(ComponentArgs{&active_group, short_label, label}, Style, type, label));
             Groups.push((FaustParamGroup *)AllParams.back().get());
         } else { // Param
-            AllParams.emplace_back(std::make_unique<FaustParam>(ComponentArgs{&active_group, short_label, label}, Style, type, label, zone, min, max, init, step, tooltip, std::move(names_and_values)));
+            AllParams.emplace_back(std::make_unique<FaustParam>(ComponentArgs{&active_group, short_label, label}, Style, Dsp, type, label, zone, min, max, init, step, tooltip, std::move(names_and_values)));
         }
     }
 
@@ -1,6 +1,7 @@
 #include "AudioGraph.h"
 
-#include <range/v3/range/conversion.hpp>
+#include "AudioGraphReclaimer.h"
+#include "AudioGraphScheduler.h"
 
 #include "Core/Container/AdjacencyListAction.h"
 #include "Core/Primitive/String.h"
@@ -368,7 +369,7 @@ struct OutputDeviceNode : DeviceNode {
         auto *user_data = reinterpret_cast<AudioDevice::UserData *>(device->pUserData);
         const auto *self = reinterpret_cast<const OutputDeviceNode *>(user_data->User);
         if (self->IsPrimary() && self->Graph) {
-            ma_node_graph_read_pcm_frames(self->Graph->Get(), output, frame_count, nullptr);
+            self->Graph->ReadPcmFrames(static_cast<float *>(output), frame_count);
         } else if (self->IsActive) {
             // After the primary output device node has pulled from the graph endpoint node,
             // This secondary output device node will have its input buses mixed and copied into its passthrough buffer.
@@ -427,7 +428,7 @@ AudioGraph::ChannelConverterNode::ChannelConverterNode(AudioGraph *graph, u32 fr
 }
 
 AudioGraph::ChannelConverterNode::~ChannelConverterNode() {
-    ma_channel_converter_node_uninit(Get(), nullptr);
+    Graph->RetireNode(std::move(Converter), ma_channel_converter_node_uninit);
 }
 
 ma_channel_converter_node *AudioGraph::ChannelConverterNode::Get() const { return Converter.get(); }
@@ -438,7 +439,9 @@ u32 AudioGraph::ChannelConverterNode::ChannelCount(IO io) const {
 
 AudioGraph::AudioGraph(ProducerComponentArgs<ProducedActionType> &&args)
     : AudioGraphNode(std::move(args.Args), [this] { return CreateNode(); }),
-      ActionableProducer(std::move(args.Q)) {
+      ActionableProducer(std::move(args.Q)),
+      Reclaimer(std::make_unique<AudioGraphReclaimer>()),
+      Scheduler(std::make_unique<AudioGraphScheduler>(ProcessingThreadCount, *Reclaimer)) {
     IsActive = true; // The graph is always active, since it is always connected to itself.
     this->RegisterListener(this); // The graph listens to itself _as an audio graph node_.
 
@@ -458,7 +461,17 @@ AudioGraph::AudioGraph(ProducerComponentArgs<ProducedActionType> &&args)
 }
 
 AudioGraph::~AudioGraph() {
+    // Nodes and branches are retired rather than destroyed in place, since the device may still be reading the graph.
+    // Everything retired is freed along with the reclaimer, after the scheduler stops.
     Nodes.Clear();
+    ChannelConverterNodes.clear();
+    ResetInnerNodes(); // The base destructor runs after the reclaimer is gone.
+    Scheduler->SetBranches({});
+    for (auto &[_, branch] : BranchByRootId) {
+        ma_node_detach_all_output_buses(branch->GetSource());
+        Reclaimer->Retire(std::move(branch));
+    }
+    BranchByRootId.clear();
 }
 
 std::unique_ptr<MaNode> AudioGraph::CreateNode() const { return std::make_unique<GraphMaNode>(); }
@@ -527,6 +540,28 @@ void AudioGraph::Apply(const ActionType &action) const {
 
 ma_node_graph *AudioGraph::Get() { return &reinterpret_cast<GraphMaNode *>(Node.get())->_Graph; }
 
+u32 AudioGraph::GetProcessingThreadCount() const { return Scheduler->GetThreadCount(); }
+
+u64 AudioGraph::ReadPcmFrames(float *output, u32 frame_count) {
+    Reclaimer->BeginRead();
+    const u64 frames_read = Scheduler->Read(Get(), output, frame_count);
+    Reclaimer->EndRead();
+    return frames_read;
+}
+
+void AudioGraph::DetachAndRetire(ma_node *node, std::shared_ptr<void> object) const {
+    ma_node_detach_all_output_buses(node);
+    Reclaimer->Retire(std::move(object));
+}
+void AudioGraph::Retire(std::shared_ptr<void> object) const { Reclaimer->Retire(std::move(object)); }
+void AudioGraph::CollectRetired() const { Reclaimer->Collect(); }
+
+void AudioGraph::RenderOffline(float *output, u32 frame_count) {
+    const u64 frames_read = ReadPcmFrames(output, frame_count);
+    // The graph fills what it can; pad the rest of the block with silence.
+    if (frames_read < frame_count) std::fill(output + frames_read * 2, output + u64(frame_count) * 2, 0.f);
+}
+
 // For both I/O, we use the default channel count (0).
 DeviceDataFormat AudioGraph::GetDeviceClientFormat(IO) const { return {int(ma_format_f32), 0, SampleRate}; }
 
@@ -568,49 +603,93 @@ u32 AudioGraph::GetBufferFrames() const {
     return 0;
 }
 
-void AudioGraph::OnFaustDspChanged(ID id, dsp *) {
+void AudioGraph::OnFaustDspChanged(ID id, dsp *dsp) {
+    if (dsp) DspById[id] = dsp;
     for (auto &node : FindAllByPathSegment(FaustNodeTypeId)) {
         if (auto *faust_node = reinterpret_cast<FaustNode *>(node.get()); faust_node->GetDspId() == id) {
             faust_node->SetDsp(id);
         }
     }
 }
-void AudioGraph::OnFaustDspAdded(ID id, dsp *dsp) {
-    DspById[id] = dsp;
-    OnFaustDspChanged(id, dsp);
-}
+void AudioGraph::OnFaustDspAdded(ID id, dsp *dsp) { OnFaustDspChanged(id, dsp); }
 void AudioGraph::OnFaustDspRemoved(ID id) {
     DspById.erase(id);
     OnFaustDspChanged(id, nullptr);
 }
+// Nodes have already swapped out (and retired) the DSP's params, so the DSP is freed after them.
+void AudioGraph::OnFaustDspRetired(std::shared_ptr<dsp> dsp) { Reclaimer->Retire(std::move(dsp)); }
 
-void AudioGraph::OnNodeConnectionsChanged(AudioGraphNode *) { UpdateConnections(); }
+bool AudioGraph::OnFaustParamChanged(dsp *dsp, Real *zone, Real value) {
+    bool applied = false;
+    for (auto &node : FindAllByPathSegment(FaustNodeTypeId)) {
+        applied |= reinterpret_cast<FaustNode *>(node.get())->SetParam(dsp, zone, value);
+    }
+    return applied;
+}
+
+void AudioGraph::OnNodeConnectionsChanged(AudioGraphNode *node) {
+    // Re-initializing an inner node detaches all of its connections, so the node and all of its sources need reconnecting,
+    // even if their graph-visible `ma_node`s are unchanged.
+    StaleWiringNodeIds.insert(node->Id);
+    for (const auto *source_node : GetSourceNodes(node)) StaleWiringNodeIds.insert(source_node->Id);
+    UpdateConnections();
+}
 
 std::unordered_set<AudioGraphNode *> AudioGraph::GetSourceNodes(const AudioGraphNode *node) const {
     std::unordered_set<AudioGraphNode *> nodes;
+    const auto &source_ids = Connections.GetSources(node->Id);
     for (auto *other_node : Nodes) {
         if (other_node == node) continue;
-        if (Connections.IsConnected(other_node->Id, node->Id)) {
-            nodes.insert(other_node);
-        }
+        if (std::ranges::find(source_ids, other_node->Id) != source_ids.end()) nodes.insert(other_node);
     }
     return nodes;
 }
 
 std::unordered_set<AudioGraphNode *> AudioGraph::GetDestinationNodes(const AudioGraphNode *node) const {
     std::unordered_set<AudioGraphNode *> nodes;
+    const auto &destination_ids = Connections.GetDestinations(node->Id);
     for (auto *other_node : Nodes) {
         if (other_node == node) continue;
-        if (Connections.IsConnected(node->Id, other_node->Id)) {
-            nodes.insert(other_node);
-        }
+        if (std::ranges::find(destination_ids, other_node->Id) != destination_ids.end()) nodes.insert(other_node);
     }
     return nodes;
 }
 
-void AudioGraph::UpdateConnections() {
-    ChannelConverterNodes.clear();
+static void AttachChain(const std::vector<ma_node *> &chain) {
+    for (u32 i = 1; i < chain.size(); i++) ma_node_attach_output_bus(chain[i - 1], 0, chain[i], 0);
+}
 
+AudioGraph::NodeWiring AudioGraph::CreateWiring(const AudioGraphNode *node, const std::unordered_map<ID, AudioGraphNode *> &destination_node_by_id, bool is_parallel_branch_root) const {
+    NodeWiring wiring;
+    if (!node->IsActive) return wiring;
+
+    wiring.IsParallelBranchRoot = is_parallel_branch_root;
+    if (node->InputBusCount() > 0) {
+        // Monitor after applying gain.
+        if (auto *in_gainer = node->GetGainerNode(IO_In)) wiring.InputChain.push_back(in_gainer->Get());
+        if (auto *in_monitor = node->GetMonitorNode(IO_In)) wiring.InputChain.push_back(in_monitor->Get());
+        wiring.InputChain.push_back(node->Get());
+    }
+    if (node->OutputBusCount() > 0) {
+        // Apply panning after gain, and monitor after applying gain and panning.
+        wiring.OutputChain.push_back(node->Get());
+        if (auto *out_gainer = node->GetGainerNode(IO_Out)) wiring.OutputChain.push_back(out_gainer->Get());
+        if (auto *panner = node->GetPannerNode()) wiring.OutputChain.push_back(panner->Get());
+        if (auto *out_monitor = node->GetMonitorNode(IO_Out)) wiring.OutputChain.push_back(out_monitor->Get());
+
+        // Sorted by ID, so the splitter bus order doesn't depend on the order connections were made.
+        auto destination_ids = Connections.GetDestinations(node->Id);
+        std::ranges::sort(destination_ids);
+        for (const ID destination_id : destination_ids) {
+            if (const auto it = destination_node_by_id.find(destination_id); it != destination_node_by_id.end() && it->second != node) {
+                wiring.Destinations.emplace_back(destination_id, it->second->InputNode());
+            }
+        }
+    }
+    return wiring;
+}
+
+void AudioGraph::UpdateConnections() {
     // Always connect the primary device to the graph endpoint, and connect secondary devices with at least one input node.
     // This is the only section in the method that modifies `Connections`.
     for (auto *output_device_node : GetOutputDeviceNodes()) {
@@ -621,85 +700,232 @@ void AudioGraph::UpdateConnections() {
         }
     }
 
-    for (auto *node : Nodes) {
-        node->SetActive(Connections.HasPath(node->Id, Id));
-        node->DisconnectOutput();
-    }
+    for (auto *node : Nodes) node->SetActive(Connections.HasPath(node->Id, Id));
 
-    // Set up internal node connections.
-    for (auto *node : Nodes) {
-        if (!node->IsActive) continue;
-
-        if (node->InputBusCount() > 0) {
-            if (auto *in_monitor = node->GetMonitorNode(IO_In)) {
-                ma_node_attach_output_bus(in_monitor->Get(), 0, node->Get(), 0);
-            }
-            if (auto *in_gainer = node->GetGainerNode(IO_In)) {
-                // Monitor after applying gain.
-                if (auto *in_monitor = node->GetMonitorNode(IO_In)) ma_node_attach_output_bus(in_gainer->Get(), 0, in_monitor->Get(), 0);
-                else ma_node_attach_output_bus(in_gainer->Get(), 0, node->Get(), 0);
-            }
+    // The graph does not keep itself in its `Nodes` list.
+    std::unordered_map<ID, AudioGraphNode *> destination_node_by_id{{Id, this}};
+    for (auto *node : Nodes) destination_node_by_id.emplace(node->Id, node);
+
+    // Retire branches that are no longer independent (or whose root's channel count changed) before rewiring.
+    // Detaching a branch's source node and unpublishing it makes it unreachable for new reads,
+    // but a read in progress may still be rendering it, so it's handed to the reclaimer.
+    const auto branch_root_ids = FindParallelBranchRootIds();
+    std::vector<std::unique_ptr<AudioGraphBranch>> retired_branches;
+    for (auto it = BranchByRootId.begin(); it != BranchByRootId.end();) {
+        if (branch_root_ids.contains(it->first) &&
+            it->second->Channels == ma_node_get_output_channels(static_cast<const AudioGraphNode *>(Component::ById.at(it->first))->OutputNode(), 0)) {
+            ++it;
+            continue;
         }
-        if (node->OutputBusCount() > 0) {
-            if (auto *out_gainer = node->GetGainerNode(IO_Out)) {
-                ma_node_attach_output_bus(node->Get(), 0, out_gainer->Get(), 0);
-            }
-            if (auto *panner = node->GetPannerNode()) {
-                // Apply panning after gain.
-                if (auto *out_gainer = node->GetGainerNode(IO_Out)) ma_node_attach_output_bus(out_gainer->Get(), 0, panner->Get(), 0);
-                else ma_node_attach_output_bus(node->Get(), 0, panner->Get(), 0);
-            }
-            if (auto *out_monitor = node->GetMonitorNode(IO_Out)) {
-                // Monitor after applying gain and panning.
-                if (auto *panner = node->GetPannerNode()) ma_node_attach_output_bus(panner->Get(), 0, out_monitor->Get(), 0);
-                else if (auto *out_gainer = node->GetGainerNode(IO_Out)) ma_node_attach_output_bus(out_gainer->Get(), 0, out_monitor->Get(), 0);
-                else ma_node_attach_output_bus(node->Get(), 0, out_monitor->Get(), 0);
-            }
+        StaleWiringNodeIds.insert(it->first);
+        retired_branches.emplace_back(std::move(it->second));
+        it = BranchByRootId.erase(it);
+    }
+    if (!retired_branches.empty()) {
+        PublishParallelBranches();
+        for (auto &branch : retired_branches) {
+            ma_node_detach_all_output_buses(branch->GetSource());
+            Reclaimer->Retire(std::move(branch));
         }
     }
 
-    // The graph does not keep itself in its `Nodes` list.
-    // xxx This should be a `ranges::concat` instead of making a new vector, but I couldn't get it to work.
-    auto destination_nodes = Nodes.View() | std::views::transform([](const auto &node) { return node.get(); }) | ranges::to<std::vector>();
-    destination_nodes.emplace_back(this);
-
-    for (auto *source_node : Nodes) {
-        if (!source_node->IsActive || source_node->OutputBusCount() == 0) continue;
+    // Only touch the `ma_node` connections of nodes whose wiring changed since the last update.
+    std::unordered_set<ID> node_ids;
+    RewiredNodeCount = 0;
+    for (auto *node : Nodes) {
+        node_ids.insert(node->Id);
+        auto wiring = CreateWiring(node, destination_node_by_id, branch_root_ids.contains(node->Id));
+        const auto prev_wiring_it = WiringByNodeId.find(node->Id);
+        const bool is_stale = prev_wiring_it == WiringByNodeId.end() || StaleWiringNodeIds.contains(node->Id);
+        if (!is_stale && prev_wiring_it->second == wiring) continue;
+        ++RewiredNodeCount;
+
+        const bool chains_changed = is_stale || prev_wiring_it->second.InputChain != wiring.InputChain || prev_wiring_it->second.OutputChain != wiring.OutputChain;
+        if (chains_changed) {
+            AttachChain(wiring.InputChain);
+            AttachChain(wiring.OutputChain);
+        }
+        if (chains_changed || prev_wiring_it->second.Destinations != wiring.Destinations || prev_wiring_it->second.IsParallelBranchRoot != wiring.IsParallelBranchRoot) {
+            UpdateOutputConnections(node, wiring);
+        }
 
-        const u32 destination_count = Connections.DestinationCount(source_node->Id);
-        if (destination_count == 0) continue; // Should never hit this, since this would imply the node is inactive.
+        WiringByNodeId[node->Id] = std::move(wiring);
+    }
+    // Deleted nodes have already detached their `ma_node`s.
+    std::erase_if(WiringByNodeId, [&node_ids](const auto &entry) { return !node_ids.contains(entry.first); });
+    std::erase_if(ChannelConverterNodes, [&node_ids](const auto &entry) { return !node_ids.contains(entry.first); });
+    StaleWiringNodeIds.clear();
+    PublishParallelBranches();
+}
 
-        if (destination_count == 1) {
-            for (auto *destination_node : destination_nodes) {
-                if (Connections.IsConnected(source_node->Id, destination_node->Id)) {
-                    Connect(source_node->OutputNode(), 0, destination_node->InputNode(), 0);
-                }
-            }
+void AudioGraph::UpdateOutputConnections(AudioGraphNode *source_node, const NodeWiring &wiring) {
+    auto prev_converters = std::move(ChannelConverterNodes[source_node->Id]);
+    ChannelConverterNodes[source_node->Id].clear();
+
+    auto *output_node = source_node->OutputNode();
+    const auto &destinations = wiring.Destinations;
+    if (destinations.empty()) {
+        ma_node_detach_all_output_buses(output_node);
+        source_node->ResetSplitter();
+    } else if (destinations.size() == 1) {
+        source_node->ResetSplitter();
+        const auto &[destination_id, destination] = destinations.front();
+        if (wiring.IsParallelBranchRoot) {
+            // Render the branch into its own buffer, and read it into the destination through the branch's source node.
+            auto &branch = BranchByRootId[source_node->Id];
+            if (!branch) branch = std::make_unique<AudioGraphBranch>(Get(), ma_node_get_output_channels(output_node, 0));
+            ma_node_attach_output_bus(output_node, 0, branch->GetEndpoint(), 0);
+            Connect(source_node->Id, branch->GetSource(), 0, destination_id, destination, prev_converters);
         } else {
-            // Connecting a single source to multiple destinations requires a splitter node.
-            auto *splitter = source_node->CreateSplitter(destination_count);
-            ma_node_attach_output_bus(source_node->OutputNode(), 0, splitter, 0);
-
-            u32 splitter_bus = 0;
-            for (auto *destination_node : destination_nodes) {
-                if (Connections.IsConnected(source_node->Id, destination_node->Id)) {
-                    Connect(splitter, splitter_bus++, destination_node->InputNode(), 0);
-                }
-            }
+            Connect(source_node->Id, output_node, 0, destination_id, destination, prev_converters);
+        }
+    } else {
+        // Connecting a single source to multiple destinations requires a splitter node.
+        auto *splitter = source_node->GetSplitter(destinations.size());
+        ma_node_attach_output_bus(output_node, 0, splitter, 0);
+        for (u32 splitter_bus = 0; splitter_bus < destinations.size(); splitter_bus++) {
+            const auto &[destination_id, destination] = destinations[splitter_bus];
+            Connect(source_node->Id, splitter, splitter_bus, destination_id, destination, prev_converters);
         }
     }
+    if (ChannelConverterNodes[source_node->Id].empty()) ChannelConverterNodes.erase(source_node->Id);
+    // Any converters left in `prev_converters` are no longer needed, and are destroyed (and detached) here.
 }
 
-void AudioGraph::Connect(ma_node *source, u32 source_output_bus, ma_node *destination, u32 destination_input_bus) {
+void AudioGraph::Connect(ID source_id, ma_node *source, u32 source_output_bus, ID destination_id, ma_node *destination, ChannelConverterNodeByDestinationId &prev_converters) {
     const u32 out_channels = ma_node_get_output_channels(source, source_output_bus);
-    const u32 in_channels = ma_node_get_input_channels(destination, destination_input_bus);
+    const u32 in_channels = ma_node_get_input_channels(destination, 0);
     if (out_channels != in_channels) {
-        ChannelConverterNodes.emplace_back(std::make_unique<ChannelConverterNode>(this, out_channels, in_channels));
-        ma_node_attach_output_bus(source, source_output_bus, ChannelConverterNodes.back()->Get(), 0);
-        ma_node_attach_output_bus(ChannelConverterNodes.back()->Get(), 0, destination, destination_input_bus);
+        auto &converter = ChannelConverterNodes[source_id][destination_id];
+        if (auto prev_it = prev_converters.find(destination_id);
+            prev_it != prev_converters.end() && prev_it->second->ChannelCount(IO_In) == out_channels && prev_it->second->ChannelCount(IO_Out) == in_channels) {
+            converter = std::move(prev_it->second);
+            prev_converters.erase(prev_it);
+        } else {
+            converter = std::make_unique<ChannelConverterNode>(this, out_channels, in_channels);
+        }
+        ma_node_attach_output_bus(source, source_output_bus, converter->Get(), 0);
+        ma_node_attach_output_bus(converter->Get(), 0, destination, 0);
     } else {
-        ma_node_attach_output_bus(source, source_output_bus, destination, destination_input_bus);
+        ma_node_attach_output_bus(source, source_output_bus, destination, 0);
+    }
+}
+
+std::unordered_set<ID> AudioGraph::FindParallelBranchRootIds() const {
+    // A single thread renders the graph unpartitioned, as the reference for partitioned output.
+    if (GetProcessingThreadCount() == 1) return {};
+
+    // Index the nodes, with the graph endpoint last.
+    static constexpr u32 None = u32(-1);
+    std::vector<const AudioGraphNode *> nodes;
+    nodes.reserve(Nodes.Size() + 1);
+    for (const auto *node : Nodes) nodes.push_back(node);
+    nodes.push_back(this);
+    const u32 n = nodes.size(), graph_index = n - 1;
+    std::unordered_map<ID, u32> index_by_id;
+    for (u32 i = 0; i < n; ++i) index_by_id.emplace(nodes[i]->Id, i);
+    std::vector<std::vector<u32>> destinations(n);
+    for (u32 i = 0; i < n; ++i) {
+        for (const ID destination_id : Connections.GetDestinations(nodes[i]->Id)) {
+            if (auto it = index_by_id.find(destination_id); it != index_by_id.end()) destinations[i].push_back(it->second);
+        }
     }
+
+    // Order the nodes with each node after all of its destinations, and find the nodes on cycles,
+    // using (non-recursive) Tarjan's algorithm, which finds strongly connected components in this order.
+    std::vector<u32> order, visit_index(n, None), low_index(n), component_stack;
+    std::vector<bool> on_stack(n, false), in_cycle(n, false);
+    std::vector<std::pair<u32, u32>> visit_stack; // (Node, next destination)
+    u32 next_visit_index = 0;
+    const auto visit = [&](u32 i) {
+        visit_index[i] = low_index[i] = next_visit_index++;
+        component_stack.push_back(i);
+        on_stack[i] = true;
+        visit_stack.emplace_back(i, 0);
+    };
+    for (u32 start = 0; start < n; ++start) {
+        if (visit_index[start] != None) continue;
+
+        visit(start);
+        while (!visit_stack.empty()) {
+            const auto [i, next] = visit_stack.back();
+            if (next < destinations[i].size()) {
+                ++visit_stack.back().second;
+                const u32 destination = destinations[i][next];
+                if (visit_index[destination] == None) visit(destination);
+                else if (on_stack[destination]) low_index[i] = std::min(low_index[i], visit_index[destination]);
+                continue;
+            }
+            visit_stack.pop_back();
+            if (!visit_stack.empty()) {
+                const u32 parent = visit_stack.back().first;
+                low_index[parent] = std::min(low_index[parent], low_index[i]);
+            }
+            if (low_index[i] != visit_index[i]) continue;
+
+            // `i` is the first visited node of a component.
+            const bool is_cycle = component_stack.back() != i || std::ranges::find(destinations[i], i) != destinations[i].end();
+            u32 member;
+            do {
+                member = component_stack.back();
+                component_stack.pop_back();
+                on_stack[member] = false;
+                in_cycle[member] = is_cycle;
+                order.push_back(member);
+            } while (member != i);
+        }
+    }
+
+    // Find each node's immediate post-dominator: the nearest node that all of its output passes through.
+    // Nodes without destinations and nodes on cycles have none, and all other nodes are visited after their destinations,
+    // so this is a single pass, merging the post-dominator chains of nodes with multiple destinations.
+    std::vector<u32> post_dominator(n, None), depth(n, 0);
+    const auto merge_chains = [&](u32 a, u32 b) {
+        while (a != b && a != None && b != None) {
+            if (depth[a] >= depth[b]) a = post_dominator[a];
+            else b = post_dominator[b];
+        }
+        return a == b ? a : None;
+    };
+    for (const u32 i : order) {
+        if (in_cycle[i] || destinations[i].empty()) continue;
+
+        u32 pd = destinations[i].front();
+        for (const u32 destination : destinations[i]) pd = merge_chains(pd, destination);
+        post_dominator[i] = pd;
+        if (pd != None) depth[i] = depth[pd] + 1;
+    }
+
+    // A node's branch is independent if it post-dominates every node upstream of it.
+    // Each connection leaks out of the branches of the nodes post-dominating its destination but not its source.
+    std::vector<bool> leaks(n, false);
+    for (u32 i = 0; i < n; ++i) {
+        for (const u32 destination : destinations[i]) {
+            for (u32 leaked = destination; leaked != None && leaked != post_dominator[i]; leaked = post_dominator[leaked]) leaks[leaked] = true;
+        }
+    }
+
+    // Keep the outermost roots, visiting post-dominators (which contain the branches they post-dominate) first.
+    std::vector<bool> is_root(n, false), is_nested(n, false);
+    std::unordered_set<ID> root_ids;
+    for (const u32 i : order) {
+        if (const u32 pd = post_dominator[i]; pd != None) is_nested[i] = is_root[pd] || is_nested[pd];
+
+        const auto *node = nodes[i];
+        is_root[i] = i != graph_index && node->IsActive && node->OutputBusCount() > 0 && !in_cycle[i] && !leaks[i] &&
+            destinations[i].size() == 1 && destinations[i].front() != graph_index; // Device outputs are read by the graph endpoint directly.
+        if (is_root[i] && !is_nested[i]) root_ids.insert(node->Id);
+    }
+    // A single branch has nothing to run in parallel with.
+    if (root_ids.size() < 2) root_ids.clear();
+    return root_ids;
+}
+
+void AudioGraph::PublishParallelBranches() {
+    std::vector<AudioGraphBranch *> branches;
+    branches.reserve(BranchByRootId.size());
+    for (const auto &[_, branch] : BranchByRootId) branches.emplace_back(branch.get());
+    Scheduler->SetBranches(std::move(branches));
 }
 
 static void RenderConnectionsLabelFrame(InteractionFlags interaction_flags) {
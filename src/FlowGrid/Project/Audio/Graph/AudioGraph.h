@@ -14,6 +14,9 @@ struct ma_node_graph;
 
 struct InputDeviceNode;
 struct OutputDeviceNode;
+struct AudioGraphReclaimer;
+struct AudioGraphScheduler;
+struct AudioGraphBranch;
 
 inline static const std::string InputDeviceNodeTypeId = "Input";
 inline static const std::string OutputDeviceNodeTypeId = "Output";
@@ -47,10 +50,48 @@ struct AudioGraph
     void OnFaustDspChanged(ID, dsp *) override;
     void OnFaustDspAdded(ID, dsp *) override;
     void OnFaustDspRemoved(ID) override;
+    void OnFaustDspRetired(std::shared_ptr<dsp>) override;
+    bool OnFaustParamChanged(dsp *, Real *zone, Real value) override;
 
     void OnNodeConnectionsChanged(AudioGraphNode *) override;
 
     ma_node_graph *Get();
+
+    // Number of threads used to process the graph, including the audio thread. Zero means one thread per hardware thread.
+    // Read when the graph is created.
+    inline static u32 ProcessingThreadCount{0};
+    u32 GetProcessingThreadCount() const;
+
+    // The number of nodes whose `ma_node` connections were changed by the latest `UpdateConnections`.
+    // Only nodes with a changed inner node or destination are rewired, so toggling a single connection rewires only its source.
+    u32 RewiredNodeCount{0};
+
+    // Pull `frame_count` interleaved stereo f32 frames through the graph endpoint, processing independent branches in parallel.
+    // Returns the number of frames read.
+    u64 ReadPcmFrames(float *output, u32 frame_count);
+
+    // UI thread: Detach a replaced `ma_*` node from the graph, and uninitialize and free it once the audio thread is done with any read that may still reach it.
+    // Unlike uninitializing a node in place, this doesn't wait for a read in progress, and the replacement never reuses the node's memory.
+    template<typename NodeType, typename UninitFn> void RetireNode(std::unique_ptr<NodeType> node, UninitFn uninit) const {
+        if (!node) return;
+
+        auto *ma_node = node.get();
+        DetachAndRetire(ma_node, std::shared_ptr<NodeType>(node.release(), [uninit](NodeType *node) {
+            uninit(node, nullptr);
+            delete node;
+        }));
+    }
+    // UI thread: Detach `node` from the graph, and free `object` (which owns the node) once the audio thread is done with any read that may still reach it.
+    void DetachAndRetire(ma_node *node, std::shared_ptr<void> object) const;
+    // UI thread: Free `object` once the audio thread is done with any read that may still reach it.
+    // `object` must already be unreachable by new reads, e.g. swapped out of a node.
+    void Retire(std::shared_ptr<void> object) const;
+    // UI thread: Free the retired objects the audio thread is done with (see `AudioGraphReclaimer`). Called every frame.
+    void CollectRetired() const;
+
+    // Pull `frame_count` interleaved stereo f32 frames through the graph endpoint on the calling thread.
+    // Only for offline rendering, when no device is driving the graph (see `AudioDevice::Offline`).
+    void RenderOffline(float *output, u32 frame_count);
     dsp *GetFaustDsp(ID id) const;
 
     // A sample rate is considered "native" by the graph (and suffixed with an asterix)
@@ -137,8 +178,34 @@ private:
     void Render() const override;
     void RenderNodeCreateSelector() const;
 
+    // The `ma_node` connections made for a node during the latest `UpdateConnections`.
+    // Only nodes whose wiring differs from their previous wiring (or is marked stale) have their connections updated.
+    struct NodeWiring {
+        // Inner nodes, from the graph-visible input node to the node, and from the node to the graph-visible output node.
+        // Empty if the node is inactive.
+        std::vector<ma_node *> InputChain, OutputChain;
+        std::vector<std::pair<ID, ma_node *>> Destinations; // (Destination node ID, graph-visible input node), in connection order.
+        bool IsParallelBranchRoot{false}; // The node's output is rendered by its own `AudioGraphBranch`.
+
+        bool operator==(const NodeWiring &) const = default;
+    };
+    using ChannelConverterNodeByDestinationId = std::unordered_map<ID, std::unique_ptr<ChannelConverterNode>>;
+
     void UpdateConnections();
-    void Connect(ma_node *source, u32 source_output_bus, ma_node *destination, u32 destination_input_bus);
+    // Looks up the node's destinations in the connection index, so wiring all nodes is linear in the number of connections.
+    NodeWiring CreateWiring(const AudioGraphNode *, const std::unordered_map<ID, AudioGraphNode *> &destination_node_by_id, bool is_parallel_branch_root) const;
+    void UpdateOutputConnections(AudioGraphNode *source, const NodeWiring &);
+    // Connect the source to the destination, through a channel converter if their channel counts differ.
+    // Converters in `prev_converters` are reused if their channel counts still match.
+    void Connect(ID source_id, ma_node *source, u32 source_output_bus, ID destination_id, ma_node *destination, ChannelConverterNodeByDestinationId &prev_converters);
+
+    // A parallel branch is an active node (the branch root) with a single destination, along with all of its upstream nodes,
+    // where no node upstream of the root has a destination outside the branch.
+    // Returns the roots of the outermost (non-nested) branches, or nothing if there are fewer than two.
+    // Nodes on cycles are never branch roots, and neither are nodes downstream of them.
+    // Runs in a single pass over the nodes in reverse topological order, using their post-dominators.
+    std::unordered_set<ID> FindParallelBranchRootIds() const;
+    void PublishParallelBranches();
 
     AudioGraphNode *FindByPathSegment(string_view path_segment) const {
         auto node_it = std::find_if(Nodes.begin(), Nodes.end(), [path_segment](const auto *node) { return node->PathSegment == path_segment; });
@@ -158,6 +225,13 @@ private:
             std::views::transform([](const auto &node) { return reinterpret_cast<OutputDeviceNode *>(node.get()); });
     }
 
-    std::vector<std::unique_ptr<ChannelConverterNode>> ChannelConverterNodes;
+    std::unordered_map<ID, ChannelConverterNodeByDestinationId> ChannelConverterNodes; // By source node ID.
+    std::unordered_map<ID, NodeWiring> WiringByNodeId;
+    // Nodes whose `ma_node` connections were invalidated (e.g. by re-initializing an inner node in place), and must be fully reconnected.
+    std::unordered_set<ID> StaleWiringNodeIds;
     std::unordered_map<ID, dsp *> DspById;
+
+    std::unique_ptr<AudioGraphReclaimer> Reclaimer; // Destroyed after the scheduler and branches, freeing everything retired to it.
+    std::unique_ptr<AudioGraphScheduler> Scheduler;
+    std::unordered_map<ID, std::unique_ptr<AudioGraphBranch>> BranchByRootId; // Destroyed before the scheduler.
 };
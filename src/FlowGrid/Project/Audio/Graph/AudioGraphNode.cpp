@@ -8,7 +8,6 @@
 
 // Custom nodes.
 #include "ma_gainer_node/ma_gainer_node.h"
-#include "ma_monitor_node/fft_data.h"
 #include "ma_monitor_node/ma_monitor_node.h"
 #include "ma_monitor_node/window_functions.h"
 #include "ma_panner_node/ma_panner_node.h"
@@ -20,31 +19,29 @@ AudioGraphNode::GainerNode::GainerNode(ComponentArgs &&args)
     Component::References listening_to = {Muted, Level, Smooth};
     for (const auto &component : listening_to) component.get().RegisterChangeListener(this);
 
-    Gainer = std::make_unique<ma_gainer_node>();
-    Init();
+    Gainer = Create();
 }
 
 AudioGraphNode::GainerNode::~GainerNode() {
-    Uninit();
+    ParentNode->Graph->RetireNode(std::move(Gainer), ma_gainer_node_uninit);
 }
 
-void AudioGraphNode::GainerNode::Init() {
+std::unique_ptr<ma_gainer_node> AudioGraphNode::GainerNode::Create() const {
+    auto gainer = std::make_unique<ma_gainer_node>();
     const u32 smooth_time_frames = Smooth ? (float(SmoothTimeMs) * float(SampleRate) / 1000.f) : 0;
     auto config = ma_gainer_node_config_init(ParentNode->OutputChannelCount(0), Muted ? 0.f : float(Level), smooth_time_frames);
-    ma_result result = ma_gainer_node_init(ParentNode->Graph->Get(), &config, nullptr, Get());
+    ma_result result = ma_gainer_node_init(ParentNode->Graph->Get(), &config, nullptr, gainer.get());
     if (result != MA_SUCCESS) { throw std::runtime_error(std::format("Failed to initialize gainer node: {}", int(result))); }
+    return gainer;
 }
 
-void AudioGraphNode::GainerNode::Uninit() {
-    ma_gainer_node_uninit(Get(), nullptr);
+void AudioGraphNode::GainerNode::Recreate() {
+    ParentNode->Graph->RetireNode(std::exchange(Gainer, Create()), ma_gainer_node_uninit);
+    ParentNode->NotifyConnectionsChanged();
 }
 
 void AudioGraphNode::GainerNode::OnComponentChanged() {
-    if (Smooth.IsChanged()) {
-        Uninit();
-        Init();
-        ParentNode->NotifyConnectionsChanged();
-    }
+    if (Smooth.IsChanged()) Recreate();
     if (Muted.IsChanged() || Level.IsChanged()) UpdateLevel();
 }
 
@@ -62,9 +59,7 @@ void AudioGraphNode::GainerNode::SetMuted(bool muted) {
 void AudioGraphNode::GainerNode::SetSampleRate(u32 sample_rate) {
     if (SampleRate != sample_rate) {
         SampleRate = sample_rate;
-        Uninit();
-        Init();
-        ParentNode->NotifyConnectionsChanged();
+        Recreate();
     }
 }
 
@@ -89,7 +84,7 @@ AudioGraphNode::PannerNode::PannerNode(ComponentArgs &&args)
 }
 
 AudioGraphNode::PannerNode::~PannerNode() {
-    ma_panner_node_uninit(Get(), nullptr);
+    ParentNode->Graph->RetireNode(std::move(Panner), ma_panner_node_uninit);
     UnregisterChangeListener(this);
 }
 
@@ -132,25 +127,21 @@ AudioGraphNode::MonitorNode::MonitorNode(ComponentArgs &&args)
     Component::References listening_to = {WindowType, WindowLength};
     for (const auto &component : listening_to) component.get().RegisterChangeListener(this);
 
-    Monitor = std::make_unique<ma_monitor_node>();
-    Init();
+    Monitor = Create();
+    UpdateWindowType();
 }
 
 AudioGraphNode::MonitorNode::~MonitorNode() {
-    Uninit();
+    ParentNode->Graph->RetireNode(std::move(Monitor), ma_monitor_node_uninit);
     UnregisterChangeListener(this);
 }
 
-void AudioGraphNode::MonitorNode::Init() {
+std::unique_ptr<ma_monitor_node> AudioGraphNode::MonitorNode::Create() const {
+    auto monitor = std::make_unique<ma_monitor_node>();
     auto config = ma_monitor_node_config_init(ParentNode->ChannelCount(Type, 0), WindowLength);
-    ma_result result = ma_monitor_node_init(ParentNode->Graph->Get(), &config, nullptr, Get());
+    ma_result result = ma_monitor_node_init(ParentNode->Graph->Get(), &config, nullptr, monitor.get());
     if (result != MA_SUCCESS) throw std::runtime_error(std::format("Failed to initialize monitor node: {}", int(result)));
-
-    UpdateWindowType();
-}
-
-void AudioGraphNode::MonitorNode::Uninit() {
-    ma_monitor_node_uninit(Get(), nullptr);
+    return monitor;
 }
 
 void AudioGraphNode::MonitorNode::OnComponentChanged() {
@@ -166,9 +157,10 @@ void AudioGraphNode::MonitorNode::UpdateWindowType() {
 }
 
 void AudioGraphNode::MonitorNode::UpdateWindowLength() {
-    // Recreate the monitor node to update the buffer size.
-    Uninit();
-    Init();
+    // Replace the monitor node to update the buffer size.
+    // The previous node's buffers and FFT plan are freed once the audio thread is done with it.
+    ParentNode->Graph->RetireNode(std::exchange(Monitor, Create()), ma_monitor_node_uninit);
+    UpdateWindowType();
     ParentNode->NotifyConnectionsChanged();
 }
 
@@ -189,47 +181,46 @@ void AudioGraphNode::MonitorNode::RenderWaveform() const {
         ImPlot::SetupAxisLimits(ImAxis_X1, 0, N, ImGuiCond_Always);
         ImPlot::SetupAxisLimits(ImAxis_Y1, -1.1, 1.1, ImGuiCond_Always);
         if (ParentNode->IsActive) {
-            for (u32 channel_index = 0; channel_index < Monitor->config.channels; channel_index++) {
-                const std::string channel_name = std::format("Channel {}", channel_index);
-                ImPlot::PushStyleVar(ImPlotStyleVar_Marker, ImPlotMarker_None);
-                ImPlot::PlotLine(channel_name.c_str(), Monitor->buffer, N);
-                ImPlot::PopStyleVar();
+            const auto *frame = ma_monitor_node_get_frame(Monitor.get());
+            ImPlot::PushStyleVar(ImPlotStyleVar_Marker, ImPlotMarker_None);
+            for (u32 channel = 0; channel < Monitor->config.channels; channel++) {
+                ImPlot::PlotLine(std::format("Channel {}", channel).c_str(), frame->buffers[channel], N);
             }
+            ImPlot::PopStyleVar();
         }
         ImPlot::EndPlot();
     }
 }
 
 void AudioGraphNode::MonitorNode::RenderMagnitudeSpectrum() const {
-    if (ImPlot::BeginPlot("Magnitude spectrum", {-1, 160})) {
+    const auto *frame = ma_monitor_node_get_frame(Monitor.get());
+    const u32 channels = Monitor->config.channels;
+    if (!StackChannels || channels == 1) {
+        RenderMagnitudeSpectrum("Magnitude spectrum", *frame, 0, channels);
+    } else {
+        for (u32 channel = 0; channel < channels; channel++) {
+            RenderMagnitudeSpectrum(std::format("Magnitude spectrum (channel {})", channel).c_str(), *frame, channel, channel + 1);
+        }
+    }
+}
+
+// Magnitudes are converted to dB by the analysis worker, once per analysis frame.
+void AudioGraphNode::MonitorNode::RenderMagnitudeSpectrum(const char *title, const ma_monitor_frame &frame, u32 channel_begin, u32 channel_end) const {
+    if (ImPlot::BeginPlot(title, {-1, 160})) {
         static const float MIN_DB = -100;
-        const fft_data *fft = Monitor->fft;
         const u32 N = Monitor->config.buffer_frames;
         const u32 N_2 = N / 2;
         const float fs = ParentNode->Graph->SampleRate;
         const float fs_n = fs / float(N);
 
-        static std::vector<float> frequency(N_2);
-        static std::vector<float> magnitude(N_2);
-        frequency.resize(N_2);
-        magnitude.resize(N_2);
-
-        const auto *data = fft->data; // Complex values.
-        for (u32 i = 0; i < N_2; i++) {
-            frequency[i] = fs_n * float(i);
-            const float mag_linear = sqrtf(data[i][0] * data[i][0] + data[i][1] * data[i][1]) / float(N_2);
-            magnitude[i] = ma_volume_linear_to_db(mag_linear);
-        }
-
         ImPlot::SetupAxes("Frequency bin", "Magnitude (dB)");
         ImPlot::SetupAxisLimits(ImAxis_X1, 0, fs / 2, ImGuiCond_Always);
         ImPlot::SetupAxisLimits(ImAxis_Y1, MIN_DB, 0, ImGuiCond_Always);
         if (ParentNode->IsActive) {
             ImPlot::PushStyleVar(ImPlotStyleVar_Marker, ImPlotMarker_None);
-            // ImPlot::PushStyleColor(ImPlotCol_Fill, {1.f, 0.f, 0.f, 1.f});
-            // todo per-channel
-            ImPlot::PlotShaded("1", frequency.data(), magnitude.data(), N_2, MIN_DB);
-            // ImPlot::PopStyleColor();
+            for (u32 channel = channel_begin; channel < channel_end; channel++) {
+                ImPlot::PlotShaded(std::format("Channel {}", channel).c_str(), frame.magnitudes_db[channel], N_2, MIN_DB, fs_n, 0);
+            }
             ImPlot::PopStyleVar();
         }
         ImPlot::EndPlot();
@@ -242,6 +233,7 @@ void AudioGraphNode::MonitorNode::Render() const {
     WindowLength.Render(WindowLengthOptions);
     SetNextItemWidth(GetFontSize() * 9);
     WindowType.Draw();
+    StackChannels.Draw();
     RenderWaveform();
     RenderMagnitudeSpectrum();
 }
@@ -271,12 +263,7 @@ AudioGraphNode::AudioGraphNode(ComponentArgs &&args, CreateNodeFunction create_n
 
 AudioGraphNode::~AudioGraphNode() {
     DisconnectOutput();
-    Splitter.reset();
-    InputGainer.Reset();
-    InputMonitor.Reset();
-    OutputGainer.Reset();
-    Panner.Reset();
-    OutputMonitor.Reset();
+    ResetInnerNodes();
 
     Listeners.clear();
     UnregisterChangeListener(this);
@@ -328,16 +315,37 @@ u32 AudioGraphNode::OutputBusCount() const { return IsGraphEndpoint() ? 0 : ma_n
 u32 AudioGraphNode::InputChannelCount(u32 bus) const { return ma_node_get_input_channels(Get(), bus); }
 u32 AudioGraphNode::OutputChannelCount(u32 bus) const { return ma_node_get_output_channels(Get(), bus); }
 
+// Inner nodes are retired to the graph when destroyed, so this doesn't wait for the audio thread.
+void AudioGraphNode::ResetInnerNodes() {
+    ResetSplitter();
+    InputGainer.Reset();
+    InputMonitor.Reset();
+    OutputGainer.Reset();
+    Panner.Reset();
+    OutputMonitor.Reset();
+}
+
 void AudioGraphNode::DisconnectOutput() {
     ma_node_detach_all_output_buses(OutputNode());
-    Splitter.reset();
+    ResetSplitter();
 }
 
-ma_node *AudioGraphNode::CreateSplitter(u32 destination_count) {
-    Splitter = std::make_unique<SplitterNode>(Graph->Get(), destination_count, OutputChannelCount(0));
+ma_node *AudioGraphNode::GetSplitter(u32 destination_count) {
+    const u32 channels = ma_node_get_output_channels(OutputNode(), 0);
+    if (!Splitter || ma_node_get_output_bus_count(Splitter->Get()) != destination_count || ma_node_get_input_channels(Splitter->Get(), 0) != channels) {
+        ResetSplitter();
+        Splitter = std::make_unique<SplitterNode>(Graph->Get(), destination_count, channels);
+    }
     return Splitter->Get();
 }
 
+void AudioGraphNode::ResetSplitter() {
+    if (!Splitter) return;
+
+    auto *splitter_node = Splitter->Get();
+    Graph->DetachAndRetire(splitter_node, std::shared_ptr<SplitterNode>(std::move(Splitter)));
+}
+
 std::string NodesToString(const std::unordered_set<AudioGraphNode *> &nodes, bool is_input) {
     if (nodes.empty()) return "";
 
@@ -15,6 +15,7 @@ struct ma_channel_converter_node;
 struct ma_gainer_node;
 struct ma_panner_node;
 struct ma_monitor_node;
+struct ma_monitor_frame;
 
 using WindowFunctionType = void (*)(float *, unsigned);
 
@@ -98,7 +99,11 @@ struct AudioGraphNode : Component, Component::ChangeListener {
     ma_node *OutputNode() const;
 
     void DisconnectOutput();
-    ma_node *CreateSplitter(u32 destination_count);
+    // Returns a splitter node with `destination_count` output buses for the graph-visible output node.
+    // The current splitter is reused if it already has the required bus and channel counts.
+    ma_node *GetSplitter(u32 destination_count);
+    // Retire the splitter (if any) to the graph.
+    void ResetSplitter();
 
     // The graph is responsible for calling this method whenever the topology of the graph changes.
     // When this node is connected to the graph endpoing node (directly or indirectly), it is considered active.
@@ -127,11 +132,12 @@ struct AudioGraphNode : Component, Component::ChangeListener {
 
         void UpdateLevel();
 
-        // When `Smooth` is toggled, we need to reset the gainer node, since MA doesn't support dynamically changing smooth time.
+        // When `Smooth` is toggled, we need to replace the gainer node, since MA doesn't support dynamically changing smooth time.
         // We may be able to get around this by using `ma_gainer_set_master_volume` instead of `set_gain` when smoothing is disabled.
-        // But even then, we would need to re-init when changing the smooth time via sample rate changes.
-        void Init();
-        void Uninit();
+        // But even then, we would need to replace it when changing the smooth time via sample rate changes.
+        std::unique_ptr<ma_gainer_node> Create() const;
+        // Swap in a new gainer node, retiring the current one to the graph.
+        void Recreate();
 
         AudioGraphNode *ParentNode;
         std::unique_ptr<ma_gainer_node> Gainer;
@@ -202,12 +208,13 @@ struct AudioGraphNode : Component, Component::ChangeListener {
             {"Rectangular", "Hann", "Hamming", "Blackman", "Blackman-Harris", "Nuttall", "Flat-Top", "Triangular", "Bartlett", "Bartlett-Hann", "Bohman", "Parzen"},
             WindowType_BlackmanHarris
         );
+        Prop_(Bool, StackChannels, "?Plot each channel's magnitude spectrum separately, instead of overlaying all channels in one plot.", false);
 
     private:
         void Render() const override;
+        void RenderMagnitudeSpectrum(const char *title, const ma_monitor_frame &, u32 channel_begin, u32 channel_end) const;
 
-        void Init();
-        void Uninit();
+        std::unique_ptr<ma_monitor_node> Create() const;
 
         AudioGraphNode *ParentNode;
         IO Type;
@@ -230,6 +237,9 @@ struct AudioGraphNode : Component, Component::ChangeListener {
 protected:
     void Render() const override;
 
+    // Remove the splitter and the gainer, panner, and monitor nodes.
+    void ResetInnerNodes();
+
     std::unique_ptr<MaNode> Node;
 
     Prop(Optional<GainerNode>, InputGainer);
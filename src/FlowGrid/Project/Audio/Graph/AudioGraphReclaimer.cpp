@@ -0,0 +1,29 @@
+#include "AudioGraphReclaimer.h"
+
+#include <algorithm>
+
+void AudioGraphReclaimer::BeginRead() {
+    // Re-check the epoch after publishing it, so a concurrent `Collect` either sees this read,
+    // or only frees objects retired before it started.
+    u64 epoch;
+    do {
+        epoch = Epoch.load();
+        ReadEpoch.store(epoch);
+    } while (epoch != Epoch.load());
+}
+
+void AudioGraphReclaimer::EndRead() { ReadEpoch.store(0, std::memory_order_release); }
+
+void AudioGraphReclaimer::Retire(std::shared_ptr<void> object) {
+    if (!object) return;
+
+    RetiredObjects.push_back({Epoch.fetch_add(1), std::move(object)});
+    Collect();
+}
+
+void AudioGraphReclaimer::Collect() {
+    if (RetiredObjects.empty()) return;
+
+    const u64 read_epoch = ReadEpoch.load();
+    std::erase_if(RetiredObjects, [read_epoch](const auto &retired) { return read_epoch == 0 || read_epoch > retired.Epoch; });
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "Core/Primitive/Scalar.h"
+
+/**
+Epoch-based reclamation for objects the audio thread may still be reading after the UI thread replaces them:
+published processing plans, parallel branches, and re-initialized inner nodes (along with their buffers and FFT plans).
+
+The UI thread first makes an object unreachable for new reads, and then retires it, tagging it with the current epoch and advancing the epoch.
+The audio thread publishes the epoch each graph read started in, and a retired object is freed once no read is in progress,
+or once the read in progress started after the object was retired.
+Neither thread waits on the other: the audio thread never frees anything, and the UI thread frees what it can whenever it collects.
+When no device is running (e.g. offline rendering), retired objects are freed immediately.
+Any remaining retired objects are freed on destruction, after the audio thread is done reading.
+*/
+struct AudioGraphReclaimer {
+    // Audio thread: Mark the start and end of a graph read. Reads must not overlap.
+    void BeginRead();
+    void EndRead();
+
+    // UI thread: Free `object` once the audio thread can no longer be reading it.
+    // `object` must already be unreachable by reads starting after this call.
+    void Retire(std::shared_ptr<void> object);
+    // UI thread: Free the retired objects the audio thread is done with.
+    void Collect();
+
+private:
+    struct RetiredObject {
+        u64 Epoch;
+        std::shared_ptr<void> Object;
+    };
+
+    std::atomic<u64> Epoch{1};
+    std::atomic<u64> ReadEpoch{0}; // The epoch the read in progress started in, or zero if the audio thread isn't reading.
+    std::vector<RetiredObject> RetiredObjects;
+};
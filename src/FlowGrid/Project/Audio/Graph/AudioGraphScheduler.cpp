@@ -0,0 +1,208 @@
+#include "AudioGraphScheduler.h"
+#include "AudioGraphReclaimer.h"
+
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+// Hint to the CPU that we're spin-waiting.
+static inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// Best-effort: Fails without the required privileges, in which case the thread keeps its normal priority.
+static void SetRealtimePriority(std::thread &thread) {
+#ifndef _WIN32
+    const int min_priority = sched_get_priority_min(SCHED_FIFO), max_priority = sched_get_priority_max(SCHED_FIFO);
+    sched_param param{};
+    param.sched_priority = (min_priority + max_priority) / 2; // Leave room above for the audio device thread.
+    pthread_setschedparam(thread.native_handle(), SCHED_FIFO, &param);
+#else
+    (void)thread;
+#endif
+}
+
+const ma_data_source_vtable AudioGraphBranch::BlockSourceVtable = {
+    [](ma_data_source *data_source, void *frames_out, ma_uint64 frame_count, ma_uint64 *frames_read) {
+        return ((BlockDataSource *)data_source)->Branch->ReadBlock((float *)frames_out, frame_count, frames_read);
+    },
+    [](ma_data_source *, ma_uint64) { return MA_SUCCESS; }, // Blocks are only read forward.
+    [](ma_data_source *data_source, ma_format *format, ma_uint32 *channels, ma_uint32 *sample_rate, ma_channel *channel_map, size_t channel_map_cap) {
+        const u32 branch_channels = ((BlockDataSource *)data_source)->Branch->Channels;
+        *format = ma_format_f32;
+        *channels = branch_channels;
+        *sample_rate = 0;
+        ma_channel_map_init_standard(ma_standard_channel_map_default, channel_map, channel_map_cap, branch_channels);
+        return MA_SUCCESS;
+    },
+    [](ma_data_source *data_source, ma_uint64 *cursor) {
+        *cursor = ((BlockDataSource *)data_source)->Branch->ReadFrames;
+        return MA_SUCCESS;
+    },
+    [](ma_data_source *, ma_uint64 *) { return MA_NOT_IMPLEMENTED; },
+    nullptr,
+    0,
+};
+
+AudioGraphBranch::AudioGraphBranch(ma_node_graph *main_graph, u32 channels) : Channels(channels) {
+    auto graph_config = ma_node_graph_config_init(channels);
+    if (ma_result result = ma_node_graph_init(&graph_config, nullptr, &Graph); result != MA_SUCCESS) {
+        throw std::runtime_error(std::format("Failed to initialize branch node graph: {}", int(result)));
+    }
+
+    Buffer.resize(AudioGraphScheduler::MaxBlockFrames * channels);
+    BlockSource.Branch = this;
+    auto data_source_config = ma_data_source_config_init();
+    data_source_config.vtable = &BlockSourceVtable;
+    if (ma_result result = ma_data_source_init(&data_source_config, &BlockSource.Base); result != MA_SUCCESS) {
+        ma_node_graph_uninit(&Graph, nullptr);
+        throw std::runtime_error(std::format("Failed to initialize branch data source: {}", int(result)));
+    }
+
+    auto source_config = ma_data_source_node_config_init(&BlockSource);
+    if (ma_result result = ma_data_source_node_init(main_graph, &source_config, nullptr, &Source); result != MA_SUCCESS) {
+        ma_data_source_uninit(&BlockSource.Base);
+        ma_node_graph_uninit(&Graph, nullptr);
+        throw std::runtime_error(std::format("Failed to initialize branch source node: {}", int(result)));
+    }
+}
+
+AudioGraphBranch::~AudioGraphBranch() {
+    ma_data_source_node_uninit(&Source, nullptr);
+    ma_data_source_uninit(&BlockSource.Base);
+    ma_node_graph_uninit(&Graph, nullptr);
+}
+
+ma_node *AudioGraphBranch::GetEndpoint() { return ma_node_graph_get_endpoint(&Graph); }
+ma_node *AudioGraphBranch::GetSource() { return &Source; }
+
+void AudioGraphBranch::Render(u32 frame_count) {
+    ma_uint64 frames_read = 0;
+    ma_node_graph_read_pcm_frames(&Graph, Buffer.data(), frame_count, &frames_read);
+    if (frames_read < frame_count) std::fill(Buffer.begin() + frames_read * Channels, Buffer.begin() + u64(frame_count) * Channels, 0.f);
+    RenderedFrames = frame_count;
+    ReadFrames = 0;
+}
+
+ma_result AudioGraphBranch::ReadBlock(float *output, u64 frame_count, ma_uint64 *frames_read) {
+    u64 frame = 0;
+    while (frame < frame_count) {
+        // The block wasn't rendered ahead of this read (or was fully read), so render it now.
+        if (ReadFrames == RenderedFrames) Render(std::min(u64(AudioGraphScheduler::MaxBlockFrames), frame_count - frame));
+
+        const u32 read_frames = std::min(u64(RenderedFrames - ReadFrames), frame_count - frame);
+        std::copy_n(Buffer.data() + u64(ReadFrames) * Channels, u64(read_frames) * Channels, output + frame * Channels);
+        ReadFrames += read_frames;
+        frame += read_frames;
+    }
+    if (frames_read) *frames_read = frame;
+    return MA_SUCCESS;
+}
+
+AudioGraphScheduler::AudioGraphScheduler(u32 thread_count, AudioGraphReclaimer &reclaimer) : Reclaimer(reclaimer) {
+    if (thread_count == 0) thread_count = std::max(1u, std::thread::hardware_concurrency());
+    // The audio thread renders branches too.
+    for (u32 i = 1; i < thread_count; i++) {
+        Workers.emplace_back([this] { RunWorker(); });
+        SetRealtimePriority(Workers.back());
+    }
+}
+
+AudioGraphScheduler::~AudioGraphScheduler() {
+    Running.store(false);
+    Epoch.fetch_add(1);
+    Epoch.notify_all();
+    for (auto &worker : Workers) worker.join();
+    delete ActiveBranches.load();
+}
+
+void AudioGraphScheduler::SetBranches(std::vector<AudioGraphBranch *> branches) {
+    std::unique_ptr<Branches> prev_branches{ActiveBranches.exchange(branches.empty() ? nullptr : new Branches(std::move(branches)))};
+    Reclaimer.Retire(std::move(prev_branches));
+}
+
+u64 AudioGraphScheduler::Read(ma_node_graph *graph, float *output, u32 frame_count) {
+    // The reclaimer keeps this plan alive until the read ends, even if it's replaced in the meantime.
+    const Branches *branches = ActiveBranches.load(std::memory_order_acquire);
+    ma_uint64 frames_read = 0;
+    if (!branches) {
+        ma_node_graph_read_pcm_frames(graph, output, frame_count, &frames_read);
+        return frames_read;
+    }
+
+    const u32 channels = ma_node_graph_get_channels(graph);
+    for (u32 frame = 0; frame < frame_count;) {
+        const u32 block_frames = std::min(MaxBlockFrames, frame_count - frame);
+        RenderBranches(*branches, block_frames);
+        ma_uint64 block_frames_read = 0;
+        ma_node_graph_read_pcm_frames(graph, output + u64(frame) * channels, block_frames, &block_frames_read);
+        frames_read += block_frames_read;
+        if (block_frames_read < block_frames) break;
+        frame += block_frames;
+    }
+    return frames_read;
+}
+
+void AudioGraphScheduler::RenderBranches(const Branches &branches, u32 frame_count) {
+    if (Workers.empty() || branches.size() == 1) {
+        for (auto *branch : branches) branch->Render(frame_count);
+        return;
+    }
+
+    TaskBranches = &branches;
+    TaskFrameCount = frame_count;
+    const u32 epoch = Epoch.load(std::memory_order_relaxed) + 1;
+    RemainingTasks.store(branches.size(), std::memory_order_relaxed);
+    NextTask.store(u64(epoch) << 32 | u64(branches.size()) << 16, std::memory_order_release);
+    // Sequentially consistent with the workers' `ParkedWorkers` increment and `Epoch` check,
+    // so either we see a parked worker, or it sees the new epoch.
+    Epoch.store(epoch, std::memory_order_seq_cst);
+    if (ParkedWorkers.load(std::memory_order_seq_cst) != 0) Epoch.notify_all();
+
+    RunTasks(epoch);
+    // Every branch has been claimed, and the rest are rendering on (real-time) workers.
+    while (RemainingTasks.load(std::memory_order_acquire) != 0) CpuRelax();
+}
+
+void AudioGraphScheduler::RunTasks(u32 epoch) {
+    u64 task = NextTask.load(std::memory_order_acquire);
+    while (true) {
+        const u32 task_epoch = task >> 32, count = (task >> 16) & 0xffff, index = task & 0xffff;
+        if (task_epoch != epoch || index >= count) return;
+        if (!NextTask.compare_exchange_weak(task, task + 1, std::memory_order_acq_rel, std::memory_order_acquire)) continue;
+
+        (*TaskBranches)[index]->Render(TaskFrameCount);
+        RemainingTasks.fetch_sub(1, std::memory_order_release);
+        task = NextTask.load(std::memory_order_acquire);
+    }
+}
+
+void AudioGraphScheduler::RunWorker() {
+    static constexpr u32 SpinCount = 4096; // Spin for a fraction of a typical block before parking.
+
+    u32 epoch = Epoch.load(std::memory_order_acquire);
+    while (true) {
+        u32 next_epoch = Epoch.load(std::memory_order_acquire);
+        for (u32 i = 0; i < SpinCount && next_epoch == epoch; i++) {
+            CpuRelax();
+            next_epoch = Epoch.load(std::memory_order_acquire);
+        }
+        if (next_epoch == epoch) {
+            ParkedWorkers.fetch_add(1, std::memory_order_seq_cst);
+            Epoch.wait(epoch, std::memory_order_seq_cst);
+            ParkedWorkers.fetch_sub(1, std::memory_order_relaxed);
+            next_epoch = Epoch.load(std::memory_order_acquire);
+        }
+        epoch = next_epoch;
+        if (!Running.load()) return;
+        RunTasks(epoch);
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "miniaudio.h"
+
+#include "Core/Primitive/Scalar.h"
+
+struct AudioGraphReclaimer;
+
+// A subgraph terminated by its own `ma_node_graph` endpoint, rendered into a buffer that the main graph reads through a data source node.
+// The branch's output node is attached to `GetEndpoint()` instead of to its destination, and `GetSource()` is attached to the destination in its place.
+// If the main graph reads the source before the branch's block was rendered (e.g. before the branch is published to the scheduler),
+// the source renders it on the reading thread, so a branch never outputs silence in place of its input.
+struct AudioGraphBranch {
+    AudioGraphBranch(ma_node_graph *main_graph, u32 channels);
+    ~AudioGraphBranch();
+
+    ma_node *GetEndpoint();
+    ma_node *GetSource();
+
+    // Pull `frame_count` (at most `AudioGraphScheduler::MaxBlockFrames`) frames through the branch, for the main graph's next read.
+    void Render(u32 frame_count);
+
+    const u32 Channels;
+
+private:
+    // A data source reading the rendered block.
+    struct BlockDataSource {
+        ma_data_source_base Base; // Must be first.
+        AudioGraphBranch *Branch;
+    };
+    static const ma_data_source_vtable BlockSourceVtable;
+
+    ma_result ReadBlock(float *output, u64 frame_count, ma_uint64 *frames_read);
+
+    ma_node_graph Graph;
+    std::vector<float> Buffer;
+    u32 RenderedFrames{0}, ReadFrames{0}; // Of the current block in `Buffer`.
+    BlockDataSource BlockSource;
+    ma_data_source_node Source;
+};
+
+/**
+Processes independent branches of an audio graph concurrently, before pulling the rest of the graph.
+Branches don't share any nodes or connections, so they can be rendered in any order, on any thread.
+The rest of the graph reads each branch's rendered block like any other input, so miniaudio sums branches at their join points.
+
+For each block, the audio thread publishes the block's branches to the worker pool, renders branches itself until none are left,
+waits for the rest to finish on a lock-free countdown, and then pulls the main graph.
+Neither the audio thread nor the workers lock or allocate. Workers run at real-time priority (where permitted), so the audio thread
+isn't left waiting on a preempted worker. Between blocks, workers spin briefly before parking on an atomic wait,
+and the audio thread only wakes workers (a syscall) if any are parked.
+
+The branch partition doesn't depend on the thread count, so the output is identical for any number of threads above one.
+With a single thread, the graph isn't partitioned (see `AudioGraph::FindParallelBranchRootIds`).
+
+Each set of branches is published as an immutable plan, and replaced plans are retired to the graph's reclaimer,
+so the UI thread never waits for the audio thread to finish a block.
+*/
+struct AudioGraphScheduler {
+    static constexpr u32 MaxBlockFrames = 4096; // Larger reads are processed in blocks of at most this many frames.
+
+    // `thread_count` includes the audio thread. Zero means one thread per hardware thread.
+    AudioGraphScheduler(u32 thread_count, AudioGraphReclaimer &);
+    ~AudioGraphScheduler();
+
+    u32 GetThreadCount() const { return Workers.size() + 1; }
+
+    // UI thread: Set the branches to render before each read.
+    // Reads in progress may still be rendering the previous branches, so they must be retired rather than destroyed (see `AudioGraphReclaimer`).
+    void SetBranches(std::vector<AudioGraphBranch *>);
+
+    // Audio thread: Pull `frame_count` frames through the graph endpoint, rendering all branches first.
+    // Must be called between the reclaimer's `BeginRead` and `EndRead`.
+    // Returns the number of frames read.
+    u64 Read(ma_node_graph *, float *output, u32 frame_count);
+
+private:
+    using Branches = std::vector<AudioGraphBranch *>;
+
+    void RenderBranches(const Branches &, u32 frame_count);
+    void RunTasks(u32 epoch);
+    void RunWorker();
+
+    AudioGraphReclaimer &Reclaimer;
+    std::atomic<Branches *> ActiveBranches{nullptr};
+
+    // The current block's task state. `NextTask` packs the block's epoch (upper 32 bits), its branch count (next 16), and the next unclaimed branch index (lower 16),
+    // so a worker still finishing the previous block can't claim a task from the next one.
+    std::atomic<u64> NextTask{0};
+    std::atomic<u32> Epoch{0}; // Incremented to wake workers for each block, and to stop them.
+    std::atomic<u32> ParkedWorkers{0}; // Workers waiting on `Epoch` (rather than spinning), which must be notified.
+    std::atomic<u32> RemainingTasks{0};
+    std::atomic<bool> Running{true};
+    const Branches *TaskBranches{nullptr}; // Written before publishing `NextTask`.
+    u32 TaskFrameCount{0};
+
+    std::vector<std::thread> Workers;
+};
@@ -1,12 +1,16 @@
 #include "ma_faust_node.h"
 
 #include "../ma_helper.h"
+#include "../ma_simd/ma_simd.h"
 
 #ifndef FAUSTFLOAT
 #define FAUSTFLOAT float
 #endif
 
 #include "faust/dsp/dsp.h"
+#include "faust/gui/UI.h"
+
+#include <algorithm>
 
 ma_faust_node_config ma_faust_node_config_init(dsp *faust_dsp, ma_uint32 sample_rate, ma_uint32 buffer_frames) {
     ma_faust_node_config config;
@@ -32,50 +36,164 @@ ma_uint32 ma_faust_node_get_sample_rate(ma_faust_node *faust_node) {
 ma_result ma_faust_node_set_sample_rate(ma_faust_node *faust_node, ma_uint32 sample_rate) {
     if (faust_node == nullptr) return MA_INVALID_ARGS;
 
+    faust_node->config.sample_rate = sample_rate;
     if (faust_node->config.faust_dsp != nullptr) faust_node->config.faust_dsp->init(sample_rate);
     return MA_SUCCESS;
 }
 
-ma_result ma_faust_node_set_dsp(ma_faust_node *faust_node, dsp *faust_dsp) {
-    if (faust_node == nullptr) return MA_INVALID_ARGS;
-    // Reinitialize the node if the channel count has changed.
+// Counts the zones a DSP's UI exposes.
+struct ma_faust_zone_counter : UI {
+    ma_uint32 count{0};
+
+    void openTabBox(const char *) override {}
+    void openHorizontalBox(const char *) override {}
+    void openVerticalBox(const char *) override {}
+    void closeBox() override {}
+    void addButton(const char *, FAUSTFLOAT *) override { ++count; }
+    void addCheckButton(const char *, FAUSTFLOAT *) override { ++count; }
+    void addVerticalSlider(const char *, FAUSTFLOAT *, FAUSTFLOAT, FAUSTFLOAT, FAUSTFLOAT, FAUSTFLOAT) override { ++count; }
+    void addHorizontalSlider(const char *, FAUSTFLOAT *, FAUSTFLOAT, FAUSTFLOAT, FAUSTFLOAT, FAUSTFLOAT) override { ++count; }
+    void addNumEntry(const char *, FAUSTFLOAT *, FAUSTFLOAT, FAUSTFLOAT, FAUSTFLOAT, FAUSTFLOAT) override { ++count; }
+    void addHorizontalBargraph(const char *, FAUSTFLOAT *, FAUSTFLOAT, FAUSTFLOAT) override { ++count; }
+    void addVerticalBargraph(const char *, FAUSTFLOAT *, FAUSTFLOAT, FAUSTFLOAT) override { ++count; }
+    void addSoundfile(const char *, const char *, Soundfile **) override {}
+};
+
+static ma_faust_dsp_params *ma_faust_dsp_params_create(dsp *faust_dsp) {
+    if (faust_dsp == nullptr) return nullptr;
+
+    ma_faust_zone_counter zone_counter;
+    faust_dsp->buildUserInterface(&zone_counter);
+
+    auto *params = new ma_faust_dsp_params{};
+    params->faust_dsp = faust_dsp;
+    params->slot_capacity = zone_counter.count;
+    params->slots = new ma_faust_param_slot[zone_counter.count]{};
+    params->events = new ma_faust_param_event[zone_counter.count];
+    return params;
+}
+
+void ma_faust_dsp_params_free(ma_faust_dsp_params *params) {
+    if (params == nullptr) return;
+
+    delete[] params->slots;
+    delete[] params->events;
+    delete params;
+}
+
+ma_result ma_faust_node_set_dsp(ma_faust_node *faust_node, dsp *faust_dsp, ma_faust_dsp_params **prev_params) {
+    if (faust_node == nullptr || faust_dsp == nullptr || prev_params == nullptr) return MA_INVALID_ARGS;
+    // Changing channel counts requires a new node (see `FaustNode`).
     if (ma_faust_node_get_in_channels(faust_node) != ma_uint32(faust_dsp->getNumInputs()) ||
         ma_faust_node_get_out_channels(faust_node) != ma_uint32(faust_dsp->getNumOutputs())) return MA_INVALID_ARGS;
 
+    faust_dsp->init(faust_node->config.sample_rate);
     faust_node->config.faust_dsp = faust_dsp;
+    *prev_params = faust_node->active_params.exchange(ma_faust_dsp_params_create(faust_dsp), std::memory_order_acq_rel);
+    return MA_SUCCESS;
+}
+
+ma_result ma_faust_node_push_param(ma_faust_node *faust_node, float *zone, float value, ma_uint32 frame_offset) {
+    if (faust_node == nullptr || zone == nullptr) return MA_INVALID_ARGS;
+
+    // Params are only swapped by the producer, so they can't be freed while we use them.
+    auto *params = faust_node->active_params.load(std::memory_order_relaxed);
+    if (params == nullptr) return MA_INVALID_OPERATION;
+
+    const ma_uint32 slot_count = params->slot_count.load(std::memory_order_relaxed);
+    ma_uint32 i = 0;
+    while (i < slot_count && params->slots[i].zone != zone) ++i;
+    if (i == params->slot_capacity) return MA_OUT_OF_MEMORY;
+
+    auto &slot = params->slots[i];
+    slot.zone = zone;
+    slot.value.store(value, std::memory_order_relaxed);
+    slot.frame_offset.store(frame_offset, std::memory_order_relaxed);
+    slot.pending.store(MA_TRUE, std::memory_order_release);
+    if (i == slot_count) params->slot_count.store(slot_count + 1, std::memory_order_release);
+    params->has_pending.store(MA_TRUE, std::memory_order_release);
     return MA_SUCCESS;
 }
 
+// Take the pending param changes into `params->events`, in frame offset order. Returns the number of changes.
+static ma_uint32 ma_faust_dsp_params_take_pending(ma_faust_dsp_params *params) {
+    if (!params->has_pending.exchange(MA_FALSE, std::memory_order_acquire)) return 0;
+
+    ma_uint32 event_count = 0;
+    const ma_uint32 slot_count = params->slot_count.load(std::memory_order_acquire);
+    for (ma_uint32 i = 0; i < slot_count; ++i) {
+        auto &slot = params->slots[i];
+        if (!slot.pending.exchange(MA_FALSE, std::memory_order_acquire)) continue;
+        params->events[event_count++] = {slot.zone, slot.value.load(std::memory_order_relaxed), slot.frame_offset.load(std::memory_order_relaxed)};
+    }
+    std::sort(params->events, params->events + event_count, [](const auto &a, const auto &b) { return a.frame_offset < b.frame_offset; });
+    return event_count;
+}
+
+// Compute `frame_count` deinterleaved frames, applying pending param changes at their frame offsets.
+static void ma_faust_node_compute(ma_faust_dsp_params *params, float **in, float **out, ma_uint32 frame_count) {
+    dsp *dsp = params->faust_dsp;
+    const ma_uint32 in_channels = dsp->getNumInputs(), out_channels = dsp->getNumOutputs();
+    float *in_segment[MA_MAX_CHANNELS], *out_segment[MA_MAX_CHANNELS];
+    const ma_uint32 event_count = ma_faust_dsp_params_take_pending(params);
+    const ma_faust_param_event *events = params->events;
+    ma_uint32 frame = 0, event_index = 0;
+    while (frame < frame_count) {
+        for (; event_index < event_count && events[event_index].frame_offset <= frame; ++event_index) *events[event_index].zone = events[event_index].value;
+        const ma_uint32 segment_end = event_index < event_count ? std::min(events[event_index].frame_offset, frame_count) : frame_count;
+
+        for (ma_uint32 channel = 0; channel < in_channels; ++channel) in_segment[channel] = in[channel] + frame;
+        for (ma_uint32 channel = 0; channel < out_channels; ++channel) out_segment[channel] = out[channel] + frame;
+        dsp->compute(segment_end - frame, in_segment, out_segment);
+        frame = segment_end;
+    }
+    // Apply the remaining changes, due after this block.
+    for (; event_index < event_count; ++event_index) *events[event_index].zone = events[event_index].value;
+}
+
 static void ma_faust_node_process_pcm_frames(ma_node *node, const float **const_frames_in, ma_uint32 *frame_count_in, float **frames_out, ma_uint32 *frame_count_out) {
     auto *faust_node = (ma_faust_node *)node;
-    if (!faust_node->config.faust_dsp) return;
 
-    auto *dsp = faust_node->config.faust_dsp;
+    // Params swapped out while we compute with them are retired by the swapping thread, and only freed once this read is done.
+    auto *params = faust_node->active_params.load(std::memory_order_acquire);
+    if (!params) return;
+
+    dsp *dsp = params->faust_dsp;
     float **frames_in = const_cast<float **>(const_frames_in); // Faust `compute` expects a non-const buffer: https://github.com/grame-cncm/faust/pull/850
-    ma_uint32 in_channels = ma_faust_node_get_in_channels(faust_node);
-    ma_uint32 out_channels = ma_faust_node_get_out_channels(faust_node);
+    ma_uint32 in_channels = ma_faust_dsp_get_in_channels(dsp);
+    ma_uint32 out_channels = ma_faust_dsp_get_out_channels(dsp);
 
-    if (in_channels <= 1 && out_channels <= 1) {
-        // No multichannel.
-        dsp->compute(*frame_count_out, frames_in, frames_out);
-    } else if (in_channels <= 1) {
-        // Multi output.
-        dsp->compute(*frame_count_out, frames_in, faust_node->out_buffer);
-        ma_interleave_pcm_frames(ma_format_f32, out_channels, *frame_count_out, (const void **)faust_node->out_buffer, frames_out[0]);
-    } else if (out_channels <= 1) {
-        // Multi input.
-        ma_deinterleave_pcm_frames(ma_format_f32, in_channels, *frame_count_in, const_frames_in[0], (void **)faust_node->in_buffer);
-        dsp->compute(*frame_count_out, faust_node->in_buffer, frames_out);
-    } else {
-        // Multi input/output.
-        ma_deinterleave_pcm_frames(ma_format_f32, in_channels, *frame_count_in, const_frames_in[0], (void **)faust_node->in_buffer);
-        dsp->compute(*frame_count_out, faust_node->in_buffer, faust_node->out_buffer);
-        ma_interleave_pcm_frames(ma_format_f32, out_channels, *frame_count_out, (const void **)faust_node->out_buffer, frames_out[0]);
-    }
+    // Single-channel buffers are already deinterleaved.
+    if (in_channels > 1) ma_simd_deinterleave_f32(faust_node->in_buffer, const_frames_in[0], in_channels, *frame_count_in);
+    ma_faust_node_compute(params, in_channels > 1 ? faust_node->in_buffer : frames_in, out_channels > 1 ? faust_node->out_buffer : frames_out, *frame_count_out);
+    if (out_channels > 1) ma_simd_interleave_f32(frames_out[0], faust_node->out_buffer, out_channels, *frame_count_out);
 
     (void)frame_count_in;
 }
 
+static void ma_faust_node_free_buffers(float **buffers, ma_uint32 channels, const ma_allocation_callbacks *allocation_callbacks) {
+    if (buffers == nullptr) return;
+
+    for (ma_uint32 channel = 0; channel < channels; ++channel) ma_free(buffers[channel], allocation_callbacks);
+    ma_free(buffers, allocation_callbacks);
+}
+
+// Returns `nullptr` if any allocation fails.
+static float **ma_faust_node_allocate_buffers(ma_uint32 channels, ma_uint32 frames, const ma_allocation_callbacks *allocation_callbacks) {
+    auto **buffers = (float **)ma_calloc(channels * sizeof(float *), allocation_callbacks);
+    if (buffers == nullptr) return nullptr;
+
+    for (ma_uint32 channel = 0; channel < channels; ++channel) {
+        buffers[channel] = (float *)ma_malloc(frames * ma_get_bytes_per_frame(ma_format_f32, 1), allocation_callbacks);
+        if (buffers[channel] == nullptr) {
+            ma_faust_node_free_buffers(buffers, channels, allocation_callbacks);
+            return nullptr;
+        }
+        ma_silence_pcm_frames(buffers[channel], frames, ma_format_f32, 1);
+    }
+    return buffers;
+}
+
 ma_result ma_faust_node_init(ma_node_graph *node_graph, const ma_faust_node_config *config, const ma_allocation_callbacks *allocation_callbacks, ma_faust_node *faust_node) {
     if (faust_node == nullptr || config == nullptr) return MA_INVALID_ARGS;
 
@@ -89,24 +207,13 @@ ma_result ma_faust_node_init(ma_node_graph *node_graph, const ma_faust_node_conf
 
     ma_uint32 in_channels = ma_faust_node_get_in_channels(faust_node);
     ma_uint32 out_channels = ma_faust_node_get_out_channels(faust_node);
-    if (in_channels > 1 || out_channels > 1) {
-        const ma_uint32 N = faust_node->config.buffer_frames;
-        if (in_channels > 1) {
-            faust_node->in_buffer = (float **)ma_malloc(N * sizeof(float *), allocation_callbacks);
-            for (ma_uint32 channel = 0; channel < in_channels; ++channel) {
-                faust_node->in_buffer[channel] = (float *)ma_malloc(N * ma_get_bytes_per_frame(ma_format_f32, 1), allocation_callbacks);
-                if (faust_node->in_buffer[channel] == nullptr) return MA_OUT_OF_MEMORY;
-                ma_silence_pcm_frames(faust_node->in_buffer[channel], N, ma_format_f32, 1);
-            }
-        }
-        if (out_channels > 1) {
-            faust_node->out_buffer = (float **)ma_malloc(N * sizeof(float *), allocation_callbacks);
-            for (ma_uint32 channel = 0; channel < out_channels; ++channel) {
-                faust_node->out_buffer[channel] = (float *)ma_malloc(N * ma_get_bytes_per_frame(ma_format_f32, 1), allocation_callbacks);
-                if (faust_node->out_buffer[channel] == nullptr) return MA_OUT_OF_MEMORY;
-                ma_silence_pcm_frames(faust_node->out_buffer[channel], N, ma_format_f32, 1);
-            }
-        }
+    const ma_uint32 N = faust_node->config.buffer_frames;
+    if (in_channels > 1) faust_node->in_buffer = ma_faust_node_allocate_buffers(in_channels, N, allocation_callbacks);
+    if (out_channels > 1) faust_node->out_buffer = ma_faust_node_allocate_buffers(out_channels, N, allocation_callbacks);
+    if ((in_channels > 1 && faust_node->in_buffer == nullptr) || (out_channels > 1 && faust_node->out_buffer == nullptr)) {
+        ma_faust_node_free_buffers(faust_node->in_buffer, in_channels, allocation_callbacks);
+        ma_faust_node_free_buffers(faust_node->out_buffer, out_channels, allocation_callbacks);
+        return MA_OUT_OF_MEMORY;
     }
 
     ma_node_config base_config = config->node_config;
@@ -117,21 +224,23 @@ ma_result ma_faust_node_init(ma_node_graph *node_graph, const ma_faust_node_conf
     base_config.pOutputChannels = out_channels > 0 ? &out_channels : nullptr;
 
     if (dsp) dsp->init(faust_node->config.sample_rate);
-    return ma_node_init(node_graph, &base_config, allocation_callbacks, &faust_node->base);
+    faust_node->active_params.store(ma_faust_dsp_params_create(dsp));
+    if (ma_result result = ma_node_init(node_graph, &base_config, allocation_callbacks, &faust_node->base); result != MA_SUCCESS) {
+        ma_faust_dsp_params_free(faust_node->active_params.exchange(nullptr));
+        ma_faust_node_free_buffers(faust_node->in_buffer, in_channels, allocation_callbacks);
+        ma_faust_node_free_buffers(faust_node->out_buffer, out_channels, allocation_callbacks);
+        return result;
+    }
+    return MA_SUCCESS;
 }
 
 void ma_faust_node_uninit(ma_faust_node *faust_node, const ma_allocation_callbacks *allocation_callbacks) {
-    if (ma_uint32 in_channels = ma_faust_node_get_in_channels(faust_node); in_channels > 1) {
-        for (ma_uint32 channel = 0; channel < ma_faust_node_get_in_channels(faust_node); ++channel) {
-            ma_free(faust_node->in_buffer[channel], allocation_callbacks);
-        }
-        ma_free(faust_node->in_buffer, allocation_callbacks);
-    }
-    if (ma_uint32 out_channels = ma_faust_node_get_out_channels(faust_node); out_channels > 1) {
-        for (ma_uint32 channel = 0; channel < ma_faust_node_get_out_channels(faust_node); ++channel) {
-            ma_free(faust_node->out_buffer[channel], allocation_callbacks);
-        }
-        ma_free(faust_node->out_buffer, allocation_callbacks);
-    }
+    // Detach the node before freeing its buffers, so the audio thread is done with them.
+    // Buffer channel counts come from the node rather than the DSP, which may already be destroyed (e.g. when retired along with a replaced node).
+    const ma_uint32 in_channels = ma_node_get_input_bus_count(faust_node) > 0 ? ma_node_get_input_channels(faust_node, 0) : 0;
+    const ma_uint32 out_channels = ma_node_get_output_bus_count(faust_node) > 0 ? ma_node_get_output_channels(faust_node, 0) : 0;
     ma_node_uninit(&faust_node->base, allocation_callbacks);
+    ma_faust_node_free_buffers(faust_node->in_buffer, in_channels, allocation_callbacks);
+    ma_faust_node_free_buffers(faust_node->out_buffer, out_channels, allocation_callbacks);
+    ma_faust_dsp_params_free(faust_node->active_params.exchange(nullptr));
 }
@@ -2,6 +2,8 @@
 
 #include "miniaudio.h"
 
+#include <atomic>
+
 class dsp;
 
 struct ma_faust_node_config {
@@ -13,9 +15,39 @@ struct ma_faust_node_config {
 
 ma_faust_node_config ma_faust_node_config_init(dsp *, ma_uint32 sample_rate, ma_uint32 buffer_frames);
 
+// A parameter change, applied to `zone` by the audio thread `frame_offset` frames into the next processed block.
+struct ma_faust_param_event {
+    float *zone;
+    float value;
+    ma_uint32 frame_offset;
+};
+
+// The latest pending change of a zone. Changes pushed before the audio thread applies them are coalesced, so only the latest value is applied.
+struct ma_faust_param_slot {
+    float *zone; // Set before the slot is published (by incrementing `slot_count`), and never changed after.
+    std::atomic<float> value;
+    std::atomic<ma_uint32> frame_offset;
+    std::atomic<ma_bool32> pending;
+};
+
+// A DSP, along with its pending param changes. Swapped in as a unit, so changes are never applied to another DSP's zones.
+// Slots are claimed by a single producer (the UI thread), and applied by the audio thread.
+// There is one slot per zone in the DSP's UI, so every zone can have a pending change.
+struct ma_faust_dsp_params {
+    dsp *faust_dsp;
+    ma_uint32 slot_capacity;
+    std::atomic<ma_uint32> slot_count;
+    std::atomic<ma_bool32> has_pending; // Set after any slot becomes pending, so blocks without changes skip scanning the slots.
+    ma_faust_param_slot *slots;
+    ma_faust_param_event *events; // Scratch space for the audio thread to sort pending changes, with room for every slot.
+};
+
 struct ma_faust_node {
     ma_node_base base;
     ma_faust_node_config config;
+    // The DSP (and its pending param changes) used by the audio thread, which can be swapped with `ma_faust_node_set_dsp` while the node is processing.
+    // Each processed block loads it once, so a block in progress may still be computing with swapped-out params.
+    std::atomic<ma_faust_dsp_params *> active_params;
     // These deinterleaved buffers are only created if the respective direction of the Faust node is multi-channel.
     float **in_buffer;
     float **out_buffer;
@@ -33,4 +65,15 @@ ma_uint32 ma_faust_node_get_sample_rate(ma_faust_node *);
 dsp *ma_faust_node_get_dsp(ma_faust_node *);
 
 ma_result ma_faust_node_set_sample_rate(ma_faust_node *, ma_uint32 sample_rate);
-ma_result ma_faust_node_set_dsp(ma_faust_node *, dsp *);
+// The new DSP must have the same channel counts as the current one. It is initialized with the node's sample rate before swapping it in.
+// Doesn't wait for the audio thread: a block in progress may still be computing with the previous DSP, so the previous params are returned in `prev_params`,
+// to be freed with `ma_faust_dsp_params_free` (and the previous DSP destroyed) once the audio thread is done with them (see `AudioGraphReclaimer`).
+ma_result ma_faust_node_set_dsp(ma_faust_node *, dsp *, ma_faust_dsp_params **prev_params);
+void ma_faust_dsp_params_free(ma_faust_dsp_params *);
+
+// Change `zone` in the node's current DSP to `value`, `frame_offset` frames into the next processed block.
+// Zones are only written by the audio thread. Changes to a zone pushed before its next processed block replace each other, so the queue never fills up,
+// even if the node isn't being processed. Changes are applied in frame offset order, splitting the block's `compute` call at each offset.
+// Changes with an offset beyond the end of the block are applied after it.
+// Returns `MA_INVALID_OPERATION` if the node has no DSP, or `MA_OUT_OF_MEMORY` if more zones have been changed than the DSP's UI has (i.e. `zone` isn't one of them).
+ma_result ma_faust_node_push_param(ma_faust_node *, float *zone, float value, ma_uint32 frame_offset = 0);
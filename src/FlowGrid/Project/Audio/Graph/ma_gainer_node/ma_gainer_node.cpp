@@ -1,6 +1,7 @@
 #include "ma_gainer_node.h"
 
 #include "../ma_helper.h"
+#include "../ma_simd/ma_simd.h"
 
 ma_gainer_node_config ma_gainer_node_config_init(ma_uint32 channels, float gain, ma_uint32 smooth_time_frames) {
     ma_gainer_node_config config;
@@ -19,7 +20,14 @@ ma_result ma_gainer_node_set_gain(ma_gainer_node *gainer_node, float gain) {
 
 static void ma_gainer_node_process_pcm_frames(ma_node *node, const float **frames_in, ma_uint32 *frame_count_in, float **frames_out, ma_uint32 *frame_count_out) {
     ma_gainer_node *gainer_node = (ma_gainer_node *)node;
-    ma_gainer_process_pcm_frames(&gainer_node->gainer, frames_out[0], frames_in[0], *frame_count_out);
+    ma_gainer *gainer = &gainer_node->gainer;
+    // Only smooth with `ma_gainer` while a gain change is in progress. Otherwise, all channels have the same constant gain,
+    // scaled by the master volume as in `ma_gainer_process_pcm_frames`.
+    if (gainer->t < gainer->config.smoothTimeInFrames) {
+        ma_gainer_process_pcm_frames(gainer, frames_out[0], frames_in[0], *frame_count_out);
+    } else {
+        ma_simd_apply_gain_f32(frames_out[0], frames_in[0], gainer->pNewGains[0] * gainer->masterVolume, ma_uint64(*frame_count_out) * gainer->config.channels);
+    }
 
     (void)frame_count_in;
 }
@@ -1,8 +1,51 @@
 #include "ma_monitor_node.h"
 
 #include "../ma_helper.h"
-
-#include "fft_data.h"
+#include "../ma_simd/ma_simd.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <thread>
+
+#include <fftw3.h>
+
+static_assert(sizeof(fftwf_complex) == sizeof(float[2]));
+
+using window_func_t = void (*)(float *, unsigned);
+
+// All analysis state is owned by the worker thread, except for:
+// * `frames_rb`: Written by the audio thread, read by the worker.
+// * `pushed_cursor`: Owned by the audio thread.
+// * `frames`/`published`: Triple buffer, written by the worker, read by the consumer (UI) thread.
+// * The atomics, used to signal between threads.
+struct ma_monitor_analysis {
+    ma_uint32 channels, N;
+    ma_pcm_rb frames_rb; // Interleaved frames pushed by the audio thread.
+    ma_uint32 pushed_cursor{0}; // Frames pushed since the last full window, matching `working_buffer_cursor` once the worker drains them.
+
+    float *working_buffer; // Interleaved frames read from the ring, `working_buffer_cursor` frames filled.
+    ma_uint32 working_buffer_cursor{0};
+    float *window; // The window function frames.
+    float *windowed_buffer; // One channel of a full working buffer, after applying the window function.
+    float *power; // Scratch for one channel's normalized bin powers, before converting to dB.
+    fftwf_plan plan;
+
+    // Triple buffer of completed analysis frames.
+    // The worker owns `frames[back_index]`, the consumer owns `frames[front_index]`,
+    // and `published` holds the index of the remaining frame, with `FreshBit` set if it hasn't been consumed yet.
+    static constexpr ma_uint8 FreshBit = 0x4;
+    ma_monitor_frame frames[3]{};
+    ma_uint8 back_index{0}, front_index{1};
+    std::atomic<ma_uint8> published{2};
+
+    std::atomic<window_func_t> pending_window_func{nullptr};
+    std::atomic<ma_uint64> dropped_frames{0};
+    std::atomic<bool> running{true};
+    std::atomic<ma_uint32> windows_pushed{0}; // Incremented (and waited on by the worker) each time the ring fills another window.
+    std::thread worker;
+};
 
 ma_monitor_node_config ma_monitor_node_config_init(ma_uint32 channels, ma_uint32 buffer_frames) {
     ma_monitor_node_config config;
@@ -14,107 +57,241 @@ ma_monitor_node_config ma_monitor_node_config_init(ma_uint32 channels, ma_uint32
 }
 
 ma_result ma_monitor_apply_window_function(ma_monitor_node *monitor, void (*window_func)(float *, unsigned)) {
-    if (monitor == nullptr) return MA_INVALID_ARGS;
-
-    window_func(monitor->window, monitor->config.buffer_frames);
+    if (monitor == nullptr || monitor->analysis == nullptr || window_func == nullptr) return MA_INVALID_ARGS;
 
+    monitor->analysis->pending_window_func.store(window_func, std::memory_order_release);
     return MA_SUCCESS;
 }
 
-static void ma_monitor_node_process_pcm_frames(ma_node *node, const float **frames_in, ma_uint32 *frame_count_in, float **frames_out, ma_uint32 *frame_count_out) {
-    auto *monitor = (ma_monitor_node *)node;
-
-    const ma_uint32 N = monitor->config.buffer_frames;
-    float *working_buffer = monitor->working_buffer_index == 0 ? monitor->working_buffer_0 : monitor->working_buffer_1;
-    float *buffer_write_pos = working_buffer + monitor->working_buffer_cursor;
-    ma_uint32 remaining_write_frames = N - monitor->working_buffer_cursor;
-    if (*frame_count_out >= remaining_write_frames) {
-        ma_copy_pcm_frames(buffer_write_pos, frames_out[0], remaining_write_frames, ma_format_f32, 1);
-        monitor->buffer = working_buffer;
-        monitor->working_buffer_cursor = 0;
-        monitor->working_buffer_index = monitor->working_buffer_index == 0 ? 1 : 0;
-
-        // todo atomic windowing
-        for (ma_uint32 i = 0; i < N; i++) {
-            monitor->windowed_buffer[i] = monitor->buffer[i] * monitor->window[i];
-        }
+static void ma_monitor_analysis_publish(ma_monitor_analysis *analysis) {
+    const ma_uint8 previous = analysis->published.exchange(analysis->back_index | ma_monitor_analysis::FreshBit, std::memory_order_acq_rel);
+    analysis->back_index = previous & ~ma_monitor_analysis::FreshBit;
+}
 
-        fftwf_execute(monitor->fft->plan);
+const ma_monitor_frame *ma_monitor_node_get_frame(ma_monitor_node *monitor) {
+    if (monitor == nullptr || monitor->analysis == nullptr) return nullptr;
 
-    } else {
-        ma_copy_pcm_frames(buffer_write_pos, frames_out[0], *frame_count_out, ma_format_f32, 1);
-        monitor->working_buffer_cursor += *frame_count_out;
+    auto *analysis = monitor->analysis;
+    if (analysis->published.load(std::memory_order_relaxed) & ma_monitor_analysis::FreshBit) {
+        const ma_uint8 previous = analysis->published.exchange(analysis->front_index, std::memory_order_acq_rel);
+        analysis->front_index = previous & ~ma_monitor_analysis::FreshBit;
     }
+    return &analysis->frames[analysis->front_index];
+}
 
-    (void)frame_count_in;
-    (void)frames_in;
+ma_uint64 ma_monitor_node_get_dropped_frames(ma_monitor_node *monitor) {
+    if (monitor == nullptr || monitor->analysis == nullptr) return 0;
+    return monitor->analysis->dropped_frames.load(std::memory_order_relaxed);
 }
 
-ma_result create_fft(ma_monitor_node *monitor, const ma_allocation_callbacks *allocation_callbacks) {
-    auto *fft = (fft_data *)ma_malloc(sizeof(fft_data), allocation_callbacks);
-    if (fft == nullptr) return MA_OUT_OF_MEMORY;
+static constexpr float MinMagnitude = 1e-10f; // -200 dB, to avoid taking the log of zero.
+
+// `10 * log10(x)` for positive, finite, normal `x`, within 1e-4 dB.
+// Unlike `std::log10`, it's branch-free arithmetic with no library calls, so loops calling it can be auto-vectorized.
+// Splits `x = m * 2^e` with `m` in [1, 2), and evaluates `ln(m) = 2 * atanh((m - 1) / (m + 1))` with a short odd series.
+static inline float ma_monitor_power_to_db(float x) {
+    static constexpr float DbPerOctave = 3.0102999566f; // 10 * log10(2)
+    static constexpr float DbPerNeper = 8.6858896381f; // 20 / ln(10), since `ln(m) = 2 * atanh(t)`
+    const auto bits = std::bit_cast<ma_uint32>(x);
+    const float exponent = float(ma_int32(bits >> 23) - 127);
+    const float m = std::bit_cast<float>((bits & 0x007FFFFFu) | 0x3F800000u);
+    const float t = (m - 1.f) / (m + 1.f), t2 = t * t;
+    return DbPerOctave * exponent + DbPerNeper * t * (1.f + t2 * (1.f / 3.f + t2 * (1.f / 5.f + t2 * (1.f / 7.f))));
+}
 
-    ma_uint32 N = monitor->config.buffer_frames;
-    fft->data = fftwf_alloc_complex(N / 2 + 1);
-    if (fft->data == nullptr) {
-        ma_free(fft, allocation_callbacks);
-        return MA_OUT_OF_MEMORY;
+// Convert a channel's spectrum to normalized dB magnitudes.
+// Works in power (squared magnitude), so no square roots are needed.
+// Split into two flat passes over contiguous arrays, each of which is auto-vectorized at -O3.
+static void ma_monitor_analysis_to_db(ma_monitor_analysis *analysis, const float (*spectrum)[2], float *magnitude_db) {
+    const ma_uint32 bins = analysis->N / 2 + 1;
+    const float scale = 2.f / float(analysis->N), power_scale = scale * scale;
+    float *power = analysis->power;
+    for (ma_uint32 i = 0; i < bins; ++i) {
+        power[i] = std::max((spectrum[i][0] * spectrum[i][0] + spectrum[i][1] * spectrum[i][1]) * power_scale, MinMagnitude * MinMagnitude);
     }
+    for (ma_uint32 i = 0; i < bins; ++i) magnitude_db[i] = ma_monitor_power_to_db(power[i]);
+}
 
-    fft->plan = fftwf_plan_dft_r2c_1d(N, monitor->windowed_buffer, fft->data, FFTW_MEASURE);
+// Window, FFT, and convert each channel of the (full) working buffer into the back frame, and publish it.
+static void ma_monitor_analysis_analyze(ma_monitor_analysis *analysis) {
+    if (auto window_func = analysis->pending_window_func.exchange(nullptr, std::memory_order_acquire)) {
+        window_func(analysis->window, analysis->N);
+    }
 
-    monitor->fft = fft;
+    const ma_uint32 N = analysis->N, channels = analysis->channels;
+    auto &frame = analysis->frames[analysis->back_index];
+    ma_simd_deinterleave_f32(frame.buffers, analysis->working_buffer, channels, N);
+    for (ma_uint32 channel = 0; channel < channels; ++channel) {
+        ma_simd_multiply_f32(analysis->windowed_buffer, frame.buffers[channel], analysis->window, N);
+        fftwf_execute_dft_r2c(analysis->plan, analysis->windowed_buffer, reinterpret_cast<fftwf_complex *>(frame.spectra[channel]));
+        ma_monitor_analysis_to_db(analysis, frame.spectra[channel], frame.magnitudes_db[channel]);
+    }
+    ma_monitor_analysis_publish(analysis);
+}
 
-    return MA_SUCCESS;
+// Move as many frames as are available from the ring into the working buffer, analyzing each time it fills up.
+static void ma_monitor_analysis_drain(ma_monitor_analysis *analysis) {
+    const ma_uint32 bytes_per_frame = ma_get_bytes_per_frame(ma_format_f32, analysis->channels);
+    while (ma_pcm_rb_available_read(&analysis->frames_rb) > 0) {
+        ma_uint32 frame_count = analysis->N - analysis->working_buffer_cursor;
+        void *read_buffer;
+        if (ma_pcm_rb_acquire_read(&analysis->frames_rb, &frame_count, &read_buffer) != MA_SUCCESS || frame_count == 0) break;
+
+        memcpy(analysis->working_buffer + analysis->working_buffer_cursor * analysis->channels, read_buffer, frame_count * bytes_per_frame);
+        ma_pcm_rb_commit_read(&analysis->frames_rb, frame_count);
+        analysis->working_buffer_cursor += frame_count;
+        if (analysis->working_buffer_cursor == analysis->N) {
+            analysis->working_buffer_cursor = 0;
+            ma_monitor_analysis_analyze(analysis);
+        }
+    }
 }
 
-void destroy_fft(fft_data *fft, const ma_allocation_callbacks *allocation_callbacks) {
-    if (fft == nullptr) return;
+// The worker sleeps until the audio thread has pushed another full window, so it only wakes when there's an analysis to run.
+// The ring holds two windows, so it only overflows if an analysis takes longer than a full window.
+static void ma_monitor_analysis_run(ma_monitor_analysis *analysis) {
+    ma_uint32 windows_pushed = analysis->windows_pushed.load(std::memory_order_acquire);
+    while (analysis->running.load(std::memory_order_acquire)) {
+        ma_monitor_analysis_drain(analysis);
+        analysis->windows_pushed.wait(windows_pushed, std::memory_order_acquire);
+        windows_pushed = analysis->windows_pushed.load(std::memory_order_acquire);
+    }
+}
 
-    fftwf_destroy_plan(fft->plan);
-    fftwf_free(fft->data);
-    ma_free(fft, allocation_callbacks);
+// Wake the worker, if it's waiting.
+static void ma_monitor_analysis_signal(ma_monitor_analysis *analysis) {
+    analysis->windows_pushed.fetch_add(1, std::memory_order_release);
+    analysis->windows_pushed.notify_one();
 }
 
-ma_result ma_monitor_node_init(ma_node_graph *node_graph, const ma_monitor_node_config *config, const ma_allocation_callbacks *allocation_callbacks, ma_monitor_node *monitor) {
-    if (monitor == nullptr || config == nullptr) return MA_INVALID_ARGS;
+// Runs on the audio thread. Never blocks or allocates: frames that don't fit in the ring are dropped.
+// Only signals the worker once per completed window, and never runs analysis itself.
+static void ma_monitor_node_process_pcm_frames(ma_node *node, const float **frames_in, ma_uint32 *frame_count_in, float **frames_out, ma_uint32 *frame_count_out) {
+    auto *monitor = (ma_monitor_node *)node;
+    auto *analysis = monitor->analysis;
+
+    const float *frames = frames_out[0];
+    const ma_uint32 channels = analysis->channels;
+    ma_uint32 remaining_frames = *frame_count_out;
+    // At most two iterations, since the write region can wrap around the end of the ring.
+    for (ma_uint32 i = 0; i < 2 && remaining_frames > 0; ++i) {
+        ma_uint32 frame_count = remaining_frames;
+        void *write_buffer;
+        if (ma_pcm_rb_acquire_write(&analysis->frames_rb, &frame_count, &write_buffer) != MA_SUCCESS || frame_count == 0) break;
+
+        ma_copy_pcm_frames(write_buffer, frames, frame_count, ma_format_f32, channels);
+        ma_pcm_rb_commit_write(&analysis->frames_rb, frame_count);
+        frames += frame_count * channels;
+        remaining_frames -= frame_count;
+        analysis->pushed_cursor += frame_count;
+    }
+    if (remaining_frames > 0) analysis->dropped_frames.fetch_add(remaining_frames, std::memory_order_relaxed);
+    if (analysis->pushed_cursor >= analysis->N) {
+        analysis->pushed_cursor %= analysis->N;
+        ma_monitor_analysis_signal(analysis);
+    }
 
-    MA_ZERO_OBJECT(monitor);
-    monitor->config = *config;
-    ma_uint32 N = monitor->config.buffer_frames;
+    (void)frame_count_in;
+    (void)frames_in;
+}
 
-    monitor->working_buffer_0 = (float *)ma_malloc((size_t)(N * ma_get_bytes_per_frame(ma_format_f32, config->channels)), allocation_callbacks);
-    if (monitor->working_buffer_0 == nullptr) return MA_OUT_OF_MEMORY;
-    ma_silence_pcm_frames(monitor->working_buffer_0, N, ma_format_f32, config->channels);
+static void destroy_analysis(ma_monitor_analysis *analysis, const ma_allocation_callbacks *allocation_callbacks) {
+    if (analysis == nullptr) return;
 
-    monitor->working_buffer_1 = (float *)ma_malloc((size_t)(N * ma_get_bytes_per_frame(ma_format_f32, config->channels)), allocation_callbacks);
-    if (monitor->working_buffer_1 == nullptr) {
-        ma_free(monitor->working_buffer_0, allocation_callbacks);
-        return MA_OUT_OF_MEMORY;
+    if (analysis->worker.joinable()) {
+        analysis->running.store(false, std::memory_order_release);
+        ma_monitor_analysis_signal(analysis);
+        analysis->worker.join();
     }
-    ma_silence_pcm_frames(monitor->working_buffer_1, N, ma_format_f32, config->channels);
+    if (analysis->plan != nullptr) fftwf_destroy_plan(analysis->plan);
+    for (auto &frame : analysis->frames) {
+        for (ma_uint32 channel = 0; channel < analysis->channels; ++channel) {
+            if (frame.buffers != nullptr) ma_free(frame.buffers[channel], allocation_callbacks);
+            if (frame.spectra != nullptr) fftwf_free(frame.spectra[channel]);
+            if (frame.magnitudes_db != nullptr) ma_free(frame.magnitudes_db[channel], allocation_callbacks);
+        }
+        ma_free(frame.buffers, allocation_callbacks);
+        ma_free(frame.spectra, allocation_callbacks);
+        ma_free(frame.magnitudes_db, allocation_callbacks);
+    }
+    ma_free(analysis->power, allocation_callbacks);
+    fftwf_free(analysis->windowed_buffer);
+    ma_free(analysis->window, allocation_callbacks);
+    ma_free(analysis->working_buffer, allocation_callbacks);
+    ma_pcm_rb_uninit(&analysis->frames_rb);
+    delete analysis;
+}
 
-    monitor->buffer = monitor->working_buffer_1;
+static ma_result create_analysis(ma_monitor_node *monitor, const ma_allocation_callbacks *allocation_callbacks) {
+    const ma_uint32 N = monitor->config.buffer_frames, channels = monitor->config.channels;
+    auto *analysis = new ma_monitor_analysis{};
+    analysis->channels = channels;
+    analysis->N = N;
 
-    monitor->window = (float *)ma_malloc((size_t)(N * ma_get_bytes_per_frame(ma_format_f32, 1)), allocation_callbacks);
-    if (monitor->window == nullptr) {
-        ma_free(monitor->working_buffer_0, allocation_callbacks);
-        ma_free(monitor->working_buffer_1, allocation_callbacks);
+    // Leave room for the worker to fall a full window behind the audio thread before dropping frames.
+    if (ma_result result = ma_pcm_rb_init(ma_format_f32, channels, N * 2, nullptr, allocation_callbacks, &analysis->frames_rb); result != MA_SUCCESS) {
+        delete analysis;
+        return result;
+    }
+
+    analysis->working_buffer = (float *)ma_malloc((size_t)(N * ma_get_bytes_per_frame(ma_format_f32, channels)), allocation_callbacks);
+    analysis->window = (float *)ma_malloc((size_t)(N * ma_get_bytes_per_frame(ma_format_f32, 1)), allocation_callbacks);
+    const ma_uint32 bins = N / 2 + 1;
+    analysis->power = (float *)ma_malloc((size_t)(bins * sizeof(float)), allocation_callbacks);
+    // Allocate FFT input/output with FFTW to guarantee the alignment required to execute the plan on each channel's spectrum.
+    analysis->windowed_buffer = fftwf_alloc_real(N);
+    bool allocated = analysis->working_buffer != nullptr && analysis->window != nullptr && analysis->power != nullptr && analysis->windowed_buffer != nullptr;
+    for (auto &frame : analysis->frames) {
+        frame.buffers = (float **)ma_malloc(channels * sizeof(float *), allocation_callbacks);
+        frame.spectra = (float(**)[2])ma_malloc(channels * sizeof(float(*)[2]), allocation_callbacks);
+        frame.magnitudes_db = (float **)ma_malloc(channels * sizeof(float *), allocation_callbacks);
+        // Zero the channel arrays first, so a partial allocation can be freed.
+        if (frame.buffers != nullptr) memset(frame.buffers, 0, channels * sizeof(float *));
+        if (frame.spectra != nullptr) memset(frame.spectra, 0, channels * sizeof(float(*)[2]));
+        if (frame.magnitudes_db != nullptr) memset(frame.magnitudes_db, 0, channels * sizeof(float *));
+        if (frame.buffers == nullptr || frame.spectra == nullptr || frame.magnitudes_db == nullptr) {
+            allocated = false;
+            continue;
+        }
+        for (ma_uint32 channel = 0; channel < channels; ++channel) {
+            auto *&buffer = frame.buffers[channel];
+            auto *&spectrum = frame.spectra[channel];
+            auto *&magnitude_db = frame.magnitudes_db[channel];
+            buffer = (float *)ma_malloc((size_t)(N * sizeof(float)), allocation_callbacks);
+            spectrum = reinterpret_cast<float(*)[2]>(fftwf_alloc_complex(bins));
+            magnitude_db = (float *)ma_malloc((size_t)(bins * sizeof(float)), allocation_callbacks);
+            allocated &= buffer != nullptr && spectrum != nullptr && magnitude_db != nullptr;
+            if (buffer != nullptr) ma_silence_pcm_frames(buffer, N, ma_format_f32, 1);
+            if (spectrum != nullptr) memset(spectrum, 0, bins * sizeof(fftwf_complex));
+            if (magnitude_db != nullptr) {
+                for (ma_uint32 i = 0; i < bins; ++i) magnitude_db[i] = 20.f * std::log10(MinMagnitude);
+            }
+        }
+    }
+    if (!allocated) {
+        destroy_analysis(analysis, allocation_callbacks);
         return MA_OUT_OF_MEMORY;
     }
-    for (ma_uint32 i = 0; i < N; ++i) monitor->window[i] = 1.0; // Rectangular window by default.
 
-    monitor->windowed_buffer = (float *)ma_malloc((size_t)(N * ma_get_bytes_per_frame(ma_format_f32, config->channels)), allocation_callbacks);
-    if (monitor->windowed_buffer == nullptr) return MA_OUT_OF_MEMORY;
-    ma_silence_pcm_frames(monitor->windowed_buffer, N, ma_format_f32, config->channels);
+    ma_silence_pcm_frames(analysis->working_buffer, N, ma_format_f32, channels);
+    for (ma_uint32 i = 0; i < N; ++i) analysis->window[i] = 1.0; // Rectangular window by default.
+    analysis->plan = fftwf_plan_dft_r2c_1d(N, analysis->windowed_buffer, reinterpret_cast<fftwf_complex *>(analysis->frames[0].spectra[0]), FFTW_MEASURE);
+    // Planning with `FFTW_MEASURE` overwrites its arrays.
+    memset(analysis->frames[0].spectra[0], 0, bins * sizeof(fftwf_complex));
 
-    if (ma_result result = create_fft(monitor, allocation_callbacks); result != MA_SUCCESS) {
-        ma_free(monitor->working_buffer_0, allocation_callbacks);
-        ma_free(monitor->working_buffer_1, allocation_callbacks);
-        ma_free(monitor->window, allocation_callbacks);
-        ma_free(monitor->windowed_buffer, allocation_callbacks);
-        return result;
-    }
+    analysis->worker = std::thread(ma_monitor_analysis_run, analysis);
+    monitor->analysis = analysis;
+
+    return MA_SUCCESS;
+}
+
+ma_result ma_monitor_node_init(ma_node_graph *node_graph, const ma_monitor_node_config *config, const ma_allocation_callbacks *allocation_callbacks, ma_monitor_node *monitor) {
+    if (monitor == nullptr || config == nullptr) return MA_INVALID_ARGS;
+
+    MA_ZERO_OBJECT(monitor);
+    monitor->config = *config;
+
+    if (ma_result result = create_analysis(monitor, allocation_callbacks); result != MA_SUCCESS) return result;
 
     static ma_node_vtable vtable = {ma_monitor_node_process_pcm_frames, nullptr, 1, 1, MA_NODE_FLAG_PASSTHROUGH};
     ma_node_config base_config = config->node_config;
@@ -122,17 +299,20 @@ ma_result ma_monitor_node_init(ma_node_graph *node_graph, const ma_monitor_node_
     base_config.pInputChannels = &config->channels;
     base_config.pOutputChannels = &config->channels;
 
-    return ma_node_init(node_graph, &base_config, allocation_callbacks, &monitor->base);
+    if (ma_result result = ma_node_init(node_graph, &base_config, allocation_callbacks, &monitor->base); result != MA_SUCCESS) {
+        destroy_analysis(monitor->analysis, allocation_callbacks);
+        monitor->analysis = nullptr;
+        return result;
+    }
+
+    return MA_SUCCESS;
 }
 
 void ma_monitor_node_uninit(ma_monitor_node *monitor, const ma_allocation_callbacks *allocation_callbacks) {
     if (monitor == nullptr) return;
 
+    // Uninit the node first, so the audio thread is done pushing frames before the analysis is destroyed.
     ma_node_uninit(monitor, allocation_callbacks);
-    destroy_fft(monitor->fft, allocation_callbacks);
-    monitor->fft = nullptr;
-    ma_free(monitor->buffer, allocation_callbacks);
-    monitor->buffer = nullptr;
-    ma_free(monitor->windowed_buffer, allocation_callbacks);
-    monitor->windowed_buffer = nullptr;
+    destroy_analysis(monitor->analysis, allocation_callbacks);
+    monitor->analysis = nullptr;
 }
@@ -10,28 +10,36 @@ struct ma_monitor_node_config {
 
 ma_monitor_node_config ma_monitor_node_config_init(ma_uint32 channels, ma_uint32 buffer_frames);
 
-struct fft_data; // Forward-declare to avoid including fftw header. Include `fft_data.h` for complete definition.
+// A completed analysis of the most recent `config.buffer_frames` frames of each channel, published by the analysis worker.
+// All arrays are indexed by channel first.
+struct ma_monitor_frame {
+    float **buffers; // `buffer_frames` (deinterleaved) frames.
+    float (**spectra)[2]; // `buffer_frames / 2 + 1` complex FFT bins of the windowed buffer (layout-compatible with `fftwf_complex`).
+    float **magnitudes_db; // `buffer_frames / 2 + 1` bin magnitudes, in dB relative to a full-scale sine.
+};
+
+// Forward-declare to keep the analysis worker (thread, ring buffer, FFT plan) private to `ma_monitor_node.cpp`.
+struct ma_monitor_analysis;
 
+// The audio thread only pushes frames into a lock-free single-producer/single-consumer ring buffer,
+// waking a dedicated worker thread each time it completes a window.
+// The worker drains the ring, and for each channel applies the window function, runs the FFT,
+// and converts the spectrum to dB, publishing completed `ma_monitor_frame`s through a triple buffer.
 struct ma_monitor_node {
     ma_node_base base;
     ma_monitor_node_config config;
-    fft_data *fft;
-    // Buffers are guaranteed to be of size `config.buffer_frames * config.channels` if initialized successfully.
-    // `buffer` always points to a full buffer, using the following double-buffering scheme:
-    // * `buffer` initially points to (empty) `working_buffer_1` as `working_buffer_0` is filled up.
-    // * Once `working_buffer_0` is filled up, `buffer` points to `working_buffer_0` and `working_buffer_1` starts to fill.
-    // * Once `working_buffer_1` is filled up, `buffer` points to `working_buffer_1` and `working_buffer_0` starts to fill, etc.
-    // At any point, the current working buffer has `working_buffer_cursor` frames written to it.
-    ma_uint16 working_buffer_cursor{0};
-    ma_uint8 working_buffer_index{0}; // 0 or 1.
-    float *working_buffer_0;
-    float *working_buffer_1;
-    float *buffer; // Pointer to a full buffer (either `working_buffer_1` or `working_buffer_2`).
-    float *window; // The window function frames.
-    float *windowed_buffer; // The buffer after applying the window function.
+    ma_monitor_analysis *analysis;
 };
 
 ma_result ma_monitor_node_init(ma_node_graph *, const ma_monitor_node_config *, const ma_allocation_callbacks *, ma_monitor_node *);
 void ma_monitor_node_uninit(ma_monitor_node *, const ma_allocation_callbacks *);
 
+// The window function is applied by the analysis worker before its next analysis.
 ma_result ma_monitor_apply_window_function(ma_monitor_node *, void (*window_func)(float *, unsigned));
+
+// Returns the most recently published analysis frame (silent until the first full window has been analyzed).
+// Must only be called from a single consumer thread. The frame stays valid and unchanged until the next call.
+const ma_monitor_frame *ma_monitor_node_get_frame(ma_monitor_node *);
+
+// Number of frames dropped because the analysis worker fell behind the audio thread.
+ma_uint64 ma_monitor_node_get_dropped_frames(ma_monitor_node *);
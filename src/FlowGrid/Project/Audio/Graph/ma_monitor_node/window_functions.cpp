@@ -44,10 +44,19 @@ void cosine_window(real *w, unsigned n, const real *coeff, unsigned ncoeff, bool
         return;
     }
 
+    // Only one `__cospi` per sample: The higher harmonics follow from the Chebyshev recurrence
+    // cos(j * x) = 2 * cos(x) * cos((j - 1) * x) - cos((j - 2) * x).
     const unsigned wlength = sflag ? (n - 1) : n;
     for (unsigned i = 0; i < n; ++i) {
-        real wi = 0.0;
-        for (unsigned j = 0; j < ncoeff; ++j) wi += coeff[j] * __cospi(real(2 * i * j) / real(wlength));
+        const real cos_x = __cospi(real(2 * i) / real(wlength));
+        real cos_prev = 1.0, cos_jx = cos_x;
+        real wi = ncoeff > 0 ? coeff[0] : 0.0;
+        for (unsigned j = 1; j < ncoeff; ++j) {
+            wi += coeff[j] * cos_jx;
+            const real cos_next = 2 * cos_x * cos_jx - cos_prev;
+            cos_prev = cos_jx;
+            cos_jx = cos_next;
+        }
         w[i] = wi;
     }
 }
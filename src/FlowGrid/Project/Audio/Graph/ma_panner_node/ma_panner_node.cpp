@@ -1,6 +1,7 @@
 #include "ma_panner_node.h"
 
 #include "../ma_helper.h"
+#include "../ma_simd/ma_simd.h"
 
 ma_panner_node_config ma_panner_node_config_init(ma_uint32 in_channels, ma_pan_mode mode) {
     ma_panner_node_config config;
@@ -25,13 +26,23 @@ ma_result ma_panner_node_set_mode(ma_panner_node *panner_node, ma_pan_mode mode)
     return MA_SUCCESS;
 }
 
+// Same as `ma_panner_process_pcm_frames`, but balance mode (only attenuating the channel opposite the pan direction) is vectorized.
+static void ma_panner_node_pan(ma_panner *panner, float *frames_out, const float *frames_in, ma_uint32 frame_count) {
+    if (panner->mode == ma_pan_mode_balance) {
+        const float pan = panner->pan;
+        ma_simd_apply_stereo_gain_f32(frames_out, frames_in, pan > 0 ? 1 - pan : 1, pan < 0 ? 1 + pan : 1, frame_count);
+    } else {
+        ma_panner_process_pcm_frames(panner, frames_out, frames_in, frame_count);
+    }
+}
+
 static void ma_panner_node_process_pcm_frames(ma_node *node, const float **frames_in, ma_uint32 *frame_count_in, float **frames_out, ma_uint32 *frame_count_out) {
     auto *panner_node = (ma_panner_node *)node;
     if (panner_node->converter) {
         ma_channel_converter_process_pcm_frames(panner_node->converter.get(), frames_out[0], frames_in[0], *frame_count_out);
-        ma_panner_process_pcm_frames(&panner_node->panner, frames_out[0], frames_out[0], *frame_count_out);
+        ma_panner_node_pan(&panner_node->panner, frames_out[0], frames_out[0], *frame_count_out);
     } else {
-        ma_panner_process_pcm_frames(&panner_node->panner, frames_out[0], frames_in[0], *frame_count_out);
+        ma_panner_node_pan(&panner_node->panner, frames_out[0], frames_in[0], *frame_count_out);
     }
     (void)frame_count_in;
 }
@@ -0,0 +1,277 @@
+#include "ma_simd.h"
+
+#include <initializer_list>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#if defined(__SSE2__)
+#define MA_SIMD_SSE2
+#endif
+#define MA_SIMD_AVX2
+#define MA_SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define MA_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+// Scalar
+
+static void scalar_apply_gain_f32(float *dst, const float *src, float gain, ma_uint64 sample_count) {
+    for (ma_uint64 i = 0; i < sample_count; ++i) dst[i] = src[i] * gain;
+}
+
+static void scalar_multiply_f32(float *dst, const float *a, const float *b, ma_uint64 sample_count) {
+    for (ma_uint64 i = 0; i < sample_count; ++i) dst[i] = a[i] * b[i];
+}
+
+static void scalar_apply_stereo_gain_f32(float *dst, const float *src, float left_gain, float right_gain, ma_uint64 frame_count) {
+    for (ma_uint64 i = 0; i < frame_count; ++i) {
+        dst[i * 2 + 0] = src[i * 2 + 0] * left_gain;
+        dst[i * 2 + 1] = src[i * 2 + 1] * right_gain;
+    }
+}
+
+static void scalar_deinterleave_f32(float **dst, const float *src, ma_uint32 channels, ma_uint64 frame_count) {
+    if (channels == 1) {
+        memcpy(dst[0], src, frame_count * sizeof(float));
+        return;
+    }
+    // Channel-major, so each output is written sequentially.
+    for (ma_uint32 channel = 0; channel < channels; ++channel) {
+        float *out = dst[channel];
+        for (ma_uint64 i = 0; i < frame_count; ++i) out[i] = src[i * channels + channel];
+    }
+}
+
+static void scalar_interleave_f32(float *dst, const float *const *src, ma_uint32 channels, ma_uint64 frame_count) {
+    if (channels == 1) {
+        memcpy(dst, src[0], frame_count * sizeof(float));
+        return;
+    }
+    for (ma_uint32 channel = 0; channel < channels; ++channel) {
+        const float *in = src[channel];
+        for (ma_uint64 i = 0; i < frame_count; ++i) dst[i * channels + channel] = in[i];
+    }
+}
+
+// Each vectorized kernel processes as many full vectors as possible, and hands the remainder to its scalar counterpart.
+
+#ifdef MA_SIMD_SSE2
+static void sse2_apply_gain_f32(float *dst, const float *src, float gain, ma_uint64 sample_count) {
+    const __m128 g = _mm_set1_ps(gain);
+    ma_uint64 i = 0;
+    for (; i + 4 <= sample_count; i += 4) _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), g));
+    scalar_apply_gain_f32(dst + i, src + i, gain, sample_count - i);
+}
+
+static void sse2_multiply_f32(float *dst, const float *a, const float *b, ma_uint64 sample_count) {
+    ma_uint64 i = 0;
+    for (; i + 4 <= sample_count; i += 4) _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    scalar_multiply_f32(dst + i, a + i, b + i, sample_count - i);
+}
+
+static void sse2_apply_stereo_gain_f32(float *dst, const float *src, float left_gain, float right_gain, ma_uint64 frame_count) {
+    const __m128 g = _mm_setr_ps(left_gain, right_gain, left_gain, right_gain);
+    ma_uint64 i = 0;
+    for (; i + 2 <= frame_count; i += 2) _mm_storeu_ps(dst + i * 2, _mm_mul_ps(_mm_loadu_ps(src + i * 2), g));
+    scalar_apply_stereo_gain_f32(dst + i * 2, src + i * 2, left_gain, right_gain, frame_count - i);
+}
+
+static void sse2_deinterleave_f32(float **dst, const float *src, ma_uint32 channels, ma_uint64 frame_count) {
+    if (channels != 2) return scalar_deinterleave_f32(dst, src, channels, frame_count);
+
+    float *left = dst[0], *right = dst[1];
+    ma_uint64 i = 0;
+    for (; i + 4 <= frame_count; i += 4) {
+        const __m128 a = _mm_loadu_ps(src + i * 2), b = _mm_loadu_ps(src + i * 2 + 4);
+        _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    float *rest[2] = {left + i, right + i};
+    scalar_deinterleave_f32(rest, src + i * 2, 2, frame_count - i);
+}
+
+static void sse2_interleave_f32(float *dst, const float *const *src, ma_uint32 channels, ma_uint64 frame_count) {
+    if (channels != 2) return scalar_interleave_f32(dst, src, channels, frame_count);
+
+    const float *left = src[0], *right = src[1];
+    ma_uint64 i = 0;
+    for (; i + 4 <= frame_count; i += 4) {
+        const __m128 l = _mm_loadu_ps(left + i), r = _mm_loadu_ps(right + i);
+        _mm_storeu_ps(dst + i * 2, _mm_unpacklo_ps(l, r));
+        _mm_storeu_ps(dst + i * 2 + 4, _mm_unpackhi_ps(l, r));
+    }
+    const float *rest[2] = {left + i, right + i};
+    scalar_interleave_f32(dst + i * 2, rest, 2, frame_count - i);
+}
+#endif
+
+#ifdef MA_SIMD_AVX2
+MA_SIMD_TARGET_AVX2 static void avx2_apply_gain_f32(float *dst, const float *src, float gain, ma_uint64 sample_count) {
+    const __m256 g = _mm256_set1_ps(gain);
+    ma_uint64 i = 0;
+    for (; i + 8 <= sample_count; i += 8) _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), g));
+    scalar_apply_gain_f32(dst + i, src + i, gain, sample_count - i);
+}
+
+MA_SIMD_TARGET_AVX2 static void avx2_multiply_f32(float *dst, const float *a, const float *b, ma_uint64 sample_count) {
+    ma_uint64 i = 0;
+    for (; i + 8 <= sample_count; i += 8) _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    scalar_multiply_f32(dst + i, a + i, b + i, sample_count - i);
+}
+
+MA_SIMD_TARGET_AVX2 static void avx2_apply_stereo_gain_f32(float *dst, const float *src, float left_gain, float right_gain, ma_uint64 frame_count) {
+    const __m256 g = _mm256_setr_ps(left_gain, right_gain, left_gain, right_gain, left_gain, right_gain, left_gain, right_gain);
+    ma_uint64 i = 0;
+    for (; i + 4 <= frame_count; i += 4) _mm256_storeu_ps(dst + i * 2, _mm256_mul_ps(_mm256_loadu_ps(src + i * 2), g));
+    scalar_apply_stereo_gain_f32(dst + i * 2, src + i * 2, left_gain, right_gain, frame_count - i);
+}
+
+MA_SIMD_TARGET_AVX2 static void avx2_deinterleave_f32(float **dst, const float *src, ma_uint32 channels, ma_uint64 frame_count) {
+    if (channels != 2) return scalar_deinterleave_f32(dst, src, channels, frame_count);
+
+    float *left = dst[0], *right = dst[1];
+    ma_uint64 i = 0;
+    for (; i + 8 <= frame_count; i += 8) {
+        const __m256 a = _mm256_loadu_ps(src + i * 2), b = _mm256_loadu_ps(src + i * 2 + 8);
+        // Shuffling within 128-bit lanes leaves frames 0-1,4-5 | 2-3,6-7. Reorder the 64-bit pairs to 0-1,2-3 | 4-5,6-7.
+        const __m256 l = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)), r = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm256_storeu_ps(left + i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(l), _MM_SHUFFLE(3, 1, 2, 0))));
+        _mm256_storeu_ps(right + i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(r), _MM_SHUFFLE(3, 1, 2, 0))));
+    }
+    float *rest[2] = {left + i, right + i};
+    scalar_deinterleave_f32(rest, src + i * 2, 2, frame_count - i);
+}
+
+MA_SIMD_TARGET_AVX2 static void avx2_interleave_f32(float *dst, const float *const *src, ma_uint32 channels, ma_uint64 frame_count) {
+    if (channels != 2) return scalar_interleave_f32(dst, src, channels, frame_count);
+
+    const float *left = src[0], *right = src[1];
+    ma_uint64 i = 0;
+    for (; i + 8 <= frame_count; i += 8) {
+        const __m256 l = _mm256_loadu_ps(left + i), r = _mm256_loadu_ps(right + i);
+        // Unpacking within 128-bit lanes leaves frames 0-1,4-5 (low) and 2-3,6-7 (high).
+        const __m256 low = _mm256_unpacklo_ps(l, r), high = _mm256_unpackhi_ps(l, r);
+        _mm256_storeu_ps(dst + i * 2, _mm256_permute2f128_ps(low, high, 0x20));
+        _mm256_storeu_ps(dst + i * 2 + 8, _mm256_permute2f128_ps(low, high, 0x31));
+    }
+    const float *rest[2] = {left + i, right + i};
+    scalar_interleave_f32(dst + i * 2, rest, 2, frame_count - i);
+}
+#endif
+
+#ifdef MA_SIMD_NEON
+static void neon_apply_gain_f32(float *dst, const float *src, float gain, ma_uint64 sample_count) {
+    ma_uint64 i = 0;
+    for (; i + 4 <= sample_count; i += 4) vst1q_f32(dst + i, vmulq_n_f32(vld1q_f32(src + i), gain));
+    scalar_apply_gain_f32(dst + i, src + i, gain, sample_count - i);
+}
+
+static void neon_multiply_f32(float *dst, const float *a, const float *b, ma_uint64 sample_count) {
+    ma_uint64 i = 0;
+    for (; i + 4 <= sample_count; i += 4) vst1q_f32(dst + i, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+    scalar_multiply_f32(dst + i, a + i, b + i, sample_count - i);
+}
+
+static void neon_apply_stereo_gain_f32(float *dst, const float *src, float left_gain, float right_gain, ma_uint64 frame_count) {
+    const float gains[4] = {left_gain, right_gain, left_gain, right_gain};
+    const float32x4_t g = vld1q_f32(gains);
+    ma_uint64 i = 0;
+    for (; i + 2 <= frame_count; i += 2) vst1q_f32(dst + i * 2, vmulq_f32(vld1q_f32(src + i * 2), g));
+    scalar_apply_stereo_gain_f32(dst + i * 2, src + i * 2, left_gain, right_gain, frame_count - i);
+}
+
+static void neon_deinterleave_f32(float **dst, const float *src, ma_uint32 channels, ma_uint64 frame_count) {
+    if (channels != 2) return scalar_deinterleave_f32(dst, src, channels, frame_count);
+
+    float *left = dst[0], *right = dst[1];
+    ma_uint64 i = 0;
+    for (; i + 4 <= frame_count; i += 4) {
+        const float32x4x2_t lr = vld2q_f32(src + i * 2);
+        vst1q_f32(left + i, lr.val[0]);
+        vst1q_f32(right + i, lr.val[1]);
+    }
+    float *rest[2] = {left + i, right + i};
+    scalar_deinterleave_f32(rest, src + i * 2, 2, frame_count - i);
+}
+
+static void neon_interleave_f32(float *dst, const float *const *src, ma_uint32 channels, ma_uint64 frame_count) {
+    if (channels != 2) return scalar_interleave_f32(dst, src, channels, frame_count);
+
+    const float *left = src[0], *right = src[1];
+    ma_uint64 i = 0;
+    for (; i + 4 <= frame_count; i += 4) vst2q_f32(dst + i * 2, float32x4x2_t{{vld1q_f32(left + i), vld1q_f32(right + i)}});
+    const float *rest[2] = {left + i, right + i};
+    scalar_interleave_f32(dst + i * 2, rest, 2, frame_count - i);
+}
+#endif
+
+// Dispatch
+
+struct ma_simd_kernels {
+    ma_simd_instruction_set instruction_set;
+    void (*apply_gain_f32)(float *, const float *, float, ma_uint64);
+    void (*multiply_f32)(float *, const float *, const float *, ma_uint64);
+    void (*apply_stereo_gain_f32)(float *, const float *, float, float, ma_uint64);
+    void (*deinterleave_f32)(float **, const float *, ma_uint32, ma_uint64);
+    void (*interleave_f32)(float *, const float *const *, ma_uint32, ma_uint64);
+};
+
+// Returns `MA_FALSE` if `instruction_set` isn't supported by this build or the running CPU.
+static ma_bool32 ma_simd_get_kernels(ma_simd_instruction_set instruction_set, ma_simd_kernels *kernels) {
+    switch (instruction_set) {
+        case ma_simd_instruction_set_scalar:
+            *kernels = {instruction_set, scalar_apply_gain_f32, scalar_multiply_f32, scalar_apply_stereo_gain_f32, scalar_deinterleave_f32, scalar_interleave_f32};
+            return MA_TRUE;
+#ifdef MA_SIMD_SSE2
+        case ma_simd_instruction_set_sse2:
+            *kernels = {instruction_set, sse2_apply_gain_f32, sse2_multiply_f32, sse2_apply_stereo_gain_f32, sse2_deinterleave_f32, sse2_interleave_f32};
+            return MA_TRUE;
+#endif
+#ifdef MA_SIMD_AVX2
+        case ma_simd_instruction_set_avx2:
+            if (!__builtin_cpu_supports("avx2")) return MA_FALSE;
+            *kernels = {instruction_set, avx2_apply_gain_f32, avx2_multiply_f32, avx2_apply_stereo_gain_f32, avx2_deinterleave_f32, avx2_interleave_f32};
+            return MA_TRUE;
+#endif
+#ifdef MA_SIMD_NEON
+        case ma_simd_instruction_set_neon:
+            *kernels = {instruction_set, neon_apply_gain_f32, neon_multiply_f32, neon_apply_stereo_gain_f32, neon_deinterleave_f32, neon_interleave_f32};
+            return MA_TRUE;
+#endif
+        default: return MA_FALSE;
+    }
+}
+
+static ma_simd_kernels ma_simd_select_kernels() {
+    ma_simd_kernels kernels;
+    for (const auto instruction_set : {ma_simd_instruction_set_avx2, ma_simd_instruction_set_sse2, ma_simd_instruction_set_neon}) {
+        if (ma_simd_get_kernels(instruction_set, &kernels)) return kernels;
+    }
+    ma_simd_get_kernels(ma_simd_instruction_set_scalar, &kernels);
+    return kernels;
+}
+
+// Selected during static initialization, so the audio thread never pays for (or races on) the first-use check.
+static ma_simd_kernels Kernels = ma_simd_select_kernels();
+
+ma_simd_instruction_set ma_simd_get_instruction_set() { return Kernels.instruction_set; }
+ma_bool32 ma_simd_set_instruction_set(ma_simd_instruction_set instruction_set) { return ma_simd_get_kernels(instruction_set, &Kernels); }
+
+const char *ma_simd_get_instruction_set_name(ma_simd_instruction_set instruction_set) {
+    switch (instruction_set) {
+        case ma_simd_instruction_set_sse2: return "SSE2";
+        case ma_simd_instruction_set_avx2: return "AVX2";
+        case ma_simd_instruction_set_neon: return "NEON";
+        default: return "Scalar";
+    }
+}
+
+void ma_simd_apply_gain_f32(float *dst, const float *src, float gain, ma_uint64 sample_count) { Kernels.apply_gain_f32(dst, src, gain, sample_count); }
+void ma_simd_multiply_f32(float *dst, const float *a, const float *b, ma_uint64 sample_count) { Kernels.multiply_f32(dst, a, b, sample_count); }
+void ma_simd_apply_stereo_gain_f32(float *dst, const float *src, float left_gain, float right_gain, ma_uint64 frame_count) {
+    Kernels.apply_stereo_gain_f32(dst, src, left_gain, right_gain, frame_count);
+}
+void ma_simd_deinterleave_f32(float **dst, const float *src, ma_uint32 channels, ma_uint64 frame_count) { Kernels.deinterleave_f32(dst, src, channels, frame_count); }
+void ma_simd_interleave_f32(float *dst, const float *const *src, ma_uint32 channels, ma_uint64 frame_count) { Kernels.interleave_f32(dst, src, channels, frame_count); }
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "miniaudio.h"
+
+// Vectorized kernels for the per-sample loops in the custom `ma_*` node process callbacks.
+// Each kernel has SSE2 & AVX2 (x86) or NEON (ARM) implementations, and a scalar fallback.
+// The implementation is chosen once, at startup, based on the instruction sets supported by the running CPU.
+// Unless noted otherwise, `dst` may alias a source buffer.
+
+enum ma_simd_instruction_set {
+    ma_simd_instruction_set_scalar,
+    ma_simd_instruction_set_sse2,
+    ma_simd_instruction_set_avx2,
+    ma_simd_instruction_set_neon,
+};
+
+ma_simd_instruction_set ma_simd_get_instruction_set();
+// Use the kernels for `instruction_set`, e.g. to check or benchmark each implementation against the scalar one.
+// Returns `MA_FALSE` (keeping the current kernels) if it isn't supported by this build or the running CPU.
+// Not safe to call while any kernel is running.
+ma_bool32 ma_simd_set_instruction_set(ma_simd_instruction_set);
+const char *ma_simd_get_instruction_set_name(ma_simd_instruction_set);
+
+// `dst[i] = src[i] * gain`
+void ma_simd_apply_gain_f32(float *dst, const float *src, float gain, ma_uint64 sample_count);
+// `dst[i] = a[i] * b[i]`, e.g. for applying a window function.
+void ma_simd_multiply_f32(float *dst, const float *a, const float *b, ma_uint64 sample_count);
+// Apply separate gains to the left and right channels of interleaved stereo frames.
+void ma_simd_apply_stereo_gain_f32(float *dst, const float *src, float left_gain, float right_gain, ma_uint64 frame_count);
+
+// Stereo is vectorized. Other channel counts use the scalar implementation.
+// `dst` must not alias `src`.
+void ma_simd_deinterleave_f32(float **dst, const float *src, ma_uint32 channels, ma_uint64 frame_count);
+void ma_simd_interleave_f32(float *dst, const float *const *src, ma_uint32 channels, ma_uint64 frame_count);
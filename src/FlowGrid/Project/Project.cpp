@@ -14,6 +14,7 @@
 #include "Helper/File.h"
 #include "Helper/String.h"
 #include "Helper/Time.h"
+#include "ProjectBinary.h"
 
 using namespace FlowGrid;
 
@@ -25,6 +26,7 @@ static const fs::path InternalPath = ".flowgrid";
 static const std::map<ProjectFormat, std::string> ExtensionByProjectFormat{
     {ProjectFormat::ActionFormat, ".fla"},
     {ProjectFormat::StateFormat, ".fls"},
+    {ProjectFormat::BinaryFormat, ".flb"},
 };
 static const auto ProjectFormatByExtension = ExtensionByProjectFormat | std::views::transform([](const auto &p) { return std::pair(p.second, p.first); }) | ranges::to<std::map>();
 static const auto AllProjectExtensions = ProjectFormatByExtension | std::views::keys;
@@ -38,6 +40,15 @@ static const fs::path DefaultProjectPath = InternalPath / ("default" + Extension
 static std::optional<fs::path> CurrentProjectPath;
 static bool ProjectHasChanges{false};
 
+// A binary project's gesture log, replayed into the history when it's first needed (see `Project::OpenBinaryFormatProject`).
+struct PendingGestureLog {
+    explicit PendingGestureLog(const fs::path &path) : File(path), Reader(File.Data()) {}
+
+    FileIO::MappedFile File;
+    ProjectBinary::Reader Reader;
+};
+static std::unique_ptr<PendingGestureLog> PendingGestures;
+
 std::optional<ProjectFormat> GetProjectFormat(const fs::path &path) {
     const string &ext = path.extension();
     if (auto it = ProjectFormatByExtension.find(ext); it != ProjectFormatByExtension.end()) return it->second;
@@ -163,10 +174,22 @@ void Project::CommitGesture() const {
 void Project::SetHistoryIndex(u32 index) const {
     if (index == History.Index) return;
 
+    History.SetIndex(index);
+    ApplyCurrentHistoryStore();
+}
+
+void Project::SetHistoryRecordId(u32 record_id) const {
+    if (record_id == History.RecordId()) return;
+
+    History.SetRecordId(record_id);
+    ApplyCurrentHistoryStore();
+}
+
+// Set the store to the current history record's store, after navigating the history.
+void Project::ApplyCurrentHistoryStore() const {
     GestureChangedPaths.clear();
-    // If we're mid-gesture, revert the current gesture before navigating to the new index.
+    // If we're mid-gesture, revert the current gesture.
     ActiveGestureActions.clear();
-    History.SetIndex(index);
     const auto patch = RootStore.CheckedSet(History.CurrentStore());
     RefreshChanged(patch);
     // ImGui settings are cheched separately from style since we don't need to re-apply ImGui settings state to ImGui context
@@ -181,7 +204,8 @@ void Project::SetHistoryIndex(u32 index) const {
 
 json Project::GetProjectJson(const ProjectFormat format) const {
     switch (format) {
-        case StateFormat: return ToJson();
+        case StateFormat:
+        case BinaryFormat: return ToJson(); // The binary format's state section, as JSON.
         case ActionFormat: return History.GetIndexedGestures();
     }
 }
@@ -259,7 +283,7 @@ void Project::Apply(const ActionType &action) const {
                 // `StoreHistory::SetIndex` reverts the current gesture before applying the new history index.
                 // If we're at the end of the stack, we want to commit the active gesture and add it to the stack.
                 // Otherwise, if we're already in the middle of the stack somewhere, we don't want an active gesture
-                // to commit and cut off everything after the current history index, so an undo just ditches the active changes.
+                // to commit and start a new branch from the current history index, so an undo just ditches the active changes.
                 // (This allows consistent behavior when e.g. being in the middle of a change and selecting a point in the undo history.)
                 if (History.Index == History.Size() - 1) {
                     if (!ActiveGestureActions.empty()) CommitGesture();
@@ -270,6 +294,7 @@ void Project::Apply(const ActionType &action) const {
             },
             [this](const Action::Project::Redo &) { SetHistoryIndex(History.Index + 1); },
             [this](const Action::Project::SetHistoryIndex &a) { SetHistoryIndex(a.index); },
+            [this](const Action::Project::SetHistoryRecordId &a) { SetHistoryRecordId(a.record_id); },
 
             [this](const Store::ActionType &a) { RootStore.Apply(a); },
             [this](const Action::Project::ShowOpenDialog &) {
@@ -296,11 +321,12 @@ bool Project::CanApply(const ActionType &action) const {
             [](const Action::Container::Any &) { return true; },
             [](const Action::TextBuffer::Any &) { return true; },
 
-            [this](const Action::Project::Undo &) { return !ActiveGestureActions.empty() || History.CanUndo(); },
+            [this](const Action::Project::Undo &) { return !ActiveGestureActions.empty() || History.CanUndo() || (PendingGestures && PendingGestures->Reader.HistoryIndex() > 0); },
             [this](const Action::Project::Redo &) { return History.CanRedo(); },
             [this](const Action::Project::SetHistoryIndex &a) { return a.index < History.Size(); },
-            [this](const Action::Project::Save &) { return !History.Empty(); },
-            [this](const Action::Project::SaveDefault &) { return !History.Empty(); },
+            [this](const Action::Project::SetHistoryRecordId &a) { return a.record_id < History.RecordCount(); },
+            [this](const Action::Project::Save &) { return !History.Empty() || PendingGestures; },
+            [this](const Action::Project::SaveDefault &) { return !History.Empty() || PendingGestures; },
             [](const Action::Project::ShowOpenDialog &) { return true; },
             [](const Action::Project::ShowSaveDialog &) { return ProjectHasChanges; },
             [](const Action::Project::SaveCurrent &) { return ProjectHasChanges; },
@@ -433,14 +459,17 @@ void SetCurrentProjectPath(const fs::path &path) {
 }
 
 bool Project::Save(const fs::path &path) const {
-    const bool is_current_project = CurrentProjectPath && fs::equivalent(path, *CurrentProjectPath);
+    std::error_code error; // `path` may not exist yet.
+    const bool is_current_project = CurrentProjectPath && fs::equivalent(path, *CurrentProjectPath, error);
     if (is_current_project && !ProjectHasChanges) return false;
 
     const auto format = GetProjectFormat(path);
     if (!format) return false; // TODO log
 
+    LoadPendingGestures();
     CommitGesture(); // Make sure any pending actions/diffs are committed.
-    if (!FileIO::write(path, GetProjectJson(*format).dump())) {
+    const bool written = format == BinaryFormat ? FileIO::write(path, ProjectBinary::Write(RootStore, History.GetIndexedGestures())) : FileIO::write(path, GetProjectJson(*format).dump());
+    if (!written) {
         throw std::runtime_error(std::format("Failed to write project file: {}", path.string()));
     }
 
@@ -481,10 +510,14 @@ void Project::OpenStateFormatProject(const fs::path &file_path) const {
 
     // Now, every flattened JSON pointer is 1:1 with an instance path.
     SetJson(std::move(j));
+    CommitLoadedState();
+}
 
+// Commit a loaded project's state, refresh all components, and start a new history from it.
+void Project::CommitLoadedState() const {
     // We could do `RefreshChanged(RootStore.CheckedCommit())`, and only refresh the changed components,
     // but this gets tricky with component containers, since the store patch will contain added/removed paths
-    // that have already been accounted for above.
+    // that have already been accounted for.
     RootStore.Commit();
     ClearChanged();
     LatestChangedPaths.clear();
@@ -493,6 +526,95 @@ void Project::OpenStateFormatProject(const fs::path &file_path) const {
     // Always update the ImGui context, regardless of the patch, to avoid expensive sifting through paths and just to be safe.
     ImGuiSettings.IsChanged = true;
     History.Clear();
+    PendingGestures.reset();
+}
+
+// Helper function used in `Project::Open`.
+// Replays gestures on top of the empty project, recording each in the history tree as a child of its parent record,
+// and then navigates to the record with `record_id`.
+// This is a bulk path, much faster than applying each action as it would be at runtime:
+// * Each action's patch is produced from the store paths it touched, and only the fields it changed are refreshed.
+// * The history records each gesture with its merged action patches, rather than diffing the whole store.
+// * Change listeners are notified once per gesture rather than per action, and their store writes are recorded with the gesture.
+// * Components are marked as changed (for the UI) once, after all gestures are replayed.
+void Project::ReplayGestures(u32 gesture_count, const std::function<Gesture(u32)> &get_gesture, const std::function<u32(u32)> &get_parent_id, u32 record_id) const {
+    OpenStateFormatProject(EmptyProjectPath);
+
+    // Later actions may depend on fields' cached values, so changed fields are refreshed immediately.
+    const auto refresh_changed_fields = [](const Patch &patch) {
+        MarkAllChanged(patch);
+        for (const auto id : ChangedIds) {
+            if (FieldIds.contains(id)) ById.at(id)->Refresh();
+        }
+    };
+
+    const Store initial_store{RootStore};
+    for (u32 i = 0; i < gesture_count; i++) {
+        if (const u32 parent_id = get_parent_id(i); parent_id != History.RecordId()) {
+            // The gesture starts a new branch.
+            History.SetRecordId(parent_id);
+            RefreshChanged(RootStore.CheckedSet(History.CurrentStore()));
+        }
+
+        auto gesture = get_gesture(i);
+        PatchOps gesture_ops{};
+        for (const auto &action_moment : gesture.Actions) {
+            std::visit(Match{[this](const Project::ActionType &a) { Apply(a); }}, action_moment.Action);
+            const auto patch = RootStore.CheckedCommit();
+            refresh_changed_fields(patch);
+            gesture_ops = Merge(gesture_ops, patch.Ops);
+        }
+        // Drop any replaced values that ended up back where they started.
+        std::erase_if(gesture_ops, [](const auto &entry) { return entry.second.Op == PatchOpType::Replace && entry.second.Value == entry.second.Old; });
+        if (!gesture_ops.empty()) {
+            // Listeners may write to the store in response (e.g. the audio graph updating its connections),
+            // just as they do at runtime, so their writes belong to this gesture's record.
+            RefreshChanged({gesture_ops});
+            const auto listener_patch = RootStore.CheckedCommit();
+            refresh_changed_fields(listener_patch);
+            gesture_ops = Merge(gesture_ops, listener_patch.Ops);
+        }
+        History.AddGesture(std::move(gesture), {std::move(gesture_ops)});
+    }
+    MarkAllChanged(RootStore.CreatePatch(initial_store, Store{RootStore}));
+
+    SetHistoryRecordId(record_id);
+    LatestChangedPaths.clear();
+}
+
+// Helper function used in `Project::Open`.
+// The state section is loaded directly into the store.
+// The gesture log stays mapped, and is replayed into the history only when an action first depends on it (see `LoadPendingGestures`).
+void Project::OpenBinaryFormatProject(const fs::path &file_path) const {
+    auto gesture_log = std::make_unique<PendingGestureLog>(file_path);
+    const auto &reader = gesture_log->Reader;
+
+    Store store{};
+    reader.ReadState(store);
+    RootStore.Set(std::move(store));
+    // Refresh all component containers first, to ensure the dynamically managed component instances match the store.
+    const auto auxiliary_ids = ContainerAuxiliaryIds; // Copy, since refreshing containers can create/destroy containers.
+    for (const ID auxiliary_id : auxiliary_ids) {
+        if (!ById.contains(auxiliary_id)) continue;
+
+        auto *auxiliary_field = ById.at(auxiliary_id);
+        auxiliary_field->Refresh();
+        auxiliary_field->Parent->Refresh();
+    }
+    CommitLoadedState();
+    if (reader.GestureCount() > 0) PendingGestures = std::move(gesture_log);
+}
+
+// Replay a binary project's gesture log on top of the empty project, decoding one gesture at a time from the mapped file.
+// The replay ends at the saved history record, whose store is the state that was loaded when the project was opened.
+void Project::LoadPendingGestures() const {
+    if (!PendingGestures) return;
+
+    const auto gesture_log = std::move(PendingGestures);
+    const auto &reader = gesture_log->Reader;
+    const bool had_changes = ProjectHasChanges; // Navigating to the saved record isn't a change.
+    ReplayGestures(reader.GestureCount(), [&reader](u32 i) { return reader.ReadGesture(i); }, [&reader](u32 i) { return reader.GestureParentId(i); }, reader.HistoryIndex());
+    ProjectHasChanges = had_changes;
 }
 
 void Project::Open(const fs::path &file_path) const {
@@ -504,18 +626,17 @@ void Project::Open(const fs::path &file_path) const {
     if (format == StateFormat) {
         OpenStateFormatProject(file_path);
     } else if (format == ActionFormat) {
-        OpenStateFormatProject(EmptyProjectPath);
-
         StoreHistory::IndexedGestures indexed_gestures = ReadFileJson(file_path);
-        for (auto &gesture : indexed_gestures.Gestures) {
-            for (const auto &action_moment : gesture.Actions) {
-                std::visit(Match{[this](const Project::ActionType &a) { Apply(a); }}, action_moment.Action);
-                RefreshChanged(RootStore.CheckedCommit());
-            }
-            History.AddGesture(std::move(gesture));
-        }
-        SetHistoryIndex(indexed_gestures.Index);
-        LatestChangedPaths.clear();
+        auto &gestures = indexed_gestures.Gestures;
+        const auto &parent_ids = indexed_gestures.ParentIds;
+        ReplayGestures(
+            gestures.size(),
+            [&gestures](u32 i) { return std::move(gestures[i]); },
+            [&parent_ids](u32 i) { return parent_ids ? (*parent_ids)[i] : i; },
+            indexed_gestures.Index
+        );
+    } else if (format == BinaryFormat) {
+        OpenBinaryFormatProject(file_path);
     }
 
     SetCurrentProjectPath(file_path);
@@ -727,7 +848,7 @@ void Project::Debug::Metrics::FlowGridMetrics::Render() const {
         const auto &history = project.History;
         const bool no_history = history.Empty();
         if (no_history) BeginDisabled();
-        if (TreeNodeEx("History", ImGuiTreeNodeFlags_DefaultOpen, "History (Records: %d, Current record index: %d)", history.Size() - 1, history.Index)) {
+        if (TreeNodeEx("History", ImGuiTreeNodeFlags_DefaultOpen, "History (Records: %d, Branch records: %d, Current record index: %d)", history.RecordCount() - 1, history.Size() - 1, history.Index)) {
             if (!no_history) {
                 if (u32 edited_history_index = history.Index; SliderU32("History index", &edited_history_index, 0, history.Size() - 1)) {
                     project.Q(Action::Project::SetHistoryIndex{edited_history_index});
@@ -738,13 +859,22 @@ void Project::Debug::Metrics::FlowGridMetrics::Render() const {
                 if (TreeNodeEx(std::to_string(i).c_str(), i == history.Index ? (ImGuiTreeNodeFlags_Selected | ImGuiTreeNodeFlags_DefaultOpen) : ImGuiTreeNodeFlags_None)) {
                     const auto &[store_record, gesture] = history.RecordAt(i);
                     BulletText("Gesture committed: %s\n", date::format("%Y-%m-%d %T", gesture.CommitTime).c_str());
+                    if (const auto &sibling_ids = history.ChildRecordIds(history.RecordIdAt(i - 1)); sibling_ids.size() > 1) {
+                        // The previous record has multiple branches.
+                        if (TreeNode("Branches")) {
+                            for (const u32 sibling_id : sibling_ids) {
+                                if (sibling_id == history.RecordIdAt(i)) BulletText("Record %u (current branch)", sibling_id);
+                                else if (Button(std::format("Switch to record {}", sibling_id).c_str())) project.Q(Action::Project::SetHistoryRecordId{sibling_id});
+                            }
+                            TreePop();
+                        }
+                    }
                     if (TreeNode("Actions")) {
                         ShowActions(gesture.Actions);
                         TreePop();
                     }
                     if (TreeNode("Patch")) {
-                        // We compute patches as we need them rather than memoizing.
-                        const auto &patch = history.CreatePatch(i);
+                        const auto &patch = history.PatchAt(i);
                         for (const auto &[partial_path, op] : patch.Ops) {
                             const auto &path = patch.BasePath / partial_path;
                             if (TreeNodeEx(path.string().c_str(), ImGuiTreeNodeFlags_DefaultOpen)) {
@@ -801,6 +931,24 @@ void Project::Debug::Metrics::Render() const {
     RenderTabs();
 }
 
+// True if the action adds to or navigates the history, or saves it.
+static bool DependsOnHistory(const Project::ActionType &action) {
+    return std::holds_alternative<Action::Project::Undo>(action) ||
+        std::holds_alternative<Action::Project::Redo>(action) ||
+        std::holds_alternative<Action::Project::SetHistoryIndex>(action) ||
+        std::holds_alternative<Action::Project::SetHistoryRecordId>(action) ||
+        std::holds_alternative<Action::Project::Save>(action) ||
+        std::holds_alternative<Action::Project::SaveDefault>(action) ||
+        std::holds_alternative<Action::Project::SaveCurrent>(action) ||
+        std::visit(
+            Match{
+                [](const Action::Saved &) { return true; },
+                [](const Action::NonSaved &) { return false; },
+            },
+            action
+        );
+}
+
 void Project::ApplyQueuedActions(ActionQueue<ActionType> &queue, bool force_commit_gesture, bool ignore_actions) const {
     static ActionMoment<ActionType> action_moment; // For dequeuing.
 
@@ -813,6 +961,7 @@ void Project::ApplyQueuedActions(ActionQueue<ActionType> &queue, bool force_comm
 
     while (queue.TryDequeue(action_moment)) {
         auto &[action, queue_time] = action_moment;
+        if (PendingGestures && DependsOnHistory(action)) LoadPendingGestures();
         if (!CanApply(action)) continue;
 
         // Special cases:
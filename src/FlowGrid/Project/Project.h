@@ -18,9 +18,12 @@
 
 enum ProjectFormat {
     StateFormat,
-    ActionFormat
+    ActionFormat,
+    BinaryFormat
 };
 
+std::optional<ProjectFormat> GetProjectFormat(const fs::path &); // By file extension.
+
 struct StoreHistory;
 
 struct Plottable {
@@ -241,8 +244,14 @@ private:
     bool Save(const fs::path &) const;
 
     void OpenStateFormatProject(const fs::path &file_path) const;
+    void OpenBinaryFormatProject(const fs::path &file_path) const;
+    void CommitLoadedState() const;
+    void LoadPendingGestures() const;
+    void ReplayGestures(u32 gesture_count, const std::function<Gesture(u32)> &get_gesture, const std::function<u32(u32)> &get_parent_id, u32 record_id) const;
 
     void SetHistoryIndex(u32) const;
+    void SetHistoryRecordId(u32) const;
+    void ApplyCurrentHistoryStore() const;
 
     void WindowMenuItem() const;
 };
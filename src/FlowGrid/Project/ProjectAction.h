@@ -10,6 +10,7 @@ DefineActionType(
     DefineUnsavedAction(Undo, NoMerge, "");
     DefineUnsavedAction(Redo, NoMerge, "");
     DefineUnsavedAction(SetHistoryIndex, NoMerge, "", u32 index;);
+    DefineUnsavedAction(SetHistoryRecordId, NoMerge, "", u32 record_id;);
     DefineUnsavedAction(Open, NoMerge, "", fs::path file_path;);
     DefineUnsavedAction(OpenEmpty, NoMerge, "~New project");
     DefineUnsavedAction(OpenDefault, NoMerge, "");
@@ -18,6 +19,6 @@ DefineActionType(
     DefineUnsavedAction(SaveCurrent, NoMerge, "~Save project");
 
     using Any = ActionVariant<
-        Undo, Redo, SetHistoryIndex,
+        Undo, Redo, SetHistoryIndex, SetHistoryRecordId,
         Open, OpenEmpty, OpenDefault, Save, SaveDefault, SaveCurrent, ShowOpenDialog, ShowSaveDialog>;
 );
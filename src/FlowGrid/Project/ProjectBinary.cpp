@@ -0,0 +1,180 @@
+#include "ProjectBinary.h"
+
+#include <cstring>
+#include <format>
+
+#include "Core/Store/Store.h"
+#include "immer/flex_vector_transient.hpp"
+
+namespace ProjectBinary {
+namespace {
+struct Header {
+    char Magic[4];
+    u32 Version;
+    u64 StateOffset;
+    u64 GestureIndexOffset;
+    u32 GestureCount;
+    u32 HistoryIndex;
+};
+
+struct ByteWriter {
+    std::vector<std::uint8_t> Bytes;
+
+    template<typename T> void Write(const T &value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto *begin = reinterpret_cast<const std::uint8_t *>(&value);
+        Bytes.insert(Bytes.end(), begin, begin + sizeof(T));
+    }
+    void Write(std::span<const std::uint8_t> bytes) {
+        Write(u64(bytes.size()));
+        Bytes.insert(Bytes.end(), bytes.begin(), bytes.end());
+    }
+    void Write(const std::string &str) { Write(std::span{reinterpret_cast<const std::uint8_t *>(str.data()), str.size()}); }
+
+    template<typename T> void Overwrite(u64 offset, const T &value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        std::memcpy(Bytes.data() + offset, &value, sizeof(T));
+    }
+};
+
+struct ByteReader {
+    std::span<const std::uint8_t> Data;
+    u64 Offset;
+
+    std::span<const std::uint8_t> Take(u64 size) {
+        // Compared without adding, so corrupt sizes near the u64 limit can't wrap around.
+        if (Offset > Data.size() || size > Data.size() - Offset) throw std::runtime_error("Binary project data is truncated.");
+        const auto bytes = Data.subspan(Offset, size);
+        Offset += size;
+        return bytes;
+    }
+    template<typename T> T Read() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, Take(sizeof(T)).data(), sizeof(T));
+        return value;
+    }
+    std::span<const std::uint8_t> ReadBytes() { return Take(Read<u64>()); }
+    std::string ReadString() {
+        const auto bytes = ReadBytes();
+        return {reinterpret_cast<const char *>(bytes.data()), bytes.size()};
+    }
+};
+
+template<typename T> struct IsVector : std::false_type {};
+template<typename T> struct IsVector<Store::Vector<T>> : std::true_type {};
+
+template<typename T> void WriteValue(ByteWriter &writer, const T &value) {
+    if constexpr (std::is_same_v<T, bool>) writer.Write(u8(value));
+    else if constexpr (std::is_same_v<T, IdPair>) {
+        writer.Write(value.first);
+        writer.Write(value.second);
+    } else if constexpr (std::is_same_v<T, std::string>) writer.Write(value);
+    else if constexpr (std::is_same_v<T, IdPairs> || std::is_same_v<T, immer::set<u32>> || IsVector<T>::value) {
+        writer.Write(u32(value.size()));
+        for (const auto &element : value) WriteValue(writer, element);
+    } else writer.Write(value);
+}
+
+template<typename T> T ReadValue(ByteReader &reader) {
+    if constexpr (std::is_same_v<T, bool>) return reader.Read<u8>() != 0;
+    else if constexpr (std::is_same_v<T, IdPair>) {
+        const auto source = reader.Read<ID>();
+        return {source, reader.Read<ID>()};
+    } else if constexpr (std::is_same_v<T, std::string>) return reader.ReadString();
+    else if constexpr (std::is_same_v<T, IdPairs> || std::is_same_v<T, immer::set<u32>>) {
+        auto value = T{}.transient();
+        const auto count = reader.Read<u32>();
+        for (u32 i = 0; i < count; i++) value.insert(ReadValue<typename T::value_type>(reader));
+        return value.persistent();
+    } else if constexpr (IsVector<T>::value) {
+        auto value = T{}.transient();
+        const auto count = reader.Read<u32>();
+        for (u32 i = 0; i < count; i++) value.push_back(ReadValue<typename T::value_type>(reader));
+        return value.persistent();
+    } else return reader.Read<T>();
+}
+
+template<typename T> void WriteTable(ByteWriter &writer, const Store &store) {
+    const auto &map = store.GetMap<T>();
+    writer.Write(u32(map.size()));
+    for (const auto &[path, value] : map) {
+        writer.Write(path.string());
+        WriteValue(writer, value);
+    }
+}
+
+template<typename T> void ReadTable(ByteReader &reader, const Store &store) {
+    const auto count = reader.Read<u32>();
+    for (u32 i = 0; i < count; i++) {
+        StorePath path = reader.ReadString();
+        store.Set(path, ReadValue<T>(reader));
+    }
+}
+
+template<typename... Ts> void WriteTables(ByteWriter &writer, const Store &store, std::tuple<Ts...>) { (WriteTable<Ts>(writer, store), ...); }
+template<typename... Ts> void ReadTables(ByteReader &reader, const Store &store, std::tuple<Ts...>) { (ReadTable<Ts>(reader, store), ...); }
+} // namespace
+
+std::vector<std::uint8_t> Write(const Store &store, const StoreHistory::IndexedGestures &indexed_gestures) {
+    ByteWriter writer;
+    const auto &gestures = indexed_gestures.Gestures;
+    Header header{{}, Version, 0, 0, u32(gestures.size()), indexed_gestures.Index};
+    std::memcpy(header.Magic, Magic, sizeof(Magic));
+    writer.Write(header);
+
+    header.StateOffset = writer.Bytes.size();
+    WriteTables(writer, store, Store::ValueTypes{});
+
+    std::vector<u64> gesture_offsets;
+    gesture_offsets.reserve(gestures.size());
+    for (u32 i = 0; i < gestures.size(); i++) {
+        const auto &gesture = gestures[i];
+        gesture_offsets.push_back(writer.Bytes.size());
+        writer.Write(indexed_gestures.ParentIds ? (*indexed_gestures.ParentIds)[i] : i);
+        writer.Write(gesture.CommitTime.time_since_epoch().count());
+        writer.Write(std::span<const std::uint8_t>{json::to_msgpack(json(gesture.Actions))});
+    }
+
+    header.GestureIndexOffset = writer.Bytes.size();
+    for (const u64 offset : gesture_offsets) writer.Write(offset);
+
+    writer.Overwrite(0, header);
+    return std::move(writer.Bytes);
+}
+
+Reader::Reader(std::span<const std::uint8_t> data) : Data(data) {
+    const auto header = ByteReader{Data, 0}.Read<Header>();
+    if (std::memcmp(header.Magic, Magic, sizeof(Magic)) != 0) throw std::runtime_error("Not a binary FlowGrid project.");
+    if (header.Version != Version) throw std::runtime_error(std::format("Unsupported binary project version: {} (expected {})", header.Version, Version));
+    if (header.StateOffset > Data.size() || header.GestureIndexOffset > Data.size() ||
+        header.GestureCount > (Data.size() - header.GestureIndexOffset) / sizeof(u64)) {
+        throw std::runtime_error("Binary project data is truncated.");
+    }
+
+    StateOffset = header.StateOffset;
+    GestureIndexOffset = header.GestureIndexOffset;
+    _GestureCount = header.GestureCount;
+    _HistoryIndex = header.HistoryIndex;
+}
+
+void Reader::ReadState(const Store &store) const {
+    ByteReader reader{Data, StateOffset};
+    ReadTables(reader, store, Store::ValueTypes{});
+}
+
+u64 Reader::GestureOffset(u32 index) const {
+    if (index >= _GestureCount) throw std::runtime_error(std::format("Gesture index {} out of range ({} gestures).", index, _GestureCount));
+    return ByteReader{Data, GestureIndexOffset + u64(index) * sizeof(u64)}.Read<u64>();
+}
+
+u32 Reader::GestureParentId(u32 index) const { return ByteReader{Data, GestureOffset(index)}.Read<u32>(); }
+
+Gesture Reader::ReadGesture(u32 index) const {
+    ByteReader reader{Data, GestureOffset(index)};
+    reader.Take(sizeof(u32)); // Skip the parent ID.
+    const auto commit_ticks = reader.Read<TimePoint::rep>();
+    const auto actions_msgpack = reader.ReadBytes();
+    return {json::from_msgpack(actions_msgpack.begin(), actions_msgpack.end()).get<SavedActionMoments>(), TimePoint{TimePoint::duration{commit_ticks}}};
+}
+} // namespace ProjectBinary
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "Core/Store/StoreHistory.h"
+
+struct Store;
+
+/**
+Versioned binary project format (`.flb`), an alternative to the JSON state (`.fls`) and action (`.fla`) formats.
+
+Layout (native byte order):
+* Header: Magic, version, section offsets, gesture count and current history record ID.
+* State section: For each of `Store::ValueTypes` (in order), an entry count followed by its (path, value) entries.
+* Gesture section: Each gesture's parent history record ID and commit time, followed by its actions as length-prefixed MessagePack.
+* Gesture index: The byte offset of each gesture, so gestures can be decoded one at a time, directly from a mapped file.
+*/
+namespace ProjectBinary {
+inline static constexpr char Magic[4]{'F', 'L', 'G', 'B'};
+inline static constexpr u32 Version = 3; // 3: Vectors are stored as a single value.
+
+std::vector<std::uint8_t> Write(const Store &, const StoreHistory::IndexedGestures &);
+
+// Reads from a byte span (typically a `FileIO::MappedFile`), which must outlive the reader.
+// Throws if the data is not a binary project of a supported version, or if a section is out of bounds.
+struct Reader {
+    explicit Reader(std::span<const std::uint8_t>);
+
+    u32 GestureCount() const { return _GestureCount; }
+    u32 HistoryIndex() const { return _HistoryIndex; }
+
+    void ReadState(const Store &) const; // Sets all state values in the provided (transient) store.
+    Gesture ReadGesture(u32 index) const;
+    u32 GestureParentId(u32 index) const; // See `StoreHistory::IndexedGestures::ParentIds`.
+
+private:
+    u64 GestureOffset(u32 index) const;
+
+    std::span<const std::uint8_t> Data;
+    u64 StateOffset, GestureIndexOffset;
+    u32 _GestureCount, _HistoryIndex;
+};
+} // namespace ProjectBinary
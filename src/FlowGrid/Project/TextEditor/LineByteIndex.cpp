@@ -0,0 +1,73 @@
+#include "LineByteIndex.h"
+
+#include <random>
+
+struct LineByteIndex::Node {
+    u32 Bytes; // Line size, plus its newline.
+    u32 Count, SubtreeBytes;
+    NodePtr Left, Right;
+};
+
+static u32 Count(const auto &node) { return node ? node->Count : 0; }
+static u32 SubtreeBytes(const auto &node) { return node ? node->SubtreeBytes : 0; }
+
+LineByteIndex::LineByteIndex(const std::vector<u32> &line_sizes) : Root(Build(line_sizes, 0, line_sizes.size())) {}
+
+u32 LineByteIndex::LineCount() const { return Count(Root); }
+
+u32 LineByteIndex::StartByte(u32 li) const {
+    u32 byte = 0;
+    for (const Node *node = Root.get(); node;) {
+        const u32 left_count = Count(node->Left);
+        if (li <= left_count) {
+            node = node->Left.get();
+        } else {
+            byte += SubtreeBytes(node->Left) + node->Bytes;
+            li -= left_count + 1;
+            node = node->Right.get();
+        }
+    }
+    return byte;
+}
+
+LineByteIndex LineByteIndex::Splice(u32 begin, u32 end, const std::vector<u32> &line_sizes) const {
+    auto [before, rest] = Split(Root, begin);
+    auto after = Split(rest, end - begin).second;
+    return LineByteIndex{Merge(Merge(std::move(before), Build(line_sizes, 0, line_sizes.size())), std::move(after))};
+}
+
+LineByteIndex::NodePtr LineByteIndex::Make(u32 bytes, NodePtr left, NodePtr right) {
+    const u32 count = Count(left) + Count(right) + 1, subtree_bytes = SubtreeBytes(left) + SubtreeBytes(right) + bytes;
+    return std::make_shared<const Node>(Node{bytes, count, subtree_bytes, std::move(left), std::move(right)});
+}
+
+LineByteIndex::NodePtr LineByteIndex::Build(const std::vector<u32> &line_sizes, u32 begin, u32 end) {
+    if (begin >= end) return nullptr;
+
+    const u32 mid = begin + (end - begin) / 2;
+    return Make(line_sizes[mid] + 1, Build(line_sizes, begin, mid), Build(line_sizes, mid + 1, end));
+}
+
+std::pair<LineByteIndex::NodePtr, LineByteIndex::NodePtr> LineByteIndex::Split(const NodePtr &node, u32 count) {
+    if (!node) return {};
+    if (count == 0) return {nullptr, node};
+    if (count >= node->Count) return {node, nullptr};
+
+    if (count <= Count(node->Left)) {
+        auto [left, right] = Split(node->Left, count);
+        return {std::move(left), Make(node->Bytes, std::move(right), node->Right)};
+    }
+    auto [left, right] = Split(node->Right, count - Count(node->Left) - 1);
+    return {Make(node->Bytes, node->Left, std::move(left)), std::move(right)};
+}
+
+// Instead of storing random priorities, pick the root with probability proportional to subtree size,
+// which keeps the tree balanced in expectation for any sequence of splits and merges, including balanced builds.
+LineByteIndex::NodePtr LineByteIndex::Merge(NodePtr left, NodePtr right) {
+    if (!left) return right;
+    if (!right) return left;
+
+    static std::minstd_rand random{};
+    if (random() % (left->Count + right->Count) < left->Count) return Make(left->Bytes, left->Left, Merge(left->Right, std::move(right)));
+    return Make(right->Bytes, Merge(std::move(left), right->Left), right->Right);
+}
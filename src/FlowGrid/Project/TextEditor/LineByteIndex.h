@@ -0,0 +1,40 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Core/Primitive/Scalar.h"
+
+/**
+A persistent index of line byte sizes, for O(log n) line -> byte offset conversion.
+Kept alongside a buffer's lines and updated by each edit, by splicing in the sizes of the replaced lines.
+Like the lines themselves, updated indexes share all untouched structure with previous versions,
+so they can be stored in history snapshots.
+
+Implemented as an order-statistic treap with path copying: each node holds one line, along with its subtree's line and byte counts.
+*/
+struct LineByteIndex {
+    LineByteIndex() = default;
+    explicit LineByteIndex(const std::vector<u32> &line_sizes);
+
+    u32 LineCount() const;
+    // The byte offset of the start of line `li`, counting one newline byte after each line.
+    u32 StartByte(u32 li) const;
+
+    // Returns a copy of this index with lines [begin, end) replaced by lines of sizes `line_sizes`.
+    LineByteIndex Splice(u32 begin, u32 end, const std::vector<u32> &line_sizes) const;
+
+private:
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    explicit LineByteIndex(NodePtr root) : Root(std::move(root)) {}
+
+    static NodePtr Make(u32 bytes, NodePtr left, NodePtr right);
+    static NodePtr Build(const std::vector<u32> &line_sizes, u32 begin, u32 end);
+    // Split into the first `count` lines and the rest.
+    static std::pair<NodePtr, NodePtr> Split(const NodePtr &, u32 count);
+    static NodePtr Merge(NodePtr left, NodePtr right);
+
+    NodePtr Root;
+};
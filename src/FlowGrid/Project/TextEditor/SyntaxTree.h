@@ -1,12 +1,20 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
 #include <ranges>
+#include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include "nlohmann/json.hpp"
+#include <immer/algorithm.hpp>
+#include <immer/flex_vector.hpp>
 #include <tree_sitter/api.h>
 
 #include "Application/ApplicationPreferences.h"
@@ -398,30 +406,76 @@ struct TextInputEdit {
     }
 };
 
+// The text lines fed to the parser. Immutable, so the parser can read a snapshot on its own thread while the buffer keeps changing.
+using SyntaxTextLines = immer::flex_vector<immer::flex_vector<char>>;
+
+/**
+Parses text and computes highlight capture transitions on a background thread, so edits never wait on tree-sitter.
+
+The UI thread posts each committed text snapshot along with its edits, and keeps rendering the previous tree and highlights
+until `ApplyParseResult` swaps in the new ones.
+Only the latest snapshot is parsed: Jobs posted while the worker is busy are merged into a single pending job.
+The worker owns its own parser, tree, and query cursor, and publishes a copy of each new tree, since tree-sitter trees aren't thread-safe.
+*/
 struct SyntaxTree {
-    // todo take language
-    SyntaxTree(TSInput input) : Input(input), Parser(ts_parser_new()) {}
+    SyntaxTree() : Parser(ts_parser_new()), QueryCursor(ts_query_cursor_new()), Worker([this] { Run(); }) {
+        ts_parser_set_cancellation_flag(Parser, &CancelParse);
+    }
     ~SyntaxTree() {
-        if (QueryCursor) ts_query_cursor_delete(QueryCursor);
-        if (Parser) ts_parser_delete(Parser);
+        {
+            std::lock_guard lock{Mutex};
+            Running = false;
+        }
+        std::atomic_ref{CancelParse}.store(1); // Stop any parse in progress, rather than waiting for it to finish.
+        JobChanged.notify_one();
+        Worker.join();
+
+        if (LatestResult && LatestResult->Tree) ts_tree_delete(LatestResult->Tree);
+        if (ParseTree) ts_tree_delete(ParseTree);
         if (Tree) ts_tree_delete(Tree);
+        ts_query_cursor_delete(QueryCursor);
+        ts_parser_delete(Parser);
     }
 
-    // Apply edits to the TS tree, re-parse, update highlight state.
-    void ApplyEdits(const std::vector<TextInputEdit> &edits) {
-        ChangedCaptureRanges.clear(); // For debugging
-        if (edits.empty()) return;
-
-        if (Tree != nullptr) {
-            for (const auto &edit : edits) {
-                const TSInputEdit ts_edit{.start_byte = edit.StartByte, .old_end_byte = edit.OldEndByte, .new_end_byte = edit.NewEndByte};
-                ts_tree_edit(Tree, &ts_edit);
+    // UI thread: Request a re-parse of `text`, which is the previously posted text after applying `edits`.
+    void ApplyEdits(const SyntaxTextLines &text, const std::vector<TextInputEdit> &edits) {
+        if (edits.empty() && !ResetPending) return;
+
+        {
+            std::lock_guard lock{Mutex};
+            if (!PendingJob) PendingJob.emplace();
+            PendingJob->Text = text;
+            PendingJob->Edits.insert(PendingJob->Edits.end(), edits.begin(), edits.end());
+            PendingJob->LanguageGeneration = LanguageGeneration;
+            if (ResetPending) {
+                PendingJob->Reset = true;
+                PendingJob->Language = Language;
+                PendingJob->Query = Query;
             }
         }
+        ResetPending = false;
+        JobChanged.notify_one();
+    }
+
+    // UI thread: Swap in the tree and highlights of the latest finished parse, if any.
+    // Returns `true` if they changed.
+    bool ApplyParseResult() {
+        std::optional<ParseResult> result;
+        {
+            std::lock_guard lock{Mutex};
+            result.swap(LatestResult);
+        }
+        if (!result) return false;
+        if (result->LanguageGeneration != LanguageGeneration) { // Parsed with a previous language.
+            if (result->Tree) ts_tree_delete(result->Tree);
+            return false;
+        }
 
-        // const auto *old_tree = Tree; // Partial updating is not fully working yet.
-        Tree = ts_parser_parse(Parser, Tree, Input);
-        UpdateCaptureIdTransitions(edits, nullptr);
+        if (Tree) ts_tree_delete(Tree);
+        Tree = result->Tree;
+        CaptureIdTransitions = std::move(result->CaptureIdTransitions);
+        ChangedCaptureRanges = std::move(result->ChangedCaptureRanges);
+        return true;
     }
 
     void SetLanguage(LanguageID language_id) {
@@ -432,7 +486,7 @@ struct SyntaxTree {
             Config = {};
         }
         const auto &language = Languages.Get(language_id);
-        ts_parser_set_language(Parser, language.TsLanguage);
+        Language = language.TsLanguage;
         Query = language.GetQuery();
         const u32 capture_count = ts_query_capture_count(Query);
         StyleByCaptureId.clear();
@@ -444,12 +498,18 @@ struct SyntaxTree {
             StyleByCaptureId[i] = Config.FindStyleByCaptureName(std::string(capture_name, length));
         }
 
+        // The next posted job re-parses from scratch with the new language.
+        ++LanguageGeneration;
+        ResetPending = true;
+        if (Tree) ts_tree_delete(Tree);
         Tree = nullptr;
-        QueryCursor = ts_query_cursor_new();
         CaptureIdTransitions.clear();
+        ChangedCaptureRanges.clear();
     }
 
     std::string GetSExp() const {
+        if (!Tree) return "";
+
         char *c_string = ts_node_string(ts_tree_root_node(Tree));
         std::string s_expression(c_string);
         free(c_string);
@@ -457,6 +517,8 @@ struct SyntaxTree {
     }
 
     SyntaxNodeAncestry GetNodeAncestryAtByte(u32 byte_index) const {
+        if (!Tree) return {};
+
         auto cursor = ts_tree_cursor_new(ts_tree_root_node(Tree));
         std::vector<SyntaxNode> ancestors;
         ID id = 0;
@@ -473,38 +535,130 @@ struct SyntaxTree {
 
     inline static u32 NoneCaptureId{u32(-1)}; // Corresponds to the default style.
 
-    TSInput Input;
+    // Only accessed on the UI thread.
+    // `Tree`, `CaptureIdTransitions`, and `ChangedCaptureRanges` are from the latest applied parse result.
     TSConfig Config;
+    TSLanguage *Language{nullptr};
+    TSQuery *Query{nullptr}; // Immutable once created, so it's shared with the worker.
     TSTree *Tree{nullptr};
-    TSParser *Parser{nullptr};
-    TSQuery *Query{nullptr};
-    TSQueryCursor *QueryCursor{nullptr};
     std::unordered_map<u32, TextEditorCharStyle> StyleByCaptureId{};
     ByteTransitions<u32> CaptureIdTransitions{NoneCaptureId};
     std::set<ByteRange> ChangedCaptureRanges{}; // For debugging.
 
 private:
+    struct ParseJob {
+        SyntaxTextLines Text;
+        std::vector<TextInputEdit> Edits{}; // All edits since the previous job.
+        bool Reset{false}; // Discard the previous tree and switch to `Language` and `Query`.
+        TSLanguage *Language{nullptr};
+        TSQuery *Query{nullptr};
+        u32 LanguageGeneration{0};
+    };
+
+    struct ParseResult {
+        u32 LanguageGeneration;
+        TSTree *Tree; // Owned by the receiver.
+        ByteTransitions<u32> CaptureIdTransitions;
+        std::set<ByteRange> ChangedCaptureRanges;
+    };
+
+    // Feeds tree-sitter a text snapshot, with a newline after each line.
+    // Hands out the snapshot's own (contiguous) leaf chunks without copying them. They live as long as the snapshot, which outlives the parse.
+    struct TextReader {
+        static const char *Read(void *payload, u32 byte_index, TSPoint position, u32 *bytes_read) {
+            (void)byte_index; // Unused.
+            static constexpr char Newline = '\n';
+            const auto &text = static_cast<const TextReader *>(payload)->Text;
+            *bytes_read = 0;
+            if (position.row >= text.size()) return nullptr;
+
+            const auto &line = text[position.row];
+            if (position.column >= line.size()) {
+                *bytes_read = 1;
+                return &Newline;
+            }
+
+            const char *chunk = nullptr;
+            immer::for_each_chunk_p(line.begin() + position.column, line.end(), [&](const char *begin, const char *end) {
+                chunk = begin;
+                *bytes_read = end - begin;
+                return false; // Only the first chunk.
+            });
+            return chunk;
+        }
+
+        const SyntaxTextLines &Text;
+    };
+
+    void Run() {
+        while (true) {
+            ParseJob job;
+            {
+                std::unique_lock lock{Mutex};
+                JobChanged.wait(lock, [this] { return !Running || PendingJob; });
+                if (!Running) return;
+
+                job = std::move(*PendingJob);
+                PendingJob.reset();
+            }
+
+            auto result = Parse(job);
+            std::lock_guard lock{Mutex};
+            if (LatestResult && LatestResult->Tree) ts_tree_delete(LatestResult->Tree); // Superseded before the UI thread applied it.
+            LatestResult = std::move(result);
+        }
+    }
+
+    // Worker thread: Apply the job's edits to the previous tree, re-parse, and update highlight state.
+    ParseResult Parse(const ParseJob &job) {
+        ParseChangedCaptureRanges.clear();
+        if (job.Reset) {
+            ts_parser_set_language(Parser, job.Language);
+            ParseQuery = job.Query;
+            if (ParseTree) ts_tree_delete(ParseTree);
+            ParseTree = nullptr;
+        } else if (ParseTree) {
+            for (const auto &edit : job.Edits) {
+                const TSInputEdit ts_edit{.start_byte = edit.StartByte, .old_end_byte = edit.OldEndByte, .new_end_byte = edit.NewEndByte};
+                ts_tree_edit(ParseTree, &ts_edit);
+            }
+        }
+
+        TextReader reader{job.Text};
+        auto *old_tree = ParseTree;
+        ParseTree = ts_parser_parse(Parser, old_tree, {&reader, TextReader::Read, TSInputEncodingUTF8});
+        // Partial updating is not fully working yet, so we don't pass the old tree.
+        UpdateCaptureIdTransitions(job.Edits, nullptr);
+        if (old_tree) ts_tree_delete(old_tree);
+
+        return {job.LanguageGeneration, ParseTree ? ts_tree_copy(ParseTree) : nullptr, ParseCaptureIdTransitions, ParseChangedCaptureRanges};
+    }
+
     /**
     Update capture ID transition points (used for highlighting) based on:
     - the provided `edits`
     - the `old_tree` before re-parsing after the edits
-    - the current `Tree` and `Query`
+    - the current `ParseTree` and `ParseQuery`
     If `old_tree != nullptr`, only transitions for the ranges that have changed are updated.
     Otherwise, the query is executed across the entire document and all capture transitions are added.
     TODO partial updating is not fully working yet.
     */
     void UpdateCaptureIdTransitions(const std::vector<TextInputEdit> &edits, const TSTree *old_tree = nullptr) {
-        if (edits.empty() || !Query || !Tree) return;
+        auto &transitions = ParseCaptureIdTransitions;
+        if (!ParseQuery || !ParseTree) {
+            transitions.clear();
+            return;
+        }
 
-        auto transition_it = CaptureIdTransitions.begin();
+        auto transition_it = transitions.begin();
 
         // Find the minimum range needed to span all nodes whose syntactic structure has changed.
         u32 num_changed_ranges = 0;
         if (old_tree == nullptr) {
-            CaptureIdTransitions.clear();
+            transitions.clear();
         } else {
             ByteRange changed_range = {UINT32_MAX, 0u};
-            const TSRange *changed_ranges = ts_tree_get_changed_ranges(old_tree, Tree, &num_changed_ranges);
+            const TSRange *changed_ranges = ts_tree_get_changed_ranges(old_tree, ParseTree, &num_changed_ranges);
             for (u32 i = 0; i < num_changed_ranges; ++i) {
                 changed_range.Start = std::min(changed_range.Start, changed_ranges[i].start_byte);
                 changed_range.End = std::max(changed_range.End, changed_ranges[i].end_byte);
@@ -520,27 +674,27 @@ private:
 
             // Adjust transitions based on the edited ranges, from the end to the start.
             const auto ordered_edits = std::set<TextInputEdit>(edits.begin(), edits.end());
-            if (CaptureIdTransitions.size() > 1) {
+            if (transitions.size() > 1) {
                 for (const auto &edit : reverse_view(ordered_edits)) {
                     const u32 inc_after_byte = edit.OldEndByte;
                     transition_it.MoveTo(inc_after_byte);
                     if (!transition_it.IsEnd()) {
                         if (transition_it.ByteIndex != inc_after_byte) ++transition_it;
-                        CaptureIdTransitions.Increment(transition_it, edit.NewEndByte - edit.OldEndByte);
+                        transitions.Increment(transition_it, edit.NewEndByte - edit.OldEndByte);
                     }
                 }
             }
             // Delete all transitions in deleted ranges.
             // xxx Not right in all cases. E.g. when deleting the first char of a node.
             for (const auto &edit : reverse_view(ordered_edits) | filter([](const auto &edit) { return edit.IsDelete(); })) {
-                CaptureIdTransitions.Delete(transition_it, edit.NewEndByte, edit.OldEndByte);
+                transitions.Delete(transition_it, edit.NewEndByte, edit.OldEndByte);
             }
         }
 
         if (old_tree == nullptr || num_changed_ranges > 0) {
             // Either this is the first parse, or the edit(s) affect existing node captures.
             // Execute the query and add all capture transitions.
-            ts_query_cursor_exec(QueryCursor, Query, ts_tree_root_node(Tree));
+            ts_query_cursor_exec(QueryCursor, ParseQuery, ts_tree_root_node(ParseTree));
 
             TSQueryMatch match;
             u32 capture_index;
@@ -553,19 +707,41 @@ private:
 
                 // Delete invalidated transitions and insert new ones.
                 const auto node_byte_range = ToByteRange(node);
-                ChangedCaptureRanges.insert(node_byte_range); // For debugging.
-                CaptureIdTransitions.Delete(transition_it, node_byte_range.Start, node_byte_range.End);
+                ParseChangedCaptureRanges.insert(node_byte_range); // For debugging.
+                transitions.Delete(transition_it, node_byte_range.Start, node_byte_range.End);
                 if (*transition_it != capture.index) {
                     // u32 length;
-                    // const char *capture_name = ts_query_capture_name_for_id(Query, capture.index, &length);
+                    // const char *capture_name = ts_query_capture_name_for_id(ParseQuery, capture.index, &length);
                     // std::println("\t'{}'[{}:{}]: {}", ts_node_type(node), node_byte_range.Start, node_byte_range.End, string(capture_name, length));
-                    CaptureIdTransitions.Insert(transition_it, node_byte_range.Start, capture.index);
-                    CaptureIdTransitions.Insert(transition_it, node_byte_range.End, NoneCaptureId);
+                    transitions.Insert(transition_it, node_byte_range.Start, capture.index);
+                    transitions.Insert(transition_it, node_byte_range.End, NoneCaptureId);
                 }
             }
         }
 
         // Cleanup: Delete all transitions beyond the new text range.
-        CaptureIdTransitions.Delete(transition_it, ts_node_end_byte(ts_tree_root_node(Tree)), UINT32_MAX);
+        transitions.Delete(transition_it, ts_node_end_byte(ts_tree_root_node(ParseTree)), UINT32_MAX);
     }
+
+    std::mutex Mutex; // Guards `PendingJob`, `LatestResult`, and `Running`.
+    std::condition_variable JobChanged;
+    std::optional<ParseJob> PendingJob;
+    std::optional<ParseResult> LatestResult;
+    bool Running{true};
+
+    // Only accessed on the UI thread.
+    u32 LanguageGeneration{0}; // Incremented on each language change, to drop results parsed with a previous language.
+    bool ResetPending{false};
+
+    size_t CancelParse{0}; // Tree-sitter's cancellation flag, read atomically by the parser.
+
+    // Only accessed on the worker thread.
+    TSParser *Parser{nullptr};
+    TSQueryCursor *QueryCursor{nullptr};
+    TSQuery *ParseQuery{nullptr};
+    TSTree *ParseTree{nullptr};
+    ByteTransitions<u32> ParseCaptureIdTransitions{NoneCaptureId};
+    std::set<ByteRange> ParseChangedCaptureRanges{};
+
+    std::thread Worker; // Last, so it starts after (and stops before destroying) everything it uses.
 };
@@ -2,10 +2,10 @@
 
 #include <algorithm>
 #include <array>
+#include <charconv>
 #include <filesystem>
 #include <map>
 #include <print>
-#include <range/v3/numeric/accumulate.hpp>
 #include <range/v3/range/conversion.hpp>
 #include <range/v3/view/filter.hpp>
 #include <range/v3/view/join.hpp>
@@ -16,9 +16,9 @@
 #include <vector>
 
 #include "imgui_internal.h"
+#include <immer/algorithm.hpp>
 #include <immer/flex_vector.hpp>
 #include <immer/flex_vector_transient.hpp>
-#include <immer/vector.hpp>
 
 #include "Application/ApplicationPreferences.h"
 #include "Core/Windows.h"
@@ -29,6 +29,7 @@
 #include "UI/Fonts.h"
 
 #include "LanguageID.h"
+#include "LineByteIndex.h"
 #include "SyntaxTree.h"
 #include "TextBufferPaletteId.h"
 
@@ -55,8 +56,6 @@ enum class PaletteIndex {
     Max
 };
 
-const char *TSReadText(void *payload, u32 byte_index, TSPoint position, u32 *bytes_read);
-
 // https://en.wikipedia.org/wiki/UTF-8
 // We assume that the char is a standalone character (<128) or a leading byte of an UTF-8 code sequence (non-10xxxxxx code)
 static u32 UTF8CharLength(char ch) {
@@ -90,13 +89,13 @@ static float Distance(const ImVec2 &a, const ImVec2 &b) {
 
 struct TextBufferImpl {
     TextBufferImpl(std::string_view text, LanguageID language_id)
-        : Syntax(std::make_unique<SyntaxTree>(TSInput{this, TSReadText, TSInputEncodingUTF8})) {
+        : Syntax(std::make_unique<SyntaxTree>()) {
         SetLanguage(language_id);
         SetText(string(text));
         Commit();
     }
     TextBufferImpl(const fs::path &file_path)
-        : Syntax(std::make_unique<SyntaxTree>(TSInput{this, TSReadText, TSInputEncodingUTF8})) {
+        : Syntax(std::make_unique<SyntaxTree>()) {
         OpenFile(file_path);
         Commit();
     }
@@ -458,7 +457,32 @@ struct TextBufferImpl {
         return result;
     }
 
-    std::string GetText() const { return GetText(BeginLC(), EndLC()); }
+    // The whole text, flattened once and cached until the next edit.
+    // The reference is invalidated by `ApplyEdits`, which clears the cache.
+    const string &GetText() const {
+        if (!FlatText) {
+            string text;
+            text.reserve(EndByteIndex());
+            ForEachTextChunk([&text](string_view chunk) { text += chunk; });
+            const u64 hash = std::hash<string_view>{}(text);
+            FlatText = {std::move(text), hash};
+        }
+        return FlatText->Text;
+    }
+    u64 GetTextHash() const {
+        GetText();
+        return FlatText->Hash;
+    }
+
+    // Visit the whole text in order as contiguous chunks, without copying. Lines are separated by "\n" chunks.
+    void ForEachTextChunk(auto &&fn) const {
+        bool first_line = true;
+        for (const auto &line : Text) {
+            if (!first_line) fn(string_view{"\n"});
+            first_line = false;
+            immer::for_each_chunk(line, [&fn](const char *begin, const char *end) { fn(string_view{begin, end}); });
+        }
+    }
 
     string GetSyntaxTreeSExp() const { return Syntax->GetSExp(); }
 
@@ -479,18 +503,22 @@ struct TextBufferImpl {
         const u32 old_end_byte = EndByteIndex();
         TransientLines transient_lines{};
         TransientLine current_line{};
+        std::vector<u32> line_sizes;
         for (auto ch : text) {
             if (ch == '\r') continue; // Ignore the carriage return character.
             if (ch == '\n') {
+                line_sizes.push_back(current_line.size());
                 transient_lines.push_back(current_line.persistent());
                 current_line = {};
             } else {
                 current_line.push_back(ch);
             }
         }
+        line_sizes.push_back(current_line.size());
         transient_lines.push_back(current_line.persistent());
         Text = transient_lines.persistent();
-        History = {};
+        LineBytes = LineByteIndex{line_sizes};
+        History.clear();
         HistoryIndex = -1;
 
         Edits.emplace_back(0, old_end_byte, EndByteIndex());
@@ -585,32 +613,58 @@ struct TextBufferImpl {
     void ToggleOverwrite() { Overwrite ^= true; } // todo use Bool prop
 
     bool CanUndo() const { return !ReadOnly && HistoryIndex > 0; }
-    bool CanRedo() const { return !ReadOnly && History.size() > 1 && HistoryIndex < u32(History.size() - 1); }
+    bool CanRedo() const { return !ReadOnly && HistoryIndex + 1 < History.size(); }
     bool CanCopy() const { return Cursors.AnyRanged(); }
     bool CanCut() const { return !ReadOnly && CanCopy(); }
     bool CanPaste() const { return !ReadOnly && ImGui::GetClipboardText() != nullptr; }
 
     void Undo() {
-        if (!CanUndo()) return;
-
-        const auto &current = History[HistoryIndex];
-        const auto restore = History[--HistoryIndex];
-        Text = restore.Text;
-        Cursors = current.BeforeCursors;
-        Cursors.MarkEdited();
-        assert(Edits.empty());
-        for (const auto &edit : reverse_view(current.Edits)) Edits.push_back(edit.Invert());
-        ApplyEdits();
+        if (CanUndo()) SetHistoryIndex(HistoryIndex - 1);
     }
     void Redo() {
-        if (!CanRedo()) return;
+        if (CanRedo()) SetHistoryIndex(HistoryIndex + 1);
+    }
+
+    u32 GetHistorySize() const { return History.size(); }
+    // Checkpoints share structure with the text, so they aren't counted.
+    u64 GetHistoryByteSize() const {
+        u64 byte_size = History.capacity() * sizeof(HistoryRecord);
+        for (const auto &record : History) {
+            byte_size += record.Ops.capacity() * sizeof(TextOp) + (record.BeforeCursors.size() + record.Cursors.size()) * sizeof(Cursor);
+            for (const auto &op : record.Ops) {
+                for (const auto &line : op.Removed) byte_size += line.size();
+                for (const auto &line : op.Inserted) byte_size += line.size();
+            }
+        }
+        return byte_size;
+    }
+
+    // Step through the history records' operations to reach the state after record `index`,
+    // starting from the nearest checkpoint at or before `index` if that takes fewer steps.
+    void SetHistoryIndex(u32 index) {
+        if (index == HistoryIndex || index >= History.size()) return;
 
-        const auto restore = History[++HistoryIndex];
-        Text = restore.Text;
-        Cursors = restore.Cursors;
-        Cursors.MarkEdited();
         assert(Edits.empty());
-        Edits = restore.Edits;
+        const bool undo = index < HistoryIndex;
+        const u32 checkpoint_index = index - index % CheckpointInterval;
+        if (index - checkpoint_index + 1 < (undo ? HistoryIndex - index : index - HistoryIndex)) {
+            const auto &checkpoint = *History[checkpoint_index].Checkpoint;
+            const u32 old_end_byte = EndByteIndex();
+            Text = checkpoint.Text;
+            LineBytes = checkpoint.LineBytes;
+            Edits.emplace_back(0, old_end_byte, EndByteIndex());
+            HistoryIndex = checkpoint_index;
+        }
+        for (; HistoryIndex > index; --HistoryIndex) {
+            for (const auto &op : reverse_view(History[HistoryIndex].Ops)) ApplyOp(op.Invert());
+        }
+        while (HistoryIndex < index) {
+            for (const auto &op : History[++HistoryIndex].Ops) ApplyOp(op);
+        }
+        Ops.clear();
+
+        Cursors = undo ? History[index + 1].BeforeCursors : History[index].Cursors;
+        Cursors.MarkEdited();
         ApplyEdits();
     }
 
@@ -839,19 +893,51 @@ struct TextBufferImpl {
     float LineSpacing{1};
 
 private:
-    // Commit a snapshot to the undo history, and edit the tree (see `EditTree`).
+    // Commit the pending operations to the undo history, and edit the tree (see `EditTree`).
     // **Every `Commit` should be paired with a `BeforeCursors = Cursors`.**
     void Commit() {
         if (Edits.empty()) return;
 
-        History = History.take(++HistoryIndex);
-        History = History.push_back({Text, Cursors, BeforeCursors, Edits});
+        const auto now = Clock::now();
+        if (CanCoalesce(now)) {
+            auto &record = History[HistoryIndex];
+            record.Ops.insert(record.Ops.end(), Ops.begin(), Ops.end());
+            record.Cursors = Cursors;
+            record.Time = now;
+            if (record.Checkpoint) record.Checkpoint = TextCheckpoint{Text, LineBytes};
+        } else {
+            History.erase(History.begin() + ++HistoryIndex, History.end());
+            std::optional<TextCheckpoint> checkpoint;
+            if (HistoryIndex % CheckpointInterval == 0) checkpoint = TextCheckpoint{Text, LineBytes};
+            History.push_back({std::move(Ops), BeforeCursors, Cursors, now, std::move(checkpoint)});
+        }
+        Ops.clear();
         ApplyEdits();
     }
 
+    // Consecutive typing is merged into the previous record, so it's undone in one step.
+    // Typing coalesces while the cursors stay where the previous record left them, until a pause or the start of a new word.
+    bool CanCoalesce(TimePoint now) const {
+        static const auto IsTyping = [](const TextOp &op) { return op.Removed.empty() && op.Inserted.size() == 1 && !op.Inserted[0].empty(); };
+
+        if (Ops.empty() || History.empty() || HistoryIndex == 0 || HistoryIndex + 1 != History.size()) return false;
+
+        const auto &record = History[HistoryIndex];
+        if (now - record.Time > CoalesceTime || record.Ops.empty() || !all_of(record.Ops, IsTyping) || !all_of(Ops, IsTyping)) return false;
+        if (IsWordChar(Ops.front().Inserted[0].front()) && !IsWordChar(record.Ops.back().Inserted[0].back())) return false;
+        return std::ranges::equal(record.Cursors, BeforeCursors, [](const auto &a, const auto &b) { return a.GetStart() == b.GetStart() && a.GetEnd() == b.GetEnd(); });
+    }
+
+    void ApplyOp(const TextOp &op) {
+        if (!op.Removed.empty()) DeleteRange(op.Start, TextEndLC(op.Start, op.Removed), false);
+        if (!op.Inserted.empty()) InsertText(op.Inserted, op.Start, false);
+    }
+
     void ApplyEdits() {
-        Syntax->ApplyEdits(Edits);
+        Syntax->ApplyEdits(Text, Edits);
         Edits.clear();
+        BracketMatchCursor.reset();
+        FlatText.reset();
     }
 
     std::string GetSelectedText(const Cursor &c) const { return GetText(c.Min(), c.Max()); }
@@ -868,7 +954,7 @@ private:
     LineChar ToLineChar(Coords coords) const { return {coords.L, GetCharIndex(std::move(coords))}; }
     u32 ToByteIndex(LineChar lc) const {
         if (lc.L >= Text.size()) return EndByteIndex();
-        return ranges::accumulate(subrange(Text.begin(), Text.begin() + lc.L), 0u, [](u32 sum, const auto &line) { return sum + line.size() + 1; }) + lc.C;
+        return LineBytes.StartByte(lc.L) + lc.C;
     }
 
     void MoveCharIndexAndColumn(const Line &line, u32 &ci, u32 &column) const {
@@ -1008,6 +1094,19 @@ private:
         return {};
     }
 
+    // Brackets are only highlighted for a single cursor.
+    // The match is cached until the cursor moves or the text changes, rather than searched for on every render.
+    std::optional<Cursor> GetMatchingBrackets() {
+        if (Cursors.size() != 1) return {};
+
+        const auto &c = Cursors.front();
+        if (!BracketMatchCursor || BracketMatchCursor->GetStart() != c.GetStart() || BracketMatchCursor->GetEnd() != c.GetEnd()) {
+            BracketMatchCursor = Cursor{c.GetStart(), c.GetEnd()};
+            MatchingBrackets = FindMatchingBrackets(c);
+        }
+        return MatchingBrackets;
+    }
+
     u32 NumStartingSpaceColumns(u32 li) const {
         const auto &line = Text[li];
         u32 column = 0;
@@ -1024,6 +1123,13 @@ private:
         else DeleteRange({li2, u32(Text[li2].size())}, EndLC(), false);
     }
 
+    // Update the line byte index after replacing lines [begin, end) with the `count` lines now starting at `begin`.
+    void UpdateLineBytes(u32 begin, u32 end, u32 count) {
+        std::vector<u32> line_sizes(count);
+        for (u32 i = 0; i < count; ++i) line_sizes[i] = Text[begin + i].size();
+        LineBytes = LineBytes.Splice(begin, end, line_sizes);
+    }
+
     // Returns insertion end.
     LineChar InsertText(Lines text, LineChar at, bool update_cursors = true) {
         if (text.empty()) return at;
@@ -1034,8 +1140,11 @@ private:
             Text = Text.take(at.L + 1) + text.drop(1) + Text.drop(at.L + 1);
             auto ln2 = Text[at.L + text.size() - 1];
             Text = Text.set(at.L + text.size() - 1, ln2 + ln1.drop(at.C));
+            UpdateLineBytes(at.L, at.L + 1, text.size());
         } else {
+            const u32 end_li = Text.size();
             Text = Text + text;
+            UpdateLineBytes(end_li, end_li, text.size());
         }
 
         const u32 num_new_lines = text.size() - 1;
@@ -1044,11 +1153,17 @@ private:
             for (auto &c : cursors_below) c.Set({c.Line() + num_new_lines, c.CharIndex()});
         }
 
+        Ops.push_back({at, {}, text});
         const u32 start_byte = ToByteIndex(at);
         const u32 text_byte_length = std::accumulate(text.begin(), text.end(), 0, [](u32 sum, const auto &line) { return sum + line.size(); }) + text.size() - 1;
         Edits.emplace_back(start_byte, start_byte, start_byte + text_byte_length);
 
-        return LineChar{at.L + num_new_lines, text.size() == 1 ? u32(at.C + text.front().size()) : u32(text.back().size())};
+        return TextEndLC(at, text);
+    }
+
+    // The end of `text` if it were inserted at `at`.
+    static LineChar TextEndLC(LineChar at, const Lines &text) {
+        return LineChar{at.L + u32(text.size()) - 1, text.size() == 1 ? u32(at.C + text.front().size()) : u32(text.back().size())};
     }
 
     void InsertTextAtCursor(Lines text, Cursor &c) {
@@ -1060,8 +1175,12 @@ private:
 
         auto start_line = Text[start.L], end_line = Text[end.L];
         const u32 start_byte = ToByteIndex(start), old_end_byte = ToByteIndex(end);
+        auto removed = Text.drop(start.L).take(end.L - start.L + 1);
+        removed = removed.set(removed.size() - 1, removed.back().take(end.C));
+        Ops.push_back({start, removed.set(0, removed.front().drop(start.C)), {}});
         if (start.L == end.L) {
             Text = Text.set(start.L, start_line.erase(start.C, end.C));
+            UpdateLineBytes(start.L, start.L + 1, 1);
 
             if (update_cursors) {
                 auto cursors_to_right = Cursors | filter([&start](const auto &c) { return !c.IsRange() && c.IsRightOf(start); });
@@ -1072,6 +1191,7 @@ private:
             Text = Text.set(end.L, end_line);
             Text = Text.set(start.L, start_line.take(start.C) + end_line);
             Text = Text.erase(start.L + 1, end.L + 1);
+            UpdateLineBytes(start.L, end.L + 1, 1);
 
             if (update_cursors) {
                 auto cursors_below = Cursors | filter([&](const auto &c) { return (!exclude_cursor || c != *exclude_cursor) && c.Line() >= end.L; });
@@ -1112,9 +1232,19 @@ private:
     }
 
     Lines Text{Line{}};
+    LineByteIndex LineBytes{std::vector<u32>{0}}; // Sizes of `Text` lines, for byte index conversion.
     Cursors Cursors, BeforeCursors;
     std::vector<TextInputEdit> Edits{};
 
+    // An insertion or deletion, with the text it inserted or removed, so it can be applied in either direction.
+    struct TextOp {
+        LineChar Start;
+        Lines Removed, Inserted; // Only one is non-empty.
+
+        TextOp Invert() const { return {Start, Inserted, Removed}; }
+    };
+    std::vector<TextOp> Ops{}; // Uncommitted operations.
+
     TextBufferPaletteId PaletteId{DefaultPaletteId};
     LanguageID LanguageId{LanguageID::None};
 
@@ -1127,44 +1257,37 @@ private:
     float LastClickTime{-1}; // ImGui time.
     std::unique_ptr<SyntaxNodeAncestry> HoveredNode{};
     std::unique_ptr<SyntaxTree> Syntax;
+    std::optional<Cursor> BracketMatchCursor{}, MatchingBrackets{}; // See `GetMatchingBrackets`.
 
-    struct Snapshot {
+    struct FlattenedText {
+        string Text;
+        u64 Hash;
+    };
+    mutable std::optional<FlattenedText> FlatText{}; // See `GetText`.
+
+    inline static const u32 CheckpointInterval = 64; // Every this many history records (starting with the first) holds a checkpoint.
+    inline static const auto CoalesceTime = 1s;
+
+    struct TextCheckpoint {
         Lines Text;
-        struct Cursors Cursors, BeforeCursors;
-        // If immer flex vectors provided a diff mechanism like its map does,
-        // we wouldn't need this, and we could compute diffs across any two arbitrary snapshots.
-        std::vector<TextInputEdit> Edits;
+        LineByteIndex LineBytes;
+    };
+
+    // The operations of one commit (or of a run of coalesced typing commits),
+    // and the cursors before and after.
+    struct HistoryRecord {
+        std::vector<TextOp> Ops;
+        struct Cursors BeforeCursors, Cursors;
+        TimePoint Time;
+        std::optional<TextCheckpoint> Checkpoint{}; // The text after this record's operations.
     };
 
     // The first history record is the initial state (after construction), and it's never removed from the history.
-    immer::vector<Snapshot> History;
+    // It has no operations, and its checkpoint holds the initial text.
+    std::vector<HistoryRecord> History;
     u32 HistoryIndex{0};
 };
 
-const char *TSReadText(void *payload, u32 byte_index, TSPoint position, u32 *bytes_read) {
-    (void)byte_index; // Unused.
-    static const char newline = '\n';
-
-    const auto *buffer = static_cast<TextBufferImpl *>(payload);
-    if (position.row >= buffer->LineCount()) {
-        *bytes_read = 0;
-        return nullptr;
-    }
-    const auto &line = buffer->GetLine(position.row);
-    if (position.column > line.size()) { // Sanity check - shouldn't happen.
-        *bytes_read = 0;
-        return nullptr;
-    }
-    if (position.column == line.size()) {
-        *bytes_read = 1;
-        return &newline;
-    }
-
-    // Read until the end of the line.
-    *bytes_read = line.size() - position.column;
-    return &line.front() + position.column;
-}
-
 TextBuffer::TextBuffer(ArgsT &&args, const ::FileDialog &file_dialog, const fs::path &file_path)
     : ActionableComponent(std::move(args)), FileDialog(file_dialog), _LastOpenedFilePath(file_path),
       Impl(std::make_unique<TextBufferImpl>(file_path)) {}
@@ -1273,8 +1396,11 @@ void TextBuffer::Apply(const ActionType &action) const {
     );
 }
 
-string TextBuffer::GetText() const { return Impl->GetText(); }
+const string &TextBuffer::GetText() const { return Impl->GetText(); }
+u64 TextBuffer::GetTextHash() const { return Impl->GetTextHash(); }
 bool TextBuffer::Empty() const { return Impl->Empty(); }
+u32 TextBuffer::GetHistorySize() const { return Impl->GetHistorySize(); }
+u64 TextBuffer::GetHistoryByteSize() const { return Impl->GetHistoryByteSize(); }
 
 static bool IsPressed(ImGuiKeyChord chord) {
     const auto window_id = ImGui::GetCurrentWindowRead()->ID;
@@ -1420,6 +1546,9 @@ void TextBufferImpl::HandleMouseInputs(ImVec2 char_advance, float text_start_x)
 void TextBufferImpl::Render(bool is_focused) {
     static constexpr float ScrollbarWidth = 14, LeftMargin = 10;
 
+    // Highlights from the previous parse are rendered until the background parse of the latest edits finishes.
+    Syntax->ApplyParseResult();
+
     const float font_size = GetFontSize();
     const float font_width = GetFont()->CalcTextSizeA(font_size, FLT_MAX, -1.0f, "#", nullptr, nullptr).x;
     const float font_height = GetTextLineHeightWithSpacing();
@@ -1441,6 +1570,23 @@ void TextBufferImpl::Render(bool is_focused) {
     u32 max_column = 0;
     auto dl = GetWindowDrawList();
     auto transition_it = Syntax->CaptureIdTransitions.begin();
+    const auto matching_brackets = GetMatchingBrackets();
+    // Consecutive glyphs with the same style are drawn as a single text run.
+    // A run is laid out with the font's own glyph advances, which only match the column grid for ASCII glyphs in the regular font.
+    // Other glyphs (multi-byte characters, which may fall back to other fonts, and bold/italic glyphs) are drawn one at a time, at their column.
+    string run_text;
+    ImVec2 run_pos;
+    const TextEditorCharStyle *run_style = nullptr;
+    u32 run_capture_id = 0;
+    bool run_is_grid_aligned = false;
+    const auto draw_run = [&] {
+        if (run_text.empty()) return;
+
+        const bool font_changed = Fonts::Push(FontFamily::Monospace, run_style->Font);
+        dl->AddText(run_pos, run_style->Color, run_text.data(), run_text.data() + run_text.size());
+        if (font_changed) Fonts::Pop();
+        run_text.clear();
+    };
     for (u32 li = first_visible_coords.L, byte_index = ToByteIndex({first_visible_coords.L, 0});
          li <= last_visible_coords.L && li < Text.size(); ++li) {
         const auto &line = Text[li];
@@ -1467,9 +1613,11 @@ void TextBufferImpl::Render(bool is_focused) {
         }
 
         if (ShowLineNumbers) {
-            // Draw line number (right aligned).
-            const string line_num_str = std::format("{}  ", li);
-            dl->AddText({text_screen_x - line_num_str.size() * font_width, line_start_screen_pos.y}, GetColor(PaletteIndex::LineNumber), line_num_str.c_str());
+            // Draw line number (right aligned, followed by two spaces).
+            char line_num[16];
+            const char *line_num_end = std::to_chars(line_num, line_num + sizeof(line_num), li).ptr;
+            const float line_num_width = (line_num_end - line_num + 2) * font_width;
+            dl->AddText({text_screen_x - line_num_width, line_start_screen_pos.y}, GetColor(PaletteIndex::LineNumber), line_num, line_num_end);
         }
 
         // Render cursors
@@ -1493,6 +1641,7 @@ void TextBufferImpl::Render(bool is_focused) {
             const char ch = line[lc.C];
             const u32 seq_length = UTF8CharLength(ch);
             if (ch == '\t') {
+                draw_run();
                 if (ShowWhitespaces) {
                     const float gap = font_size * (ShortTabs ? 0.16f : 0.2f);
                     const ImVec2 p1{glyph_pos + ImVec2{char_advance.x * 0.3f, font_height * 0.5f}};
@@ -1503,40 +1652,41 @@ void TextBufferImpl::Render(bool is_focused) {
                     dl->AddLine(p2, {p2.x - gap, p1.y + gap}, color);
                 }
             } else if (ch == ' ') {
+                draw_run();
                 if (ShowWhitespaces) {
                     dl->AddCircleFilled(glyph_pos + ImVec2{font_width, font_size} * 0.5f, 1.5f, GetColor(PaletteIndex::ControlCharacter), 4);
                 }
             } else {
-                if (seq_length == 1 && Cursors.size() == 1) {
-                    if (const auto matching_brackets = FindMatchingBrackets(Cursors.front())) {
-                        if (matching_brackets->GetStart() == lc || matching_brackets->GetEnd() == lc) {
-                            const ImVec2 start{glyph_pos + ImVec2{0, font_height + 1.0f}};
-                            dl->AddRectFilled(start, start + ImVec2{char_advance.x, 1.0f}, GetColor(PaletteIndex::Cursor));
-                        }
-                    }
+                if (matching_brackets && (matching_brackets->GetStart() == lc || matching_brackets->GetEnd() == lc)) {
+                    const ImVec2 start{glyph_pos + ImVec2{0, font_height + 1.0f}};
+                    dl->AddRectFilled(start, start + ImVec2{char_advance.x, 1.0f}, GetColor(PaletteIndex::Cursor));
                 }
-                // Render the current character.
-                const auto &char_style = Syntax->StyleByCaptureId.at(*transition_it);
-                const bool font_changed = Fonts::Push(FontFamily::Monospace, char_style.Font);
-                const char *seq_begin = &line[ci];
-                dl->AddText(glyph_pos, char_style.Color, seq_begin, seq_begin + seq_length);
-                if (font_changed) Fonts::Pop();
+                // Add the current character to the run, starting a new run if its style changed or it can't share a run.
+                if (const u32 capture_id = *transition_it; run_text.empty() || capture_id != run_capture_id || !run_is_grid_aligned || seq_length != 1) {
+                    draw_run();
+                    run_capture_id = capture_id;
+                    run_style = &Syntax->StyleByCaptureId.at(capture_id);
+                    run_pos = glyph_pos;
+                }
+                for (u32 i = 0; i < seq_length && ci + i < line.size(); ++i) run_text.push_back(line[ci + i]);
+                run_is_grid_aligned = seq_length == 1 && run_style->Font == FontStyle_Regular;
             }
             if (ShowStyleTransitionPoints && !transition_it.IsEnd() && transition_it.ByteIndex == byte_index) {
                 const auto color = SetAlpha(Syntax->StyleByCaptureId.at(*transition_it).Color, 40);
                 dl->AddRectFilled(glyph_pos, glyph_pos + char_advance, color);
             }
             if (ShowChangedCaptureRanges) {
+                // Ranges are ordered by start byte.
                 for (const auto &range : Syntax->ChangedCaptureRanges) {
-                    if (byte_index >= range.Start && byte_index < range.End) {
-                        dl->AddRectFilled(glyph_pos, glyph_pos + char_advance, Col32(255, 255, 255, 20));
-                    }
+                    if (range.Start > byte_index) break;
+                    if (byte_index < range.End) dl->AddRectFilled(glyph_pos, glyph_pos + char_advance, Col32(255, 255, 255, 20));
                 }
             }
             MoveCharIndexAndColumn(line, ci, column);
             byte_index += seq_length;
             transition_it.MoveForwardTo(byte_index);
         }
+        draw_run();
         byte_index = line_start_byte_index + line.size() + 1; // + 1 for the newline character.
     }
 
@@ -1585,10 +1735,10 @@ void TextBufferImpl::Render(bool is_focused) {
     }
 }
 
-static void DrawEdits(const std::vector<TextInputEdit> &edits) {
-    Text("Edits: %lu", edits.size());
-    for (const auto &edit : edits) {
-        BulletText("Start: %d, Old end: %d, New end: %d", edit.StartByte, edit.OldEndByte, edit.NewEndByte);
+static void DrawOps(const auto &ops) {
+    Text("Operations: %lu", ops.size());
+    for (const auto &op : ops) {
+        BulletText("Start: {%d, %d}, Removed lines: %lu, Inserted lines: %lu", op.Start.L, op.Start.C, op.Removed.size(), op.Inserted.size());
     }
 }
 
@@ -1606,7 +1756,10 @@ void TextBufferImpl::DebugPanel() {
     if (CollapsingHeader("History")) {
         ImGui::Text("Index: %u of %lu", HistoryIndex, History.size());
         for (size_t i = 0; i < History.size(); i++) {
-            if (CollapsingHeader(std::to_string(i).c_str())) DrawEdits(History[i].Edits);
+            if (CollapsingHeader(std::to_string(i).c_str())) {
+                if (History[i].Checkpoint) Text("Checkpoint");
+                DrawOps(History[i].Ops);
+            }
         }
     }
     if (CollapsingHeader("Tree-Sitter")) {
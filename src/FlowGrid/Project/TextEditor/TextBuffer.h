@@ -16,9 +16,15 @@ struct TextBuffer : ActionableComponent<Action::TextBuffer::Any> {
     void Apply(const ActionType &) const override;
     bool CanApply(const ActionType &) const override;
 
-    std::string GetText() const;
+    // Flattened once and cached until the next edit, which invalidates the returned reference. Copy the text to keep it.
+    const std::string &GetText() const;
+    u64 GetTextHash() const; // Hash of `GetText()`, for cheap change checks.
     bool Empty() const;
 
+    // Number of undo history records, and an estimate of the bytes they hold.
+    u32 GetHistorySize() const;
+    u64 GetHistoryByteSize() const;
+
     void Render() const override;
     void RenderMenu() const;
     void RenderDebug() const override;
@@ -17,7 +17,8 @@ void TextEditor::Apply(const ActionType &action) const { Buffer.Apply(action); }
 bool TextEditor::CanApply(const ActionType &action) const { return Buffer.CanApply(action); }
 
 bool TextEditor::Empty() const { return Buffer.Empty(); }
-string TextEditor::GetText() const { return Buffer.GetText(); }
+const string &TextEditor::GetText() const { return Buffer.GetText(); }
+u64 TextEditor::GetTextHash() const { return Buffer.GetTextHash(); }
 
 using namespace ImGui;
 
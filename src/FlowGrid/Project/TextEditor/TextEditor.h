@@ -15,7 +15,8 @@ struct TextEditor : ActionableComponent<Action::TextBuffer::Any> {
     void RenderDebug() const override;
 
     bool Empty() const;
-    std::string GetText() const;
+    const std::string &GetText() const; // See `TextBuffer::GetText`.
+    u64 GetTextHash() const;
 
     const FileDialog &FileDialog;
     fs::path _LastOpenedFilePath;
@@ -0,0 +1,194 @@
+// Headless offline renderer & benchmark for a project's audio graph.
+// Usage: flowgrid_render <project> <output.wav> [--seconds N] [--block-frames N] [--threads N]
+//
+// Loads the project without a UI or audio hardware, pulls the audio graph as fast as possible,
+// writes the graph output to a 32-bit float WAV file, and reports the real-time factor and per-node processing time.
+// `--threads` sets the number of threads processing independent graph branches (default: one per hardware thread).
+// The output is identical for any thread count.
+
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+
+#include "imgui.h"
+#include "implot.h"
+#include "miniaudio.h"
+
+#include "FlowGrid/Core/Primitive/PrimitiveActionQueuer.h"
+#include "FlowGrid/Core/Store/Store.h"
+#include "FlowGrid/Project/Audio/Device/AudioDevice.h"
+#include "FlowGrid/Project/Audio/Graph/ma_simd/ma_simd.h"
+#include "FlowGrid/Project/FileDialog/FileDialogImpl.h"
+#include "FlowGrid/Project/Project.h"
+
+FileDialogImpl FileDialogImp;
+
+using RenderClock = std::chrono::steady_clock;
+
+// Accumulates the time spent in each node's `onProcess` callback by swapping in an instrumented copy of its vtable.
+// Only measures each graph node's main `ma_node` (not inner helper nodes like splitters or channel converters).
+struct NodeTimer {
+    struct Timing {
+        std::string Name;
+        ma_node_vtable VTable;
+        const ma_node_vtable *OriginalVTable;
+        RenderClock::duration Total{};
+    };
+
+    NodeTimer(const AudioGraph &graph) {
+        for (const auto *node : graph.Nodes) {
+            auto *ma_node = node->Get();
+            if (!ma_node || TimingByNode.contains(ma_node)) continue;
+
+            auto *base = reinterpret_cast<ma_node_base *>(ma_node);
+            if (!base->vtable || !base->vtable->onProcess) continue;
+
+            auto &timing = TimingByNode[ma_node];
+            timing.Name = node->Name;
+            timing.OriginalVTable = base->vtable;
+            timing.VTable = *base->vtable;
+            timing.VTable.onProcess = OnProcess;
+            base->vtable = &timing.VTable;
+        }
+    }
+    ~NodeTimer() {
+        for (auto &[ma_node, timing] : TimingByNode) reinterpret_cast<ma_node_base *>(ma_node)->vtable = timing.OriginalVTable;
+    }
+
+    inline static std::unordered_map<ma_node *, Timing> TimingByNode;
+
+private:
+    static void OnProcess(ma_node *node, const float **frames_in, ma_uint32 *frame_count_in, float **frames_out, ma_uint32 *frame_count_out) {
+        auto &timing = TimingByNode.at(node);
+        const auto start = RenderClock::now();
+        timing.OriginalVTable->onProcess(node, frames_in, frame_count_in, frames_out, frame_count_out);
+        timing.Total += RenderClock::now() - start;
+    }
+};
+
+// `MA_NO_ENCODING` is defined, so we write the (trivial) IEEE float WAV header ourselves.
+static void WriteWav(const fs::path &path, const std::vector<float> &samples, u32 channels, u32 sample_rate) {
+    std::ofstream out{path, std::ios::binary};
+    if (!out) throw std::runtime_error(std::format("Could not open {} for writing.", path.string()));
+
+    const auto write = [&out](const auto &value) { out.write(reinterpret_cast<const char *>(&value), sizeof(value)); };
+    const u32 data_size = samples.size() * sizeof(float);
+    out.write("RIFF", 4);
+    write(u32(36 + data_size));
+    out.write("WAVEfmt ", 8);
+    write(u32(16)); // Format chunk size
+    write(u16(3)); // WAVE_FORMAT_IEEE_FLOAT
+    write(u16(channels));
+    write(u32(sample_rate));
+    write(u32(sample_rate * channels * sizeof(float))); // Byte rate
+    write(u16(channels * sizeof(float))); // Block align
+    write(u16(8 * sizeof(float))); // Bits per sample
+    out.write("data", 4);
+    write(data_size);
+    out.write(reinterpret_cast<const char *>(samples.data()), data_size);
+}
+
+static int Usage() {
+    std::cerr << "Usage: flowgrid_render <project> <output.wav> [--seconds N] [--block-frames N] [--threads N]\n";
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) return Usage();
+
+    const fs::path project_path = argv[1], output_path = argv[2];
+    float seconds = 10;
+    u32 block_frames = 512;
+    for (int i = 3; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) return Usage();
+        if (arg == "--seconds") seconds = std::stof(argv[++i]);
+        else if (arg == "--block-frames") block_frames = std::stoul(argv[++i]);
+        else if (arg == "--threads") AudioGraph::ProcessingThreadCount = std::stoul(argv[++i]);
+        else return Usage();
+    }
+    if (seconds <= 0 || block_frames == 0) return Usage();
+
+    // No devices are started, so the graph is only processed when we pull it.
+    AudioDevice::Offline = true;
+
+    // Some component refreshes touch ImGui/ImPlot state, so the contexts must exist even though nothing is rendered.
+    ImGui::CreateContext();
+    ImPlot::CreateContext();
+
+    Store store{};
+    ActionQueue<Action::Any> queue{};
+    ActionProducer<Action::Any>::EnqueueFn q = [&queue](auto &&a) -> bool { return queue.Enqueue(std::move(a)); };
+    ActionProducer<PrimitiveActionQueuer::ProducedActionType>::EnqueueFn primitive_q = [&queue](auto &&action) -> bool {
+        return std::visit([&queue](auto &&a) -> bool { return queue.Enqueue(std::move(a)); }, std::move(action));
+    };
+    PrimitiveActionQueuer primitive_queuer{primitive_q};
+    int exit_code = 0;
+    {
+        Project project{store, primitive_queuer, q};
+        store.Commit();
+        Component::RefreshAll();
+        project.OnApplicationLaunch();
+
+        // Fail rather than rendering the empty project if the project can't be opened.
+        // Checked after launch, since launching writes the empty project (to `.flowgrid/empty.fls`).
+        if (!GetProjectFormat(project_path) || !fs::is_regular_file(project_path)) {
+            std::cerr << std::format("Not a FlowGrid project file: {}\n", project_path.string());
+            exit_code = 1;
+        } else {
+            try {
+                queue.Enqueue(Action::Project::Open{fs::absolute(project_path).string()});
+                project.ApplyQueuedActions(queue, true);
+            } catch (const std::exception &e) {
+                std::cerr << std::format("Failed to open {}: {}\n", project_path.string(), e.what());
+                exit_code = 1;
+            }
+        }
+
+        if (exit_code == 0) {
+            // Wait for all Faust DSPs to finish compiling and hand them off to their graph nodes.
+            auto &faust_dsps = project.Audio.Faust.FaustDsps;
+            while (!faust_dsps.Compiler->IsIdle()) std::this_thread::sleep_for(10ms);
+            faust_dsps.ApplyCompileResults();
+            project.ApplyQueuedActions(queue, true);
+
+            auto &graph = project.Audio.Graph;
+            const u32 channels = 2; // The graph is always stereo.
+            const u32 sample_rate = graph.SampleRate;
+            const u32 total_frames = seconds * sample_rate;
+
+            std::vector<float> samples(u64(total_frames) * channels);
+            const auto render_start = RenderClock::now();
+            u32 block_count = 0;
+            {
+                NodeTimer node_timer{graph};
+                for (u32 frame = 0; frame < total_frames; frame += block_frames, block_count++) {
+                    graph.RenderOffline(samples.data() + u64(frame) * channels, std::min(block_frames, total_frames - frame));
+                }
+
+                const auto render_time = std::chrono::duration<double>(RenderClock::now() - render_start).count();
+                std::cout << std::format("Rendered {:.2f}s ({} frames @ {} Hz, {} blocks of {} frames) in {:.3f}s: {:.1f}x real-time\n", seconds, total_frames, sample_rate, block_count, block_frames, render_time, seconds / render_time);
+                std::cout << std::format("Kernels: {}, threads: {}\n", ma_simd_get_instruction_set_name(ma_simd_get_instruction_set()), graph.GetProcessingThreadCount());
+                for (const auto &[_, timing] : NodeTimer::TimingByNode) {
+                    const auto node_time = std::chrono::duration<double>(timing.Total).count();
+                    std::cout << std::format("  {:<32} {:>10.3f}ms total {:>8.2f}us/block {:>6.2f}%\n", timing.Name, node_time * 1e3, node_time * 1e6 / block_count, 100 * node_time / render_time);
+                }
+            }
+
+            try {
+                WriteWav(output_path, samples, channels, sample_rate);
+            } catch (const std::exception &e) {
+                std::cerr << e.what() << '\n';
+                exit_code = 1;
+            }
+        }
+    }
+
+    ImPlot::DestroyContext();
+    ImGui::DestroyContext();
+    return exit_code;
+}
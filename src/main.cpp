@@ -13,7 +13,9 @@ bool Tick(const Project &project, const UIContext &ui) {
     static auto &io = ImGui::GetIO();
 
     const bool running = ui.Tick(project);
-    if (running && io.WantSaveIniSettings) {
+    // Wait until mouse drags (moving/resizing windows, dragging splitters or table columns) finish,
+    // so each drag is captured once, as a single settings change.
+    if (running && io.WantSaveIniSettings && !ImGui::IsMouseDown(ImGuiMouseButton_Left)) {
         ImGui::SaveIniSettingsToMemory(); // Populate the `Settings` context members.
         if (auto patch = project.ImGuiSettings.CreatePatch(ImGui::GetCurrentContext()); !patch.Empty()) {
             project.Q(Action::Store::ApplyPatch{std::move(patch)});
@@ -0,0 +1,50 @@
+#include "Core/Container/AdjacencyList.h"
+
+#include "HeadlessProject.h"
+#include "Test.h"
+
+// Paths are found through the index, with cycles and self-loops, and stay correct as edges change.
+TEST(AdjacencyListHasPath) {
+    HeadlessProject project;
+    const auto &connections = project.Project->Audio.Graph.Connections;
+    connections.Erase();
+    connections.Connect(1, 2);
+    connections.Connect(2, 3);
+    connections.Connect(3, 2); // Cycle
+    connections.Connect(4, 4); // Self-loop
+
+    CHECK(connections.HasPath(1, 3));
+    CHECK(connections.HasPath(3, 2));
+    CHECK(!connections.HasPath(3, 1));
+    CHECK(connections.HasPath(4, 4));
+    CHECK(!connections.HasPath(4, 3));
+    CHECK_EQ(connections.SourceCount(2), 2u);
+    CHECK_EQ(connections.DestinationCount(4), 1u);
+
+    connections.Disconnect(2, 3);
+    CHECK(!connections.HasPath(1, 3));
+    connections.Connect(1, 3);
+    CHECK(connections.HasPath(1, 3));
+}
+
+BENCHMARK(AdjacencyListHasPath) {
+    static constexpr ID NodeCount = 2'000, SinkId = NodeCount;
+    HeadlessProject project;
+    const auto &connections = project.Project->Audio.Graph.Connections;
+    connections.Erase();
+    // A layered graph with about 4k edges, where every node reaches the sink.
+    for (ID id = 0; id < NodeCount; ++id) {
+        connections.Connect(id, id + 1);
+        if (id + 2 <= SinkId) connections.Connect(id, id + 2);
+    }
+
+    // As in `AudioGraph::UpdateConnections`, ask whether each node reaches the sink.
+    const auto check_all_paths = [&] {
+        for (ID id = 0; id < NodeCount; ++id) connections.HasPath(id, SinkId);
+    };
+    Bench("Check paths from 2k nodes (4k edges) to one sink, unchanged", 1'000, check_all_paths);
+    Bench("Toggle an edge and check paths from 2k nodes (4k edges) to one sink", 1'000, [&] {
+        connections.ToggleConnection(0, SinkId);
+        check_all_paths();
+    });
+}
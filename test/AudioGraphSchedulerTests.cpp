@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <ranges>
+#include <vector>
+
+#include "Project/Audio/Graph/AudioGraphReclaimer.h"
+#include "Project/Audio/Graph/AudioGraphScheduler.h"
+
+#include "Test.h"
+
+static constexpr u32 SampleRate = 48'000, BlockFrames = 480, Frames = 48'000;
+
+struct SineNode {
+    SineNode(ma_node_graph *graph, double frequency) {
+        const auto waveform_config = ma_waveform_config_init(ma_format_f32, 1, SampleRate, ma_waveform_type_sine, 0.25, frequency);
+        CHECK(ma_waveform_init(&waveform_config, &Waveform) == MA_SUCCESS);
+        const auto node_config = ma_data_source_node_config_init(&Waveform);
+        CHECK(ma_data_source_node_init(graph, &node_config, nullptr, &Node) == MA_SUCCESS);
+    }
+    ~SineNode() {
+        ma_data_source_node_uninit(&Node, nullptr);
+        ma_waveform_uninit(&Waveform);
+    }
+
+    ma_waveform Waveform;
+    ma_data_source_node Node;
+};
+
+// Render two sines summed at the graph endpoint. If `partition`, each sine is rendered in its own branch.
+// If `publish` is false, the branches are never handed to the scheduler (as if the plan weren't published yet),
+// so the main graph renders them as it reads them.
+static std::vector<float> RenderSines(u32 thread_count, bool partition, bool publish = true) {
+    ma_node_graph graph;
+    const auto graph_config = ma_node_graph_config_init(1);
+    CHECK(ma_node_graph_init(&graph_config, nullptr, &graph) == MA_SUCCESS);
+
+    std::vector<float> output(Frames);
+    {
+        AudioGraphReclaimer reclaimer;
+        std::vector<std::unique_ptr<AudioGraphBranch>> branches;
+        std::vector<std::unique_ptr<SineNode>> sines; // Detached from branch endpoints before the branches are destroyed.
+        for (const double frequency : {220.0, 331.0}) {
+            auto &sine = sines.emplace_back(std::make_unique<SineNode>(&graph, frequency));
+            if (partition) {
+                auto &branch = branches.emplace_back(std::make_unique<AudioGraphBranch>(&graph, 1));
+                ma_node_attach_output_bus(&sine->Node, 0, branch->GetEndpoint(), 0);
+                ma_node_attach_output_bus(branch->GetSource(), 0, ma_node_graph_get_endpoint(&graph), 0);
+            } else {
+                ma_node_attach_output_bus(&sine->Node, 0, ma_node_graph_get_endpoint(&graph), 0);
+            }
+        }
+
+        AudioGraphScheduler scheduler{thread_count, reclaimer};
+        if (publish) {
+            std::vector<AudioGraphBranch *> published;
+            for (auto &branch : branches) published.emplace_back(branch.get());
+            scheduler.SetBranches(std::move(published));
+        }
+        for (u32 frame = 0; frame < Frames; frame += BlockFrames) {
+            reclaimer.BeginRead();
+            CHECK_EQ(scheduler.Read(&graph, output.data() + frame, BlockFrames), u64(BlockFrames));
+            reclaimer.EndRead();
+        }
+        scheduler.SetBranches({});
+    }
+    ma_node_graph_uninit(&graph, nullptr);
+    return output;
+}
+
+// The partitioned graph's output is bit-identical to the unpartitioned graph's for any thread count.
+TEST(AudioGraphSchedulerPartitionedOutputIsBitIdentical) {
+    const auto reference = RenderSines(1, false);
+    CHECK(std::ranges::max(reference | std::views::transform([](float sample) { return std::abs(sample); })) > 0.25f);
+    for (const u32 thread_count : {1u, 2u, 4u}) CHECK(RenderSines(thread_count, true) == reference);
+}
+
+// A branch read before it's published renders on the reading thread, rather than outputting silence.
+TEST(AudioGraphSchedulerUnpublishedBranchIsNotSilent) {
+    CHECK(RenderSines(2, true, false) == RenderSines(1, false));
+}
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "Project/Audio/Graph/AudioGraph.h"
+
+#include "HeadlessProject.h"
+#include "Test.h"
+
+static ID FindNodeId(const AudioGraph &graph, const std::string &path_segment) {
+    const auto node_it = std::ranges::find_if(graph.Nodes, [&path_segment](const auto *node) { return node->PathSegment == path_segment; });
+    CHECK(node_it != graph.Nodes.end());
+    return (*node_it)->Id;
+}
+
+// Create, connect, and delete nodes, and recompile the Faust DSP (alternating channel counts, so its nodes are replaced),
+// while another thread reads the graph as a running device would.
+// The UI thread never waits on the reader, and never frees anything it may still reach. Run under TSan/ASan to check for races and use-after-frees.
+TEST(AudioGraphMutationsRaceReads) {
+    HeadlessProject project;
+    auto &graph = project.Project->Audio.Graph;
+    project.CompileFaustDsps();
+    const auto *faust_dsp = project.Project->Audio.Faust.FaustDsps.front();
+    const auto &code_buffer = faust_dsp->Editor.Buffer;
+    const std::string code = code_buffer.GetText();
+    const ID output_id = FindNodeId(graph, OutputDeviceNodeTypeId);
+    const u32 node_count = graph.Nodes.Size();
+
+    std::atomic<bool> running{true};
+    std::thread audio_thread{[&] {
+        std::vector<float> output(2 * 256);
+        while (running) graph.RenderOffline(output.data(), 256);
+    }};
+    for (u32 i = 0; i < 20; ++i) {
+        project.Apply(Action::AudioGraph::CreateFaustNode{faust_dsp->Id});
+        const ID faust_node_id = graph.Nodes.back()->Id;
+        project.Apply(Action::AudioGraph::CreateNode{WaveformNodeTypeId});
+        const ID waveform_node_id = graph.Nodes.back()->Id;
+        project.Apply(Action::AdjacencyList::ToggleConnection{graph.Connections.Path, waveform_node_id, faust_node_id});
+        project.Apply(Action::AdjacencyList::ToggleConnection{graph.Connections.Path, faust_node_id, output_id});
+
+        project.Apply(Action::TextBuffer::Set{code_buffer.Path, i % 2 == 0 ? "process = _ <: _, _;" : code});
+        project.CompileFaustDsps();
+
+        project.Apply(Action::AudioGraph::DeleteNode{waveform_node_id});
+        project.Apply(Action::AudioGraph::DeleteNode{faust_node_id});
+        graph.CollectRetired();
+    }
+    running = false;
+    audio_thread.join();
+
+    CHECK_EQ(graph.Nodes.Size(), node_count);
+}
+
+// Toggling one connection in a large graph only rewires the connection's source, rather than every node.
+TEST(AudioGraphConnectionToggleRewiresOnlyItsSource) {
+    AudioGraph::ProcessingThreadCount = 1; // Don't partition the graph into parallel branches, whose roots are rewired as the branches change.
+    HeadlessProject project;
+    AudioGraph::ProcessingThreadCount = 0;
+    auto &graph = project.Project->Audio.Graph;
+    project.CompileFaustDsps();
+    const ID dsp_id = project.Project->Audio.Faust.FaustDsps.front()->Id;
+    const auto toggle_connection = [&](ID source_id, ID destination_id) {
+        project.Apply(Action::AdjacencyList::ToggleConnection{graph.Connections.Path, source_id, destination_id});
+    };
+
+    // Chain 200 Faust nodes into the output device.
+    std::vector<ID> node_ids;
+    for (u32 i = 0; i < 200; ++i) {
+        project.Apply(Action::AudioGraph::CreateFaustNode{dsp_id});
+        node_ids.push_back(graph.Nodes.back()->Id);
+    }
+    node_ids.push_back(FindNodeId(graph, OutputDeviceNodeTypeId));
+    for (u32 i = 0; i + 1 < node_ids.size(); ++i) toggle_connection(node_ids[i], node_ids[i + 1]);
+
+    toggle_connection(node_ids[0], node_ids[2]); // Split the first node's output.
+    CHECK_EQ(graph.RewiredNodeCount, 1u);
+    toggle_connection(node_ids[0], node_ids[2]);
+    CHECK_EQ(graph.RewiredNodeCount, 1u);
+}
+
+// Toggling a connection in a graph of two long chains, each its own parallel branch, as the branches are found on every change.
+BENCHMARK(AudioGraphConnectionToggleWithParallelBranches) {
+    static constexpr u32 ChainLength = 250;
+    AudioGraph::ProcessingThreadCount = 4;
+    HeadlessProject project;
+    AudioGraph::ProcessingThreadCount = 0;
+    auto &graph = project.Project->Audio.Graph;
+    project.CompileFaustDsps();
+    const ID dsp_id = project.Project->Audio.Faust.FaustDsps.front()->Id;
+    const ID output_id = FindNodeId(graph, OutputDeviceNodeTypeId);
+    const auto toggle_connection = [&](ID source_id, ID destination_id) {
+        project.Apply(Action::AdjacencyList::ToggleConnection{graph.Connections.Path, source_id, destination_id});
+    };
+
+    std::vector<ID> chain_starts;
+    for (u32 chain = 0; chain < 2; ++chain) {
+        ID prev_id = output_id;
+        for (u32 i = 0; i < ChainLength; ++i) {
+            project.Apply(Action::AudioGraph::CreateFaustNode{dsp_id});
+            const ID node_id = graph.Nodes.back()->Id;
+            toggle_connection(node_id, prev_id);
+            prev_id = node_id;
+        }
+        chain_starts.push_back(prev_id);
+    }
+    // Each toggle splits, then joins, the first chain's head's output.
+    Bench("Toggle a connection in two 250-node parallel chains", 100, [&] { toggle_connection(chain_starts[0], output_id); });
+}
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <thread>
+
+#include "Helper/File.h"
+#include "Project/Audio/Faust/FaustCompiler.h"
+#include "Project/Audio/Sample.h" // Must be included before any Faust includes.
+#include "faust/dsp/dsp.h"
+
+#include "HeadlessProject.h"
+#include "Test.h"
+
+using namespace std::chrono_literals;
+
+// Points `FaustCompiler::CachePath` at `path` (starting empty) until destruction.
+struct CachePathGuard {
+    CachePathGuard(fs::path path) : Path(std::move(path)) {
+        fs::remove_all(Path);
+        FaustCompiler::CachePath = Path;
+    }
+    ~CachePathGuard() {
+        FaustCompiler::CachePath = Default;
+        std::error_code error;
+        fs::remove_all(Path, error);
+    }
+
+    const fs::path Default{FaustCompiler::CachePath}, Path;
+};
+
+// Request an immediate compile of `code` and wait for its result, deleting its DSP.
+static FaustCompileResult Compile(FaustCompiler &compiler, const std::string &code) {
+    compiler.Request(1, code, true);
+    FaustCompileResult result;
+    bool dequeued = false;
+    for (u32 i = 0; i < 3'000 && !(dequeued = compiler.TryDequeue(result)); ++i) std::this_thread::sleep_for(10ms);
+    CHECK(dequeued);
+    CHECK(result.ErrorMessage.empty());
+    CHECK(result.Dsp != nullptr);
+    delete result.Dsp;
+    result.Dsp = nullptr;
+    return result;
+}
+
+// The project's DSP code, changed so that the project's own compiler never caches it.
+static std::string GetDspCode(const HeadlessProject &project) {
+    return project.Project->Audio.Faust.FaustDsps.front()->Editor.Buffer.GetText() + "\n// Only compiled by tests";
+}
+
+// A cache hit reuses a factory (in memory, or machine code from disk) instead of creating one with `createDSPFactoryFromBoxes`.
+// Disk entries are only used if their stored key matches exactly.
+TEST(FaustCompilerCachesFactories) {
+    const CachePathGuard cache_path{fs::temp_directory_path() / "FlowGridFaustCacheTest"};
+    HeadlessProject project; // For the Faust lib context.
+    const auto code = GetDspCode(project);
+    {
+        FaustCompiler compiler;
+        const auto compiled = Compile(compiler, code);
+        CHECK(!compiled.CacheHit);
+        const auto cached = Compile(compiler, code);
+        CHECK(cached.CacheHit);
+        CHECK(cached.Factory == compiled.Factory);
+        CHECK(!Compile(compiler, code + "\n// Changed").CacheHit);
+    }
+    {
+        FaustCompiler compiler;
+        CHECK(Compile(compiler, code).CacheHit); // From disk.
+    }
+
+    // Entries with a different key (e.g. a hash collision) are misses.
+    for (const auto &entry : fs::directory_iterator(cache_path.Path)) {
+        if (entry.path().extension() == ".key") FileIO::write(entry.path(), "Another key");
+    }
+    FaustCompiler compiler;
+    CHECK(!Compile(compiler, code).CacheHit);
+}
+
+// Disk cache errors are misses, so compiling (and caching in memory) still works.
+TEST(FaustCompilerWorksWithoutDiskCache) {
+    const CachePathGuard cache_path{fs::temp_directory_path() / "FlowGridFaustCacheFile"};
+    FileIO::write(cache_path.Path, "Not a directory");
+    FaustCompiler::CachePath = cache_path.Path / "faust_cache";
+
+    HeadlessProject project;
+    FaustCompiler compiler;
+    const auto code = GetDspCode(project);
+    CHECK(!Compile(compiler, code).CacheHit);
+    CHECK(Compile(compiler, code).CacheHit);
+}
+
+// Requesting a compile and polling for results stays cheap on the UI thread while the worker compiles.
+TEST(FaustCompilerUiThreadCost) {
+    const CachePathGuard cache_path{fs::temp_directory_path() / "FlowGridFaustCacheUiTest"};
+    HeadlessProject project;
+    FaustCompiler compiler;
+    const auto code = GetDspCode(project);
+
+    BenchClock::duration max_latency{};
+    FaustCompileResult result;
+    for (u32 i = 0; i < 20; ++i) {
+        const auto start = BenchClock::now();
+        compiler.Request(1, code + std::format("\n// {}", i), true); // Never cached.
+        if (compiler.TryDequeue(result)) delete result.Dsp;
+        max_latency = std::max(max_latency, BenchClock::now() - start);
+        std::this_thread::sleep_for(5ms);
+    }
+    while (!compiler.IsIdle()) std::this_thread::sleep_for(10ms);
+    while (compiler.TryDequeue(result)) delete result.Dsp;
+    CHECK(max_latency < std::chrono::milliseconds{1});
+}
@@ -0,0 +1,149 @@
+#include <format>
+#include <map>
+#include <mutex>
+
+#include "Helper/File.h"
+#include "Project/Audio/Faust/FaustCompiler.h"
+#include "Project/Audio/Faust/FaustGraph.h"
+
+#include "HeadlessProject.h"
+#include "Test.h"
+
+// Contents of each file in `dir_path`, by file name.
+static std::map<std::string, std::string> ReadFiles(const fs::path &dir_path) {
+    std::map<std::string, std::string> contents_by_name;
+    for (const auto &entry : fs::directory_iterator(dir_path)) contents_by_name.emplace(entry.path().filename().string(), FileIO::read(entry.path()));
+    return contents_by_name;
+}
+
+// Exporting on multiple threads writes the same files, byte for byte, as exporting on one.
+TEST(FaustGraphParallelSvgExportMatchesSerial) {
+    HeadlessProject project;
+    project.CompileFaustDsps();
+    const auto &faust = project.Project->Audio.Faust;
+    const auto *graph = faust.Graphs.FindGraph(faust.FaustDsps.front()->Id);
+    CHECK(graph != nullptr);
+
+    const auto export_svgs = [graph](u32 thread_count, const fs::path &dir_path) {
+        FaustGraph::SvgExportThreadCount = thread_count;
+        graph->SaveBoxSvg(dir_path);
+        FaustGraph::SvgExportThreadCount = 0;
+        return ReadFiles(dir_path);
+    };
+    const auto dir_path = fs::temp_directory_path() / "FlowGridSvgExportTest";
+    fs::remove_all(dir_path);
+    const auto serial = export_svgs(1, dir_path / "serial");
+    const auto parallel_dir_path = dir_path / "parallel";
+    const auto parallel = export_svgs(8, parallel_dir_path);
+
+    CHECK(serial.size() > 1); // The default DSP folds into multiple files.
+    CHECK(parallel == serial);
+
+    // Exporting again into the same directory rewrites no unchanged files, and removes files no longer in the graph.
+    // Backdate the exported files, so a rewrite changes their modification time regardless of the file system's time resolution.
+    const auto backdated_time = fs::file_time_type::clock::now() - std::chrono::hours{1};
+    std::map<std::string, fs::file_time_type> write_time_by_name;
+    for (const auto &entry : fs::directory_iterator(parallel_dir_path)) {
+        fs::last_write_time(entry.path(), backdated_time);
+        write_time_by_name.emplace(entry.path().filename().string(), fs::last_write_time(entry.path()));
+    }
+    FileIO::write(parallel_dir_path / "stale.svg", "<svg/>");
+    fs::create_directories(parallel_dir_path / "stale");
+
+    CHECK(export_svgs(8, parallel_dir_path) == parallel);
+    std::map<std::string, fs::file_time_type> reexported_write_time_by_name;
+    for (const auto &entry : fs::directory_iterator(parallel_dir_path)) {
+        reexported_write_time_by_name.emplace(entry.path().filename().string(), fs::last_write_time(entry.path()));
+    }
+    CHECK(reexported_write_time_by_name == write_time_by_name);
+    CHECK(!fs::exists(parallel_dir_path / "stale.svg"));
+    CHECK(!fs::exists(parallel_dir_path / "stale"));
+    fs::remove_all(dir_path);
+}
+
+// Replace the project's DSP code and wait for its graph to update.
+static FaustGraph *SetDspCode(HeadlessProject &project, std::string code) {
+    auto &faust = project.Project->Audio.Faust;
+    project.Apply(Action::TextBuffer::Set{faust.FaustDsps.front()->Editor.Buffer.Path, std::move(code)});
+    project.CompileFaustDsps();
+    auto *graph = faust.Graphs.FindGraph(faust.FaustDsps.front()->Id);
+    CHECK(graph != nullptr && graph->RootNode != nullptr);
+    return graph;
+}
+
+// Every node not in the current tree is destroyed, including those built for SVG export, and all are destroyed with their graph.
+TEST(FaustGraphDestroysUnreachableNodes) {
+    const u32 initial_live_node_count = FaustGraph::LiveNodeCount;
+    {
+        HeadlessProject project;
+        project.CompileFaustDsps();
+        const auto &faust = project.Project->Audio.Faust;
+        auto *graph = faust.Graphs.FindGraph(faust.FaustDsps.front()->Id);
+        CHECK(graph != nullptr);
+        const auto check_live_node_count = [&] {
+            u32 node_count = 0;
+            for (const auto *g : faust.Graphs) node_count += g->NodeCount();
+            CHECK_EQ(FaustGraph::LiveNodeCount - initial_live_node_count, node_count);
+        };
+
+        const u32 node_count = graph->NodeCount();
+        CHECK(node_count > 0);
+        check_live_node_count();
+
+        graph->ResetBox();
+        CHECK_EQ(graph->NodeCount(), node_count);
+        check_live_node_count();
+
+        const auto dir_path = fs::temp_directory_path() / "FlowGridArenaSvgTest";
+        graph->SaveBoxSvg(dir_path);
+        fs::remove_all(dir_path);
+        CHECK_EQ(graph->NodeCount(), node_count);
+        check_live_node_count();
+
+        {
+            std::lock_guard lock{FaustCompiler::FrontEndMutex};
+            graph->SetBox(nullptr);
+            CHECK_EQ(graph->NodeCount(), 0u);
+            graph->SetBox(faust.FaustDsps.front()->Box);
+            CHECK_EQ(graph->NodeCount(), node_count);
+        }
+        check_live_node_count();
+    }
+    CHECK_EQ(FaustGraph::LiveNodeCount, initial_live_node_count);
+}
+
+// Recompiling keeps the nodes of unchanged subtrees.
+TEST(FaustGraphReusesUnchangedNodes) {
+    static const std::string Branches = "_ <: par(i, 50, *(i + 1) : +(0.5)) :> _";
+    HeadlessProject project;
+    const u32 node_count = SetDspCode(project, std::format("process = {};", Branches))->NodeCount();
+    const u64 created_node_count = FaustGraph::CreatedNodeCount;
+    const auto *graph = SetDspCode(project, std::format("process = {} : *(2);", Branches));
+    CHECK(graph->NodeCount() > node_count);
+    CHECK(FaustGraph::CreatedNodeCount - created_node_count < node_count / 4);
+}
+
+BENCHMARK(FaustGraphRebuild) {
+    HeadlessProject project;
+    auto *graph = SetDspCode(project, "process = _ <: par(i, 1000, *(i + 1) : +(0.5) : max(0) : min(1)) :> _;");
+    const auto box = project.Project->Audio.Faust.FaustDsps.front()->Box;
+    Bench("Rebuild a ~10k-box graph from scratch", 20, [&] { graph->ResetBox(); });
+    Bench("Rebuild a ~10k-box graph, reusing all nodes", 20, [&] {
+        std::lock_guard lock{FaustCompiler::FrontEndMutex};
+        graph->SetBox(box);
+    });
+}
+
+// Placing a large, fully-expanded graph and recording its draw commands, and replaying the commands each frame.
+BENCHMARK(FaustGraphLargeGraph) {
+    HeadlessProject project;
+    project.Apply(Action::Primitive::UInt::Set{project.Project->Audio.Faust.GraphStyle.FoldComplexity.Path, 0}); // No folding.
+    // About 10 boxes per parallel branch.
+    const auto *graph = SetDspCode(project, "process = _ <: par(i, 1000, *(i + 1) : +(0.5) : max(0) : min(1)) :> _;");
+
+    Bench("Place, record, and draw a ~10k-box graph", 20, [&] {
+        graph->InvalidateLayout();
+        project.RenderFrame([graph] { graph->Draw(); });
+    });
+    Bench("Draw a placed ~10k-box graph", 200, [&] { project.RenderFrame([graph] { graph->Draw(); }); });
+}
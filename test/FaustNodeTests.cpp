@@ -0,0 +1,203 @@
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Project/Audio/Graph/AudioGraphReclaimer.h"
+#include "Project/Audio/Graph/ma_faust_node/ma_faust_node.h"
+#include "Project/Audio/Sample.h" // Must be included before any Faust includes.
+#include "faust/dsp/dsp.h"
+#include "faust/gui/UI.h"
+
+#include "Test.h"
+
+// Outputs its `Level` zone.
+struct LevelDsp : dsp {
+    FAUSTFLOAT Level{0};
+    int SampleRate{0};
+
+    int getNumInputs() override { return 0; }
+    int getNumOutputs() override { return 1; }
+    void buildUserInterface(UI *ui) override { ui->addHorizontalSlider("Level", &Level, 0, -1, 1, 0.01); }
+    int getSampleRate() override { return SampleRate; }
+    void init(int sample_rate) override { instanceInit(sample_rate); }
+    void instanceInit(int sample_rate) override { SampleRate = sample_rate; }
+    void instanceConstants(int) override {}
+    void instanceResetUserInterface() override {}
+    void instanceClear() override {}
+    dsp *clone() override { return new LevelDsp(*this); }
+    void metadata(Meta *) override {}
+    void compute(int count, FAUSTFLOAT **, FAUSTFLOAT **outputs) override {
+        for (int i = 0; i < count; ++i) outputs[0][i] = Level;
+    }
+    void compute(double, int count, FAUSTFLOAT **inputs, FAUSTFLOAT **outputs) override { compute(count, inputs, outputs); }
+};
+
+struct FaustNodeGraph {
+    static constexpr ma_uint32 SampleRate = 48'000, BufferFrames = 256;
+
+    FaustNodeGraph(dsp *dsp) {
+        const auto graph_config = ma_node_graph_config_init(1);
+        CHECK(ma_node_graph_init(&graph_config, nullptr, &Graph) == MA_SUCCESS);
+        const auto node_config = ma_faust_node_config_init(dsp, SampleRate, BufferFrames);
+        CHECK(ma_faust_node_init(&Graph, &node_config, nullptr, &Node) == MA_SUCCESS);
+        CHECK(ma_node_attach_output_bus(&Node, 0, ma_node_graph_get_endpoint(&Graph), 0) == MA_SUCCESS);
+    }
+    ~FaustNodeGraph() {
+        ma_faust_node_uninit(&Node, nullptr);
+        ma_node_graph_uninit(&Graph, nullptr);
+    }
+
+    std::vector<float> Read(ma_uint32 frame_count) {
+        std::vector<float> frames(frame_count);
+        ma_uint64 frames_read = 0;
+        Reclaimer.BeginRead();
+        CHECK(ma_node_graph_read_pcm_frames(&Graph, frames.data(), frame_count, &frames_read) == MA_SUCCESS);
+        Reclaimer.EndRead();
+        CHECK_EQ(frames_read, ma_uint64(frame_count));
+        return frames;
+    }
+
+    // Swap in `dsp`, retiring the previous params rather than waiting for a read in progress to finish with them.
+    void SetDsp(dsp *dsp) {
+        ma_faust_dsp_params *prev_params;
+        CHECK(ma_faust_node_set_dsp(&Node, dsp, &prev_params) == MA_SUCCESS);
+        Reclaimer.Retire(std::shared_ptr<ma_faust_dsp_params>(prev_params, ma_faust_dsp_params_free));
+    }
+
+    ma_node_graph Graph;
+    ma_faust_node Node;
+    AudioGraphReclaimer Reclaimer;
+};
+
+// Changes pushed while the node isn't being processed replace each other, rather than filling up a queue.
+TEST(FaustNodeCoalescesParamChanges) {
+    LevelDsp dsp;
+    FaustNodeGraph graph{&dsp};
+    static constexpr int ChangeCount = 10'000;
+    for (int i = 1; i <= ChangeCount; ++i) CHECK(ma_faust_node_push_param(&graph.Node, &dsp.Level, float(i)) == MA_SUCCESS);
+    CHECK_EQ(dsp.Level, 0.f); // Only the audio thread writes zones.
+
+    const auto frames = graph.Read(FaustNodeGraph::BufferFrames);
+    CHECK_EQ(frames.front(), float(ChangeCount));
+    CHECK_EQ(dsp.Level, float(ChangeCount));
+}
+
+// Outputs the sum of its `Levels` zones.
+struct ManyLevelsDsp : LevelDsp {
+    std::vector<FAUSTFLOAT> Levels = std::vector<FAUSTFLOAT>(1'000, 0);
+
+    void buildUserInterface(UI *ui) override {
+        for (auto &level : Levels) ui->addHorizontalSlider("Level", &level, 0, -1, 1, 0.01);
+    }
+    void compute(int count, FAUSTFLOAT **, FAUSTFLOAT **outputs) override {
+        FAUSTFLOAT sum = 0;
+        for (const auto level : Levels) sum += level;
+        for (int i = 0; i < count; ++i) outputs[0][i] = sum;
+    }
+};
+
+// Every zone in the DSP's UI can have a pending change, however many there are. Other zones can't.
+TEST(FaustNodeHasParamSlotsForEveryZone) {
+    ManyLevelsDsp dsp;
+    FaustNodeGraph graph{&dsp};
+    for (auto &level : dsp.Levels) CHECK(ma_faust_node_push_param(&graph.Node, &level, 1) == MA_SUCCESS);
+    CHECK(ma_faust_node_push_param(&graph.Node, &dsp.Level, 1) == MA_OUT_OF_MEMORY);
+    CHECK_EQ(graph.Read(64).front(), float(dsp.Levels.size()));
+}
+
+TEST(FaustNodeAppliesParamChangesAtFrameOffset) {
+    LevelDsp dsp;
+    FaustNodeGraph graph{&dsp};
+    CHECK(ma_faust_node_push_param(&graph.Node, &dsp.Level, 1, 64) == MA_SUCCESS);
+    const auto frames = graph.Read(128);
+    CHECK_EQ(frames[63], 0.f);
+    CHECK_EQ(frames[64], 1.f);
+    CHECK_EQ(frames[127], 1.f);
+}
+
+// Push changes and swap DSPs on one thread while another processes the node. Run under TSan/ASan to check for races and use-after-frees.
+TEST(FaustNodeParamChangesRaceDspSwaps) {
+    std::vector<std::unique_ptr<LevelDsp>> dsps;
+    dsps.push_back(std::make_unique<LevelDsp>());
+    FaustNodeGraph graph{dsps.back().get()};
+
+    std::atomic<bool> running{true};
+    std::thread audio_thread{[&] {
+        while (running) graph.Read(64);
+    }};
+    for (int i = 1; i <= 20'000; ++i) {
+        if (i % 1000 == 0) {
+            // The previous DSP stays alive (in `dsps`) after the swap, since only zone writes are checked here.
+            dsps.push_back(std::make_unique<LevelDsp>());
+            graph.SetDsp(dsps.back().get());
+        }
+        CHECK(ma_faust_node_push_param(&graph.Node, &dsps.back()->Level, float(i)) == MA_SUCCESS);
+    }
+    running = false;
+    audio_thread.join();
+
+    const auto frames = graph.Read(64);
+    CHECK_EQ(frames.back(), 20'000.f);
+    for (size_t i = 0; i + 1 < dsps.size(); ++i) CHECK(dsps[i]->Level < float((i + 1) * 1000));
+}
+
+// Swap DSPs and replace the node on one thread while another reads the graph, retiring everything replaced instead of waiting for the reader.
+// Run under TSan/ASan to check that nothing is freed while a read in progress may still be using it.
+TEST(FaustNodeRetiredDspsAndNodesRaceReads) {
+    ma_node_graph graph;
+    const auto graph_config = ma_node_graph_config_init(1);
+    CHECK(ma_node_graph_init(&graph_config, nullptr, &graph) == MA_SUCCESS);
+    {
+        AudioGraphReclaimer reclaimer;
+        const auto create_node = [&graph](dsp *dsp) {
+            auto node = std::make_unique<ma_faust_node>();
+            const auto config = ma_faust_node_config_init(dsp, FaustNodeGraph::SampleRate, FaustNodeGraph::BufferFrames);
+            CHECK(ma_faust_node_init(&graph, &config, nullptr, node.get()) == MA_SUCCESS);
+            CHECK(ma_node_attach_output_bus(node.get(), 0, ma_node_graph_get_endpoint(&graph), 0) == MA_SUCCESS);
+            return node;
+        };
+        const auto retire_node = [&reclaimer](std::unique_ptr<ma_faust_node> node) {
+            ma_node_detach_all_output_buses(node.get());
+            reclaimer.Retire(std::shared_ptr<ma_faust_node>(node.release(), [](ma_faust_node *node) {
+                ma_faust_node_uninit(node, nullptr);
+                delete node;
+            }));
+        };
+        const auto read = [&](float *frames, ma_uint32 frame_count) {
+            reclaimer.BeginRead();
+            CHECK(ma_node_graph_read_pcm_frames(&graph, frames, frame_count, nullptr) == MA_SUCCESS);
+            reclaimer.EndRead();
+        };
+
+        auto dsp = std::make_shared<LevelDsp>();
+        auto node = create_node(dsp.get());
+        std::atomic<bool> running{true};
+        std::thread audio_thread{[&] {
+            float frames[64];
+            while (running) read(frames, 64);
+        }};
+        for (int i = 1; i <= 2'000; ++i) {
+            auto next_dsp = std::make_shared<LevelDsp>();
+            next_dsp->Level = float(i);
+            if (i % 2 == 0) {
+                ma_faust_dsp_params *prev_params;
+                CHECK(ma_faust_node_set_dsp(node.get(), next_dsp.get(), &prev_params) == MA_SUCCESS);
+                reclaimer.Retire(std::shared_ptr<ma_faust_dsp_params>(prev_params, ma_faust_dsp_params_free));
+            } else {
+                retire_node(std::exchange(node, create_node(next_dsp.get())));
+            }
+            // Retired after the params and node that reach it, as in `AudioGraph::OnFaustDspRetired`.
+            reclaimer.Retire(std::exchange(dsp, std::move(next_dsp)));
+            reclaimer.Collect();
+        }
+        running = false;
+        audio_thread.join();
+
+        float frames[64];
+        read(frames, 64);
+        CHECK_EQ(frames[63], 2'000.f);
+        retire_node(std::move(node));
+    }
+    ma_node_graph_uninit(&graph, nullptr);
+}
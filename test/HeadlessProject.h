@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "imgui.h"
+#include "implot.h"
+
+#include "Core/Primitive/PrimitiveActionQueuer.h"
+#include "Core/Store/Store.h"
+#include "Project/Audio/Device/AudioDevice.h"
+#include "Project/Audio/Faust/Faust.h"
+#include "Project/Project.h"
+#include "UI/Fonts.h"
+
+// A project without a window or audio hardware, set up as in `flowgrid_render`, with a font atlas for rendering frames.
+// Loads fonts and DSP code from `./res` (copied to the build directory along with the app), so it must run from the build directory.
+// Only one may exist at a time, since components are registered globally.
+struct HeadlessProject {
+    HeadlessProject() {
+        AudioDevice::Offline = true;
+        ImGui::CreateContext();
+        ImPlot::CreateContext();
+        auto &io = ImGui::GetIO();
+        io.IniFilename = nullptr;
+        io.DisplaySize = {1920, 1080};
+        Fonts::Init();
+        io.FontGlobalScale = 1 / Fonts::AtlasScale;
+        unsigned char *pixels;
+        int width, height;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height); // Builds the atlas.
+
+        Project = std::make_unique<::Project>(RootStore, PrimitiveQueuer, Q);
+        RootStore.Commit();
+        Component::RefreshAll();
+        Project->OnApplicationLaunch();
+    }
+    ~HeadlessProject() {
+        Project.reset();
+        ImPlot::DestroyContext();
+        ImGui::DestroyContext();
+    }
+
+    // Apply `action` and commit it as a gesture, as if it were issued from the UI.
+    template<typename ActionType> void Apply(ActionType &&action) {
+        Queue.Enqueue(std::forward<ActionType>(action));
+        Project->ApplyQueuedActions(Queue, true);
+    }
+
+    // Wait for all Faust DSPs to finish compiling and hand them off to their listeners.
+    void CompileFaustDsps() {
+        auto &faust_dsps = Project->Audio.Faust.FaustDsps;
+        while (!faust_dsps.Compiler->IsIdle()) std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        faust_dsps.ApplyCompileResults();
+        Project->ApplyQueuedActions(Queue, true);
+    }
+
+    // Run one ImGui frame, calling `render` inside a full-display window.
+    template<typename RenderFn> void RenderFrame(RenderFn &&render) {
+        ImGui::NewFrame();
+        ImGui::SetNextWindowPos({0, 0});
+        ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+        ImGui::Begin("Headless");
+        render();
+        ImGui::End();
+        ImGui::Render();
+    }
+
+    Store RootStore{};
+    ActionQueue<Action::Any> Queue{};
+    ActionProducer<Action::Any>::EnqueueFn Q = [this](auto &&a) -> bool { return Queue.Enqueue(std::move(a)); };
+    ActionProducer<PrimitiveActionQueuer::ProducedActionType>::EnqueueFn PrimitiveQ = [this](auto &&action) -> bool {
+        return std::visit([this](auto &&a) -> bool { return Queue.Enqueue(std::move(a)); }, std::move(action));
+    };
+    PrimitiveActionQueuer PrimitiveQueuer{PrimitiveQ};
+    std::unique_ptr<::Project> Project;
+};
@@ -0,0 +1,36 @@
+#include <format>
+
+#include "Core/ImGuiSettings.h"
+
+#include "HeadlessProject.h"
+#include "Test.h"
+
+// Per-frame settings capture cost while dragging one window's size, with many other windows (each with a resizable table) open.
+BENCHMARK(ImGuiSettingsCaptureDuringResize) {
+    static constexpr u32 WindowCount = 200;
+    HeadlessProject project;
+    const auto &settings = project.Project->ImGuiSettings;
+    u32 frame = 0;
+    const auto resize_and_capture = [&] {
+        project.RenderFrame([&] {
+            for (u32 i = 0; i < WindowCount; ++i) {
+                if (i == 0) ImGui::SetNextWindowSize({200 + float(frame % 100), 200});
+                ImGui::Begin(std::format("Window {}", i).c_str());
+                if (ImGui::BeginTable("Table", 3, ImGuiTableFlags_Resizable)) ImGui::EndTable();
+                ImGui::End();
+            }
+        });
+        ++frame;
+        ImGui::SaveIniSettingsToMemory();
+        return settings.CreatePatch(ImGui::GetCurrentContext());
+    };
+
+    CHECK(!resize_and_capture().Empty()); // Write all the new entries.
+    Bench("Resize one of 200 windows and capture settings", 200, [&] { resize_and_capture(); });
+    Bench("Resize one of 200 windows and capture settings, rewriting all entries", 200, [&] {
+        settings.Nodes.EntryHashes.clear();
+        settings.Windows.EntryHashes.clear();
+        settings.Tables.EntryHashes.clear();
+        resize_and_capture();
+    });
+}
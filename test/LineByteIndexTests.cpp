@@ -0,0 +1,53 @@
+#include <numeric>
+#include <random>
+
+#include "Project/TextEditor/LineByteIndex.h"
+
+#include "Test.h"
+
+// Start bytes match a prefix sum of line sizes (plus newlines), through random splices.
+TEST(LineByteIndexMatchesPrefixSums) {
+    std::mt19937 rng{0};
+    const auto random_sizes = [&rng](u32 count) {
+        std::vector<u32> sizes(count);
+        for (auto &size : sizes) size = rng() % 80;
+        return sizes;
+    };
+
+    std::vector<u32> line_sizes = random_sizes(1'000);
+    LineByteIndex index{line_sizes};
+    for (u32 i = 0; i < 500; ++i) {
+        const u32 begin = rng() % (line_sizes.size() + 1), end = begin + rng() % (line_sizes.size() - begin + 1);
+        const auto inserted = random_sizes(rng() % 4);
+        const LineByteIndex prev_index = index;
+        const u32 prev_byte_count = prev_index.StartByte(prev_index.LineCount());
+        index = index.Splice(begin, end, inserted);
+        line_sizes.erase(line_sizes.begin() + begin, line_sizes.begin() + end);
+        line_sizes.insert(line_sizes.begin() + begin, inserted.begin(), inserted.end());
+        if (line_sizes.empty()) { // Start over, rather than continuing to splice an empty index.
+            line_sizes = random_sizes(1'000);
+            index = LineByteIndex{line_sizes};
+        }
+
+        CHECK_EQ(index.LineCount(), u32(line_sizes.size()));
+        u32 start_byte = 0;
+        for (u32 li = 0; li < line_sizes.size(); start_byte += line_sizes[li++] + 1) CHECK_EQ(index.StartByte(li), start_byte);
+        CHECK_EQ(prev_index.StartByte(prev_index.LineCount()), prev_byte_count); // Splicing leaves the previous version unchanged.
+    }
+}
+
+BENCHMARK(LineByteIndex) {
+    static constexpr u32 LineCount = 50'000;
+    std::vector<u32> line_sizes(LineCount, 40);
+    LineByteIndex index{line_sizes};
+    u32 li = 0;
+    Bench("Start byte of a line in a 50k-line index", 100'000, [&] { index.StartByte(li++ % LineCount); });
+    Bench("Start byte of the last line by summing 50k line sizes", 1'000, [&] {
+        const u32 start_byte = std::accumulate(line_sizes.begin(), line_sizes.end() - 1, 0u, [](u32 sum, u32 size) { return sum + size + 1; });
+        CHECK_EQ(start_byte, index.StartByte(LineCount - 1));
+    });
+    Bench("Replace the last line of a 50k-line index", 100'000, [&] { index = index.Splice(LineCount - 1, LineCount, {41}); });
+    Bench("Split the last line of a 50k-line index", 10'000, [&] {
+        index = index.Splice(LineCount - 1, LineCount, {20, 20}).Splice(LineCount - 1, LineCount + 1, {40});
+    });
+}
@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numbers>
+#include <thread>
+#include <vector>
+
+#include "Project/Audio/Graph/ma_monitor_node/ma_monitor_node.h"
+
+#include "Test.h"
+
+using namespace std::chrono_literals;
+
+// Wait for the monitor's analysis worker to publish a frame analyzing exactly the `N` (interleaved) frames in `output`.
+static const ma_monitor_frame *WaitForFrame(ma_monitor_node &monitor, const std::vector<float> &output, ma_uint32 channels, ma_uint32 N) {
+    const auto analyzed = [&](const ma_monitor_frame *frame) {
+        for (ma_uint32 i = 0; i < N * channels; ++i) {
+            if (frame->buffers[i % channels][i / channels] != output[i]) return false;
+        }
+        return true;
+    };
+    const ma_monitor_frame *frame = ma_monitor_node_get_frame(&monitor);
+    for (unsigned i = 0; i < 500 && !analyzed(frame); ++i) {
+        std::this_thread::sleep_for(10ms);
+        frame = ma_monitor_node_get_frame(&monitor);
+    }
+    return frame;
+}
+
+// Pull a bin-centered sine through a monitor node in a headless node graph (no device),
+// and check the spectrum published by the analysis worker.
+TEST(MonitorNodeSineSpectrum) {
+    static constexpr ma_uint32 SampleRate = 48'000, N = 1024, SineBin = 32, Bins = N / 2 + 1;
+
+    ma_node_graph graph;
+    const auto graph_config = ma_node_graph_config_init(1);
+    CHECK(ma_node_graph_init(&graph_config, nullptr, &graph) == MA_SUCCESS);
+
+    ma_waveform waveform;
+    const auto waveform_config = ma_waveform_config_init(ma_format_f32, 1, SampleRate, ma_waveform_type_sine, 1, double(SineBin) * SampleRate / N);
+    CHECK(ma_waveform_init(&waveform_config, &waveform) == MA_SUCCESS);
+
+    ma_data_source_node source;
+    const auto source_config = ma_data_source_node_config_init(&waveform);
+    CHECK(ma_data_source_node_init(&graph, &source_config, nullptr, &source) == MA_SUCCESS);
+
+    ma_monitor_node monitor;
+    const auto monitor_config = ma_monitor_node_config_init(1, N);
+    CHECK(ma_monitor_node_init(&graph, &monitor_config, nullptr, &monitor) == MA_SUCCESS);
+
+    ma_node_attach_output_bus(&source, 0, &monitor, 0);
+    ma_node_attach_output_bus(&monitor, 0, ma_node_graph_get_endpoint(&graph), 0);
+
+    // Silent until the first full window is analyzed.
+    const float *initial_buffer = ma_monitor_node_get_frame(&monitor)->buffers[0];
+    CHECK(std::all_of(initial_buffer, initial_buffer + N, [](float sample) { return sample == 0; }));
+
+    std::vector<float> output(N);
+    ma_uint64 frames_read = 0;
+    CHECK(ma_node_graph_read_pcm_frames(&graph, output.data(), N, &frames_read) == MA_SUCCESS);
+    CHECK_EQ(frames_read, ma_uint64(N));
+
+    // The monitor passes its input through, and analyzes exactly what it passed.
+    const auto *frame = WaitForFrame(monitor, output, 1, N);
+    for (ma_uint32 i = 0; i < N; ++i) CHECK_EQ(frame->buffers[0][i], output[i]);
+
+    // With the default rectangular window, a full-scale bin-centered sine is a single 0 dB bin.
+    const float *magnitudes_db = frame->magnitudes_db[0];
+    const auto peak = std::max_element(magnitudes_db, magnitudes_db + Bins);
+    CHECK_EQ(ma_uint32(peak - magnitudes_db), SineBin);
+    CHECK_NEAR(*peak, 0, 0.01);
+    for (ma_uint32 bin = 0; bin < Bins; ++bin) {
+        if (bin != SineBin) CHECK(magnitudes_db[bin] < -60);
+    }
+    CHECK_EQ(ma_monitor_node_get_dropped_frames(&monitor), 0u);
+
+    ma_monitor_node_uninit(&monitor, nullptr);
+    ma_data_source_node_uninit(&source, nullptr);
+    ma_waveform_uninit(&waveform);
+    ma_node_graph_uninit(&graph, nullptr);
+}
+
+// Each channel of a 4-channel monitor gets its own spectrum, and the dB conversion matches `std::log10`.
+TEST(MonitorNodeMultichannelToneSpectra) {
+    static constexpr ma_uint32 Channels = 4, N = 1024, Bins = N / 2 + 1;
+    static constexpr ma_uint32 ToneBins[Channels]{16, 32, 48, 64};
+
+    ma_node_graph graph;
+    const auto graph_config = ma_node_graph_config_init(Channels);
+    CHECK(ma_node_graph_init(&graph_config, nullptr, &graph) == MA_SUCCESS);
+
+    // A full-scale bin-centered sine per channel, interleaved.
+    std::vector<float> tones(N * Channels);
+    for (ma_uint32 i = 0; i < N; ++i) {
+        for (ma_uint32 channel = 0; channel < Channels; ++channel) {
+            tones[i * Channels + channel] = float(std::sin(2 * std::numbers::pi * ToneBins[channel] * i / N));
+        }
+    }
+    ma_audio_buffer_ref tones_ref;
+    CHECK(ma_audio_buffer_ref_init(ma_format_f32, Channels, tones.data(), N, &tones_ref) == MA_SUCCESS);
+
+    ma_data_source_node source;
+    const auto source_config = ma_data_source_node_config_init(&tones_ref);
+    CHECK(ma_data_source_node_init(&graph, &source_config, nullptr, &source) == MA_SUCCESS);
+
+    ma_monitor_node monitor;
+    const auto monitor_config = ma_monitor_node_config_init(Channels, N);
+    CHECK(ma_monitor_node_init(&graph, &monitor_config, nullptr, &monitor) == MA_SUCCESS);
+
+    ma_node_attach_output_bus(&source, 0, &monitor, 0);
+    ma_node_attach_output_bus(&monitor, 0, ma_node_graph_get_endpoint(&graph), 0);
+
+    std::vector<float> output(N * Channels);
+    CHECK(ma_node_graph_read_pcm_frames(&graph, output.data(), N, nullptr) == MA_SUCCESS);
+    const auto *frame = WaitForFrame(monitor, output, Channels, N);
+    for (ma_uint32 channel = 0; channel < Channels; ++channel) {
+        const float *magnitudes_db = frame->magnitudes_db[channel];
+        const auto peak = std::max_element(magnitudes_db, magnitudes_db + Bins);
+        CHECK_EQ(ma_uint32(peak - magnitudes_db), ToneBins[channel]);
+        CHECK_NEAR(*peak, 0, 0.01);
+        for (ma_uint32 bin = 0; bin < Bins; ++bin) {
+            const auto [re, im] = frame->spectra[channel][bin];
+            const float expected_db = 20.f * std::log10(std::max(std::sqrt(re * re + im * im) * 2.f / N, 1e-10f));
+            CHECK_NEAR(magnitudes_db[bin], expected_db, 0.001);
+        }
+    }
+
+    ma_monitor_node_uninit(&monitor, nullptr);
+    ma_data_source_node_uninit(&source, nullptr);
+    ma_audio_buffer_ref_uninit(&tones_ref);
+    ma_node_graph_uninit(&graph, nullptr);
+}
+
+// Records the thread it's applied on, and blocks the analysis until released.
+static std::atomic<bool> BlockingWindowApplied{false}, BlockingWindowReleased{false};
+static std::thread::id BlockingWindowThreadId;
+static void BlockingWindow(float *window, unsigned N) {
+    BlockingWindowThreadId = std::this_thread::get_id();
+    BlockingWindowApplied.store(true);
+    BlockingWindowReleased.wait(false);
+    for (unsigned i = 0; i < N; ++i) window[i] = 1;
+}
+
+// The audio callback only pushes frames, and wakes the worker to analyze each full window on its own thread.
+// Reads keep returning while an analysis is stalled, since the callback never waits on (or does) FFT work.
+TEST(MonitorNodeAnalyzesOffAudioThread) {
+    static constexpr ma_uint32 N = 1024;
+
+    ma_node_graph graph;
+    const auto graph_config = ma_node_graph_config_init(1);
+    CHECK(ma_node_graph_init(&graph_config, nullptr, &graph) == MA_SUCCESS);
+
+    ma_waveform waveform;
+    const auto waveform_config = ma_waveform_config_init(ma_format_f32, 1, 48'000, ma_waveform_type_sine, 1, 440);
+    CHECK(ma_waveform_init(&waveform_config, &waveform) == MA_SUCCESS);
+
+    ma_data_source_node source;
+    const auto source_config = ma_data_source_node_config_init(&waveform);
+    CHECK(ma_data_source_node_init(&graph, &source_config, nullptr, &source) == MA_SUCCESS);
+
+    ma_monitor_node monitor;
+    const auto monitor_config = ma_monitor_node_config_init(1, N);
+    CHECK(ma_monitor_node_init(&graph, &monitor_config, nullptr, &monitor) == MA_SUCCESS);
+
+    ma_node_attach_output_bus(&source, 0, &monitor, 0);
+    ma_node_attach_output_bus(&monitor, 0, ma_node_graph_get_endpoint(&graph), 0);
+    CHECK(ma_monitor_apply_window_function(&monitor, BlockingWindow) == MA_SUCCESS);
+
+    // Completing the first window wakes the worker, which stalls in the window function.
+    std::vector<float> output(N);
+    CHECK(ma_node_graph_read_pcm_frames(&graph, output.data(), N, nullptr) == MA_SUCCESS);
+    for (unsigned i = 0; i < 500 && !BlockingWindowApplied.load(); ++i) std::this_thread::sleep_for(10ms);
+    CHECK(BlockingWindowApplied.load());
+    CHECK(BlockingWindowThreadId != std::this_thread::get_id());
+
+    // The ring has room for the next window while the worker is stalled.
+    CHECK(ma_node_graph_read_pcm_frames(&graph, output.data(), N, nullptr) == MA_SUCCESS);
+    BlockingWindowReleased.store(true);
+    BlockingWindowReleased.notify_all();
+    const auto *frame = WaitForFrame(monitor, output, 1, N);
+    for (ma_uint32 i = 0; i < N; ++i) CHECK_EQ(frame->buffers[0][i], output[i]);
+    CHECK_EQ(ma_monitor_node_get_dropped_frames(&monitor), 0u);
+
+    ma_monitor_node_uninit(&monitor, nullptr);
+    ma_data_source_node_uninit(&source, nullptr);
+    ma_waveform_uninit(&waveform);
+    ma_node_graph_uninit(&graph, nullptr);
+}
+
+// The callback's cost doesn't grow with the analysis window, since it only copies frames into the ring.
+BENCHMARK(MonitorNodeCallback) {
+    static constexpr ma_uint32 Channels = 2, BlockFrames = 256;
+
+    ma_node_graph graph;
+    const auto graph_config = ma_node_graph_config_init(Channels);
+    CHECK(ma_node_graph_init(&graph_config, nullptr, &graph) == MA_SUCCESS);
+
+    ma_waveform waveform;
+    const auto waveform_config = ma_waveform_config_init(ma_format_f32, Channels, 48'000, ma_waveform_type_sine, 1, 440);
+    CHECK(ma_waveform_init(&waveform_config, &waveform) == MA_SUCCESS);
+
+    ma_data_source_node source;
+    const auto source_config = ma_data_source_node_config_init(&waveform);
+    CHECK(ma_data_source_node_init(&graph, &source_config, nullptr, &source) == MA_SUCCESS);
+    ma_node_attach_output_bus(&source, 0, ma_node_graph_get_endpoint(&graph), 0);
+
+    std::vector<float> output(BlockFrames * Channels);
+    const auto read_block = [&] { ma_node_graph_read_pcm_frames(&graph, output.data(), BlockFrames, nullptr); };
+    Bench("Pull a 256-frame stereo block, without a monitor", 10'000, read_block);
+    for (const ma_uint32 N : {1024u, 16384u}) {
+        ma_monitor_node monitor;
+        const auto monitor_config = ma_monitor_node_config_init(Channels, N);
+        CHECK(ma_monitor_node_init(&graph, &monitor_config, nullptr, &monitor) == MA_SUCCESS);
+        ma_node_attach_output_bus(&source, 0, &monitor, 0);
+        ma_node_attach_output_bus(&monitor, 0, ma_node_graph_get_endpoint(&graph), 0);
+        Bench(std::format("Pull a 256-frame stereo block through a {}-frame monitor", N), 10'000, read_block);
+        ma_node_attach_output_bus(&source, 0, ma_node_graph_get_endpoint(&graph), 0);
+        ma_monitor_node_uninit(&monitor, nullptr);
+    }
+
+    ma_data_source_node_uninit(&source, nullptr);
+    ma_waveform_uninit(&waveform);
+    ma_node_graph_uninit(&graph, nullptr);
+}
@@ -0,0 +1,62 @@
+#include <format>
+#include <random>
+#include <unordered_map>
+
+#include "Core/Primitive/Scalar.h"
+#include "Helper/PathIds.h"
+
+#include "Test.h"
+
+// The nearest interned ancestor, found by constructing and looking up each parent path.
+static std::optional<std::pair<PathId, u32>> FindNearestByParentPaths(const StorePath &path) {
+    u32 depth = 0;
+    for (StorePath search_path = path;; search_path = search_path.parent_path(), ++depth) {
+        if (const auto path_id = PathIds::Find(search_path)) return std::pair{*path_id, depth};
+        if (search_path.parent_path() == search_path) return {};
+    }
+}
+
+TEST(PathIdsFindNearestMatchesParentPaths) {
+    std::mt19937 rng{0};
+    const auto random_path = [&rng] {
+        std::string path = "/PathIdsTest";
+        for (u32 i = rng() % 6; i > 0; --i) path += std::format("{}{}", rng() % 8 == 0 ? "//" : "/", rng() % 3);
+        if (rng() % 8 == 0) path += "/";
+        return StorePath{path};
+    };
+    for (u32 i = 0; i < 100; ++i) PathIds::Intern(random_path());
+    for (u32 i = 0; i < 10'000; ++i) {
+        const auto path = random_path();
+        CHECK(PathIds::FindNearest(path) == FindNearestByParentPaths(path));
+    }
+    CHECK(PathIds::FindNearest("/") == FindNearestByParentPaths("/"));
+}
+
+// Patch paths are usually container elements a few levels below a component path.
+BENCHMARK(PathIds) {
+    static constexpr u32 ComponentCount = 10'000;
+    std::vector<StorePath> component_paths, element_paths;
+    std::unordered_map<StorePath, u32, PathHash> index_by_path;
+    for (u32 i = 0; i < ComponentCount; ++i) {
+        const StorePath component_path = std::format("/PathIdsBenchmark/Nodes/{}/Node/Params", i);
+        PathIds::Intern(component_path);
+        index_by_path.emplace(component_path, i);
+        component_paths.push_back(component_path);
+        element_paths.push_back(component_path / "Values" / std::to_string(i % 64));
+    }
+
+    u32 i = 0;
+    Bench("Find an ancestor 2 levels up, constructing parent paths", 100'000, [&] {
+        FindNearestByParentPaths(element_paths[i++ % ComponentCount]);
+    });
+    Bench("Find an ancestor 2 levels up, hashing prefixes in one pass", 100'000, [&] {
+        PathIds::FindNearest(element_paths[i++ % ComponentCount]);
+    });
+    Bench("Look up a component path in a path-keyed map", 100'000, [&] { index_by_path.find(component_paths[i++ % ComponentCount]); });
+    Bench("Look up a component path's ID", 100'000, [&] { PathIds::Find(component_paths[i++ % ComponentCount]); });
+    const PathId path_id = *PathIds::Find(component_paths.front());
+    Bench("Walk 4 ancestors of an interned path", 100'000, [&] {
+        PathId id = path_id;
+        for (u32 depth = 0; depth < 4; ++depth) id = PathIds::Parent(id);
+    });
+}
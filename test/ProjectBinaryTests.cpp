@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <cstring>
+#include <format>
+
+#include "Project/Audio/Graph/AudioGraph.h"
+#include "Project/ProjectBinary.h"
+
+#include "HeadlessProject.h"
+#include "Test.h"
+
+static Store CreateTestStore() {
+    Store store;
+    store.Set("/bool", true);
+    store.Set("/string", std::string{"value"});
+    store.Set("/pairs", IdPairs{}.insert({1, 2}));
+    store.Set("/vector", Store::Vector<float>{1.f, 2.f, 3.f});
+    store.Commit();
+    return store;
+}
+
+// Read the state section of `data` into a new store.
+static Store ReadState(const std::vector<std::uint8_t> &data) {
+    Store store;
+    ProjectBinary::Reader{data}.ReadState(store);
+    store.Commit();
+    return store;
+}
+
+template<typename T> static void Overwrite(std::vector<std::uint8_t> &data, u64 offset, T value) { std::memcpy(data.data() + offset, &value, sizeof(T)); }
+
+// Throws a `std::runtime_error` (rather than reading out of bounds) when reading `data`'s state.
+static bool ReadStateThrows(const std::vector<std::uint8_t> &data) {
+    try {
+        ReadState(data);
+    } catch (const std::runtime_error &) {
+        return true;
+    }
+    return false;
+}
+
+TEST(ProjectBinaryRoundTripsState) {
+    const auto store = CreateTestStore();
+    const auto data = ProjectBinary::Write(store, {.Gestures = {}, .Index = 0});
+    CHECK(ReadState(data).CreatePatch(store).Empty());
+
+    const ProjectBinary::Reader reader{data};
+    CHECK_EQ(reader.GestureCount(), 0u);
+    CHECK_EQ(reader.HistoryIndex(), 0u);
+}
+
+// Lengths and offsets near the u64 limit don't wrap around the bounds checks.
+TEST(ProjectBinaryRejectsCorruptData) {
+    const auto data = ProjectBinary::Write(CreateTestStore(), {.Gestures = {}, .Index = 0});
+    CHECK(!ReadStateThrows(data));
+
+    {
+        auto corrupt = data;
+        corrupt.resize(corrupt.size() - 1);
+        CHECK(ReadStateThrows(corrupt));
+    }
+    {
+        // Each path is written as a u64 length followed by its bytes.
+        auto corrupt = data;
+        static constexpr std::string_view Path = "/string";
+        const auto path_it = std::search(corrupt.begin(), corrupt.end(), Path.begin(), Path.end());
+        CHECK(path_it != corrupt.end());
+        Overwrite(corrupt, u64(path_it - corrupt.begin()) - sizeof(u64), ~u64(0));
+        CHECK(ReadStateThrows(corrupt));
+    }
+    {
+        // Header: Magic (4 bytes), version (u32), state offset (u64), gesture index offset (u64), gesture count (u32), history index (u32).
+        auto corrupt = data;
+        Overwrite(corrupt, 16, ~u64(0) - 7);
+        Overwrite(corrupt, 24, u32(1));
+        CHECK(ReadStateThrows(corrupt));
+
+        corrupt = data;
+        Overwrite(corrupt, 24, ~u32(0));
+        CHECK(ReadStateThrows(corrupt));
+    }
+}
+
+// Two gestures per node: Create a waveform node, and connect it to the output.
+static void CreateGestures(HeadlessProject &project, u32 node_count) {
+    auto &graph = project.Project->Audio.Graph;
+    const auto output_it = std::ranges::find_if(graph.Nodes, [](const auto *node) { return node->PathSegment == OutputDeviceNodeTypeId; });
+    CHECK(output_it != graph.Nodes.end());
+    const ID output_id = (*output_it)->Id;
+    for (u32 i = 0; i < node_count; ++i) {
+        project.Apply(Action::AudioGraph::CreateNode{WaveformNodeTypeId});
+        project.Apply(Action::AdjacencyList::ToggleConnection{graph.Connections.Path, graph.Nodes.back()->Id, output_id});
+    }
+}
+
+struct ProjectFiles {
+    ProjectFiles(std::string_view name) : Dir(fs::temp_directory_path() / name) {
+        fs::remove_all(Dir);
+        fs::create_directories(Dir);
+    }
+    ~ProjectFiles() {
+        std::error_code error;
+        fs::remove_all(Dir, error);
+    }
+
+    fs::path Path(std::string_view extension) const { return Dir / std::format("project{}", extension); }
+
+    const fs::path Dir;
+};
+
+// A binary project reopens to the same state and history (including branches) as the JSON state and action formats.
+TEST(ProjectBinaryRoundTripsProjects) {
+    const ProjectFiles files{"FlowGridProjectBinaryTest"};
+    static constexpr std::string_view Extensions[]{".fls", ".fla", ".flb"};
+    json state_json, action_json;
+    {
+        HeadlessProject project;
+        CreateGestures(project, 3);
+        project.Apply(Action::Project::Undo{});
+        CreateGestures(project, 2); // Start a new branch.
+        for (const auto extension : Extensions) project.Apply(Action::Project::Save{files.Path(extension)});
+        state_json = project.Project->GetProjectJson(StateFormat);
+        action_json = project.Project->GetProjectJson(ActionFormat);
+        CHECK(action_json.at("ParentIds").is_array());
+    }
+    for (const auto extension : Extensions) {
+        HeadlessProject project;
+        project.Apply(Action::Project::Open{files.Path(extension)});
+        CHECK(project.Project->GetProjectJson(StateFormat) == state_json);
+        if (extension == ".fls") continue; // No history.
+
+        // Saving loads a binary project's pending gestures into the history.
+        project.Apply(Action::Project::Save{files.Dir / "resaved.fla"});
+        CHECK(project.Project->GetProjectJson(ActionFormat) == action_json);
+        CHECK(project.Project->GetProjectJson(StateFormat) == state_json);
+    }
+}
+
+BENCHMARK(ProjectBinaryOpen) {
+    const ProjectFiles files{"FlowGridProjectBinaryBenchmark"};
+    HeadlessProject project;
+    CreateGestures(project, 200);
+    for (const auto extension : {".fls", ".fla", ".flb"}) project.Apply(Action::Project::Save{files.Path(extension)});
+
+    const auto open = [&](std::string_view extension) { project.Apply(Action::Project::Open{files.Path(extension)}); };
+    Bench("Open a 400-gesture state (.fls) project", 20, [&] { open(".fls"); });
+    Bench("Open a 400-gesture action (.fla) project", 20, [&] { open(".fla"); });
+    Bench("Open a 400-gesture binary (.flb) project", 20, [&] { open(".flb"); });
+    Bench("Open a 400-gesture binary (.flb) project and load its gestures", 20, [&] {
+        open(".flb");
+        project.Apply(Action::Project::Save{files.Dir / "resaved.flb"});
+    });
+}
@@ -0,0 +1,27 @@
+#include "Helper/File.h"
+
+#include "HeadlessProject.h"
+#include "Test.h"
+
+// Opening an action-formatted project replays its gestures on top of the empty project.
+BENCHMARK(ProjectReplayGestures) {
+    static constexpr u32 GestureCount = 10'000, ActionsPerGesture = 5;
+    HeadlessProject project;
+    const auto &style = project.Project->Style.ImGui;
+
+    StoreHistory::IndexedGestures indexed_gestures{.Gestures = {}, .Index = GestureCount};
+    for (u32 i = 0; i < GestureCount; ++i) {
+        Gesture gesture{{}, Clock::now()};
+        for (u32 j = 0; j < ActionsPerGesture; ++j) {
+            const auto &field = j % 2 == 0 ? style.IndentSpacing : style.ScrollbarSize;
+            gesture.Actions.push_back({Action::Primitive::Float::Set{field.Path, float((i + j) % 20)}, Clock::now()});
+        }
+        indexed_gestures.Gestures.push_back(std::move(gesture));
+    }
+    const auto path = fs::temp_directory_path() / "FlowGridReplayBenchmark.fla";
+    FileIO::write(path, json(indexed_gestures).dump());
+
+    Bench("Open a 50k-action project (10k gestures)", 5, [&] { project.Apply(Action::Project::Open{path}); });
+    CHECK_EQ(float(style.IndentSpacing), float((GestureCount - 1 + ActionsPerGesture - 1) % 20));
+    fs::remove(path);
+}
@@ -0,0 +1,39 @@
+# Render a project with `flowgrid_render`, and check its exit code and the output WAV's header and size.
+# Usage: cmake -DRENDER=<flowgrid_render> -DPROJECT=<project> -DOUTPUT=<output.wav> -DSECONDS=<seconds> -P RenderTest.cmake
+
+file(REMOVE ${OUTPUT})
+execute_process(
+    COMMAND ${RENDER} ${PROJECT} ${OUTPUT} --seconds ${SECONDS}
+    RESULT_VARIABLE result
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE error
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "flowgrid_render exited with ${result}:\n${output}${error}")
+endif()
+
+string(REGEX MATCH "\\(([0-9]+) frames @" _ "${output}")
+set(frames ${CMAKE_MATCH_1})
+if(NOT frames GREATER 0)
+    message(FATAL_ERROR "Rendered no frames:\n${output}")
+endif()
+
+# 44-byte header, followed by stereo 32-bit float frames.
+file(SIZE ${OUTPUT} size)
+math(EXPR expected_size "44 + ${frames} * 2 * 4")
+if(NOT size EQUAL expected_size)
+    message(FATAL_ERROR "Expected ${OUTPUT} to be ${expected_size} bytes, but it is ${size} bytes.")
+endif()
+
+file(READ ${OUTPUT} header LIMIT 44 HEX)
+foreach(field "0;52494646;RIFF" "8;57415645;WAVE" "12;666d7420;fmt chunk" "20;0300;IEEE float format" "22;0200;2 channels" "36;64617461;data chunk")
+    list(GET field 0 offset)
+    list(GET field 1 expected)
+    list(GET field 2 name)
+    math(EXPR hex_offset "${offset} * 2")
+    string(LENGTH ${expected} length)
+    string(SUBSTRING ${header} ${hex_offset} ${length} actual)
+    if(NOT actual STREQUAL expected)
+        message(FATAL_ERROR "Bad WAV header ${name} at byte ${offset}: ${actual} (expected ${expected})")
+    endif()
+endforeach()
@@ -0,0 +1,123 @@
+#include <cmath>
+#include <vector>
+
+#include "Project/Audio/Graph/ma_gainer_node/ma_gainer_node.h"
+#include "Project/Audio/Graph/ma_simd/ma_simd.h"
+
+#include "Test.h"
+
+static constexpr ma_simd_instruction_set VectorInstructionSets[]{ma_simd_instruction_set_sse2, ma_simd_instruction_set_avx2, ma_simd_instruction_set_neon};
+
+// Restores the default kernels on destruction.
+struct DefaultInstructionSetGuard {
+    ~DefaultInstructionSetGuard() { ma_simd_set_instruction_set(Default); }
+    const ma_simd_instruction_set Default{ma_simd_get_instruction_set()};
+};
+
+static std::vector<float> Samples(ma_uint64 count, float frequency) {
+    std::vector<float> samples(count);
+    for (ma_uint64 i = 0; i < count; ++i) samples[i] = std::sin(float(i) * frequency);
+    return samples;
+}
+
+// Each vectorized implementation supported by this build and CPU matches the scalar one exactly,
+// for every `frame_count` up to a few full vectors plus a scalar remainder.
+template<typename KernelFn> static void CheckMatchesScalar(KernelFn &&kernel) {
+    const DefaultInstructionSetGuard guard;
+    for (ma_uint64 frame_count = 0; frame_count <= 37; ++frame_count) {
+        CHECK(ma_simd_set_instruction_set(ma_simd_instruction_set_scalar));
+        const std::vector<float> expected = kernel(frame_count);
+        for (const auto instruction_set : VectorInstructionSets) {
+            if (ma_simd_set_instruction_set(instruction_set)) CHECK(kernel(frame_count) == expected);
+        }
+    }
+}
+
+TEST(SimdGainKernelsMatchScalar) {
+    CheckMatchesScalar([](ma_uint64 frame_count) {
+        const auto src = Samples(frame_count, 0.1f);
+        std::vector<float> dst(frame_count);
+        ma_simd_apply_gain_f32(dst.data(), src.data(), 0.7f, frame_count);
+        return dst;
+    });
+    CheckMatchesScalar([](ma_uint64 frame_count) {
+        auto samples = Samples(frame_count, 0.1f);
+        ma_simd_apply_gain_f32(samples.data(), samples.data(), 0.7f, frame_count); // In place.
+        return samples;
+    });
+    CheckMatchesScalar([](ma_uint64 frame_count) {
+        const auto src = Samples(frame_count * 2, 0.1f);
+        std::vector<float> dst(frame_count * 2);
+        ma_simd_apply_stereo_gain_f32(dst.data(), src.data(), 0.7f, -0.3f, frame_count);
+        return dst;
+    });
+}
+
+TEST(SimdMultiplyKernelMatchesScalar) {
+    CheckMatchesScalar([](ma_uint64 frame_count) {
+        const auto a = Samples(frame_count, 0.1f), b = Samples(frame_count, 0.37f);
+        std::vector<float> dst(frame_count);
+        ma_simd_multiply_f32(dst.data(), a.data(), b.data(), frame_count);
+        return dst;
+    });
+}
+
+// Channel buffers are returned one after the other.
+TEST(SimdInterleaveKernelsMatchScalar) {
+    for (const ma_uint32 channels : {1u, 2u, 3u}) {
+        CheckMatchesScalar([channels](ma_uint64 frame_count) {
+            const auto src = Samples(frame_count * channels, 0.1f);
+            std::vector<float> dst(frame_count * channels);
+            std::vector<float *> channel_dst;
+            for (ma_uint32 channel = 0; channel < channels; ++channel) channel_dst.push_back(dst.data() + channel * frame_count);
+            ma_simd_deinterleave_f32(channel_dst.data(), src.data(), channels, frame_count);
+            return dst;
+        });
+        CheckMatchesScalar([channels](ma_uint64 frame_count) {
+            const auto src = Samples(frame_count * channels, 0.1f);
+            std::vector<const float *> channel_src;
+            for (ma_uint32 channel = 0; channel < channels; ++channel) channel_src.push_back(src.data() + channel * frame_count);
+            std::vector<float> dst(frame_count * channels);
+            ma_simd_interleave_f32(dst.data(), channel_src.data(), channels, frame_count);
+            return dst;
+        });
+    }
+}
+
+// Outside of a smoothed gain change, the gainer node applies its constant gain with a vectorized kernel, scaled by the master volume.
+TEST(GainerNodeAppliesMasterVolume) {
+    static constexpr ma_uint32 Channels = 2, SampleRate = 48'000, Frames = 512, SmoothFrames = 64;
+    ma_node_graph graph;
+    const auto graph_config = ma_node_graph_config_init(Channels);
+    CHECK(ma_node_graph_init(&graph_config, nullptr, &graph) == MA_SUCCESS);
+
+    const auto waveform_config = ma_waveform_config_init(ma_format_f32, Channels, SampleRate, ma_waveform_type_sine, 0.5, 220);
+    ma_waveform waveform, reference_waveform;
+    CHECK(ma_waveform_init(&waveform_config, &waveform) == MA_SUCCESS);
+    CHECK(ma_waveform_init(&waveform_config, &reference_waveform) == MA_SUCCESS);
+    const auto source_config = ma_data_source_node_config_init(&waveform);
+    ma_data_source_node source;
+    CHECK(ma_data_source_node_init(&graph, &source_config, nullptr, &source) == MA_SUCCESS);
+
+    for (const ma_uint32 smooth_frames : {0u, SmoothFrames}) {
+        const auto gainer_config = ma_gainer_node_config_init(Channels, 0.5f, smooth_frames);
+        ma_gainer_node gainer;
+        CHECK(ma_gainer_node_init(&graph, &gainer_config, nullptr, &gainer) == MA_SUCCESS);
+        CHECK(ma_gainer_set_master_volume(&gainer.gainer, 0.5f) == MA_SUCCESS);
+        CHECK(ma_node_attach_output_bus(&source, 0, &gainer, 0) == MA_SUCCESS);
+        CHECK(ma_node_attach_output_bus(&gainer, 0, ma_node_graph_get_endpoint(&graph), 0) == MA_SUCCESS);
+
+        std::vector<float> output(Frames * Channels), expected(Frames * Channels);
+        CHECK(ma_node_graph_read_pcm_frames(&graph, output.data(), Frames, nullptr) == MA_SUCCESS);
+        CHECK(ma_waveform_read_pcm_frames(&reference_waveform, expected.data(), Frames, nullptr) == MA_SUCCESS);
+        // Skip the smoothed frames, which `ma_gainer` processes itself.
+        for (ma_uint32 i = smooth_frames * Channels; i < Frames * Channels; ++i) CHECK_EQ(output[i], expected[i] * 0.25f);
+
+        ma_gainer_node_uninit(&gainer, nullptr);
+    }
+
+    ma_data_source_node_uninit(&source, nullptr);
+    ma_waveform_uninit(&reference_waveform);
+    ma_waveform_uninit(&waveform);
+    ma_node_graph_uninit(&graph, nullptr);
+}
@@ -0,0 +1,112 @@
+#include "Core/Store/Store.h"
+#include "Core/Store/StoreHistory.h"
+
+#include "Test.h"
+
+// Set `/value` and record the change as a gesture.
+static void AddValueGesture(Store &store, StoreHistory &history, u32 value) {
+    store.Set("/value", value);
+    history.AddGesture({{}, Clock::now()}, store.CheckedCommit());
+}
+
+static u32 CurrentValue(const StoreHistory &history) { return history.CurrentStore().Get<u32>("/value"); }
+
+// Adding a gesture after undoing starts a new branch, keeping the undone records.
+TEST(StoreHistoryBranchesOnUndo) {
+    Store store;
+    store.Set("/value", u32(0));
+    store.Commit();
+    StoreHistory history{store};
+
+    AddValueGesture(store, history, 1); // Record 1
+    AddValueGesture(store, history, 2); // Record 2
+    history.SetIndex(1);
+    store.CheckedSet(history.CurrentStore());
+    AddValueGesture(store, history, 3); // Record 3, a sibling of record 2
+
+    CHECK_EQ(history.RecordCount(), 4u);
+    CHECK_EQ(history.Size(), 3u);
+    CHECK_EQ(history.RecordId(), 3u);
+    CHECK_EQ(history.ParentRecordId(3), 1u);
+    CHECK(history.ChildRecordIds(1) == std::vector<u32>({2, 3}));
+    CHECK_EQ(CurrentValue(history), 3u);
+
+    const auto indexed = history.GetIndexedGestures();
+    CHECK(indexed.ParentIds);
+    CHECK(*indexed.ParentIds == std::vector<u32>({0, 1, 1}));
+    CHECK_EQ(indexed.Index, 3u);
+}
+
+// Switching to a record on another branch makes its branch current, continuing through the most recently visited children.
+TEST(StoreHistoryNavigatesBranches) {
+    Store store;
+    store.Set("/value", u32(0));
+    store.Commit();
+    StoreHistory history{store};
+
+    AddValueGesture(store, history, 1); // Record 1
+    AddValueGesture(store, history, 2); // Record 2
+    AddValueGesture(store, history, 3); // Record 3
+    history.SetIndex(1);
+    store.CheckedSet(history.CurrentStore());
+    AddValueGesture(store, history, 4); // Record 4, branching from record 1
+    AddValueGesture(store, history, 5); // Record 5
+
+    history.SetRecordId(2);
+    CHECK_EQ(history.Index, 2u);
+    CHECK_EQ(history.Size(), 4u); // Continues through record 3.
+    CHECK_EQ(history.RecordIdAt(3), 3u);
+    CHECK_EQ(CurrentValue(history), 2u);
+    CHECK(history.CanUndo() && history.CanRedo());
+
+    history.SetIndex(0);
+    CHECK_EQ(history.RecordId(), 0u);
+    history.SetIndex(1);
+    CHECK_EQ(history.RecordIdAt(2), 2u); // Redo follows the most recently visited branch.
+
+    history.SetRecordId(5);
+    CHECK_EQ(history.Index, 3u);
+    CHECK_EQ(history.Size(), 4u);
+    CHECK_EQ(history.RecordIdAt(2), 4u);
+    CHECK(!history.CanRedo());
+    CHECK_EQ(CurrentValue(history), 5u);
+
+    history.SetIndex(1);
+    history.SetRecordId(3);
+    CHECK_EQ(history.RecordIdAt(2), 2u);
+    CHECK_EQ(CurrentValue(history), 3u);
+}
+
+// Gestures with empty patches still get records, so replaying saved gestures reproduces their record IDs.
+TEST(StoreHistoryRecordsEmptyGesturePatches) {
+    Store store;
+    store.Set("/value", u32(0));
+    store.Commit();
+    StoreHistory history{store};
+
+    AddValueGesture(store, history, 1);
+    history.AddGesture({{}, Clock::now()}, Patch{});
+    AddValueGesture(store, history, 2);
+    CHECK_EQ(history.RecordCount(), 4u);
+    CHECK_EQ(history.ParentRecordId(3), 2u);
+
+    // The whole-store-diff overload skips gestures that don't change the store.
+    history.AddGesture({{}, Clock::now()});
+    CHECK_EQ(history.RecordCount(), 4u);
+}
+
+BENCHMARK(StoreHistorySwitchBranches) {
+    static constexpr u32 Depth = 10'000;
+    Store store;
+    store.Set("/value", u32(0));
+    store.Commit();
+    StoreHistory history{store};
+    for (u32 i = 1; i <= Depth; ++i) AddValueGesture(store, history, i);
+    // Add a one-record branch off the tip's parent.
+    history.SetIndex(Depth - 1);
+    store.CheckedSet(history.CurrentStore());
+    AddValueGesture(store, history, Depth + 1);
+
+    u32 i = 0;
+    Bench("Switch between sibling branches 10k records deep", 10'000, [&] { history.SetRecordId(i++ % 2 == 0 ? Depth : Depth + 1); });
+}
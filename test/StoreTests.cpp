@@ -0,0 +1,144 @@
+#include <format>
+#include <random>
+
+#include "Core/Store/Store.h"
+
+#include "Test.h"
+
+using u32Set = immer::set<u32>;
+
+// Patch a store's containers and apply the patch to a copy of the original store.
+TEST(StorePatchRoundTripsContainers) {
+    Store source;
+    source.Set("/vector", Store::Vector<u32>{1, 2, 3});
+    source.Set("/set", u32Set{}.insert(5).insert(100'000));
+    source.Set("/removed_vector", Store::Vector<float>{});
+    source.Commit();
+
+    Store target{source};
+    source.Set("/vector", Store::Vector<u32>{1, 9});
+    source.Set("/set", u32Set{}.insert(5).insert(7));
+    source.Erase<Store::Vector<float>>("/removed_vector");
+    source.Set("/added_vector", Store::Vector<float>{});
+    const auto patch = source.CheckedCommit();
+
+    CHECK(patch.Ops.contains("added_vector"));
+    CHECK(patch.Ops.at("added_vector").Target == PatchOpTarget::Vector);
+    CHECK(patch.Ops.at("set/100000").Target == PatchOpTarget::SetElement);
+    CHECK(patch.Ops.at("vector/1").Target == PatchOpTarget::VectorElement);
+
+    target.Apply(Action::Store::ApplyPatch{patch});
+    target.Commit();
+    CHECK(target.CreatePatch(source).Empty());
+    CHECK(!target.Contains<Store::Vector<float>>("/removed_vector"));
+    CHECK(target.Contains<Store::Vector<float>>("/added_vector"));
+    CHECK(!target.Contains<Store::Vector<u32>>("/set"));
+    CHECK_EQ(target.Get<u32Set>("/set").size(), 2u);
+    CHECK_EQ(target.Get<Store::Vector<u32>>("/vector").size(), 2u);
+}
+
+BENCHMARK(StorePatchVectorElement) {
+    static constexpr u32 Size = 10'000;
+    Store source;
+    source.Set("/vector", Store::Vector<float>(Size, 0.f));
+    source.Commit();
+    Store target{source};
+
+    u32 i = 0;
+    Bench("Commit and apply one changed element of 10k", 1'000, [&] {
+        const u32 index = i++ % Size;
+        source.Set("/vector", source.Get<Store::Vector<float>>("/vector").set(index, float(index + 1)));
+        target.Apply(Action::Store::ApplyPatch{source.CheckedCommit()});
+        target.Commit();
+    });
+}
+
+static bool OpsEqual(const PatchOps &a, const PatchOps &b) {
+    return std::ranges::equal(a, b, [](const auto &a_entry, const auto &b_entry) {
+        const auto &[a_path, a_op] = a_entry;
+        const auto &[b_path, b_op] = b_entry;
+        return a_path == b_path && a_op.Op == b_op.Op && a_op.Value == b_op.Value && a_op.Old == b_op.Old && a_op.Target == b_op.Target;
+    });
+}
+
+// A commit's patch, produced from only the touched paths, matches a full diff of the store,
+// through random sets (including of unchanged values), erases, and whole-store sets.
+TEST(StoreTouchedPatchMatchesFullPatch) {
+    std::mt19937 rng{0};
+    const auto random_path = [&rng] { return StorePath{std::format("{}/{}", rng() % 4, rng() % 8)}; };
+    const auto random_set = [&rng] {
+        auto set = u32Set{};
+        for (u32 i = rng() % 4; i > 0; --i) set = std::move(set).insert(rng() % 8);
+        return set;
+    };
+    const auto random_pairs = [&rng] {
+        auto pairs = IdPairs{};
+        for (u32 i = rng() % 4; i > 0; --i) pairs = std::move(pairs).insert({rng() % 4, rng() % 4});
+        return pairs;
+    };
+    const auto random_vector = [&rng] {
+        auto vector = Store::Vector<u32>{};
+        for (u32 i = rng() % 4; i > 0; --i) vector = std::move(vector).push_back(rng() % 4);
+        return vector;
+    };
+
+    Store store;
+    store.Commit();
+    std::vector<Store> snapshots{store};
+    for (u32 commit = 0; commit < 500; ++commit) {
+        if (rng() % 10 == 0) store.Set(snapshots[rng() % snapshots.size()]); // E.g. navigating history.
+        for (u32 i = rng() % 8; i > 0; --i) {
+            // Paths hold one type at a time (as they do for components), so each type has its own path prefix.
+            const auto path = random_path();
+            const bool erase = rng() % 4 == 0;
+            switch (rng() % 6) {
+                case 0:
+                    if (erase) store.Erase<bool>("/bool" / path);
+                    else store.Set("/bool" / path, rng() % 2 == 0);
+                    break;
+                case 1:
+                    if (erase) store.Erase<u32>("/u32" / path);
+                    else store.Set("/u32" / path, u32(rng() % 3));
+                    break;
+                case 2:
+                    if (erase) store.Erase<std::string>("/string" / path);
+                    else store.Set("/string" / path, std::string(rng() % 3, 'a'));
+                    break;
+                case 3:
+                    if (erase) store.Erase<u32Set>("/set" / path);
+                    else store.Set("/set" / path, random_set());
+                    break;
+                case 4:
+                    if (erase) store.Erase<IdPairs>("/pairs" / path);
+                    else store.Set("/pairs" / path, random_pairs());
+                    break;
+                case 5:
+                    if (erase) store.Erase<Store::Vector<u32>>("/vector" / path);
+                    else store.Set("/vector" / path, random_vector());
+                    break;
+            }
+        }
+        const auto full_patch = store.CreatePatch(store, Store{store});
+        const auto patch = store.CheckedCommit();
+        CHECK(OpsEqual(patch.Ops, full_patch.Ops));
+        if (rng() % 20 == 0) snapshots.push_back(store);
+    }
+}
+
+BENCHMARK(StoreCommit) {
+    static constexpr u32 KeyCount = 100'000;
+    Store store;
+    for (u32 i = 0; i < KeyCount; ++i) store.Set(std::format("/component_{}/value", i), i);
+    store.Commit();
+
+    u32 i = 0;
+    Bench("Commit one changed key of 100k, diffing touched paths", 1'000, [&] {
+        store.Set(std::format("/component_{}/value", i % KeyCount), ++i);
+        store.CheckedCommit();
+    });
+    Bench("Commit one changed key of 100k, diffing the whole store", 100, [&] {
+        store.Set(std::format("/component_{}/value", i % KeyCount), ++i);
+        store.CreatePatch(store, Store{store});
+        store.Commit();
+    });
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+// A minimal test and benchmark registry for the `flowgrid_tests` executable (see `main.cpp`).
+// Tests throw a `TestFailure` on the first failed check. Benchmarks only run with `--bench`, and report their own timings.
+
+#include <chrono>
+#include <format>
+#include <print>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct TestCase {
+    const char *Name;
+    void (*Run)();
+    bool IsBenchmark;
+};
+
+inline std::vector<TestCase> &TestCases() {
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+struct TestRegistrar {
+    TestRegistrar(const char *name, void (*run)(), bool is_benchmark) { TestCases().push_back({name, run, is_benchmark}); }
+};
+
+struct TestFailure : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+#define FG_TEST_CASE(Name, IsBenchmark)                                        \
+    static void Name();                                                         \
+    static const TestRegistrar Name##Registrar{#Name, Name, IsBenchmark};       \
+    static void Name()
+
+#define TEST(Name) FG_TEST_CASE(Name, false)
+#define BENCHMARK(Name) FG_TEST_CASE(Name, true)
+
+#define CHECK(expr)                                                                                  \
+    do {                                                                                             \
+        if (!(expr)) throw TestFailure(std::format("{}:{}: CHECK({}) failed", __FILE__, __LINE__, #expr)); \
+    } while (false)
+
+#define CHECK_EQ(a, b)                                                                                                   \
+    do {                                                                                                                 \
+        const auto &_a = (a);                                                                                            \
+        const auto &_b = (b);                                                                                            \
+        if (!(_a == _b)) throw TestFailure(std::format("{}:{}: CHECK_EQ({}, {}) failed: {} != {}", __FILE__, __LINE__, #a, #b, _a, _b)); \
+    } while (false)
+
+#define CHECK_NEAR(a, b, tolerance)                                                                                                            \
+    do {                                                                                                                                       \
+        const double _a = (a), _b = (b);                                                                                                       \
+        if (!(_a - _b <= (tolerance) && _b - _a <= (tolerance))) throw TestFailure(std::format("{}:{}: CHECK_NEAR({}, {}) failed: {} != {}", __FILE__, __LINE__, #a, #b, _a, _b)); \
+    } while (false)
+
+using BenchClock = std::chrono::steady_clock;
+
+// Run `fn` `iterations` times and print the mean time per iteration.
+// Returns the mean time per iteration in seconds.
+double Bench(const std::string &name, unsigned iterations, auto &&fn) {
+    const auto start = BenchClock::now();
+    for (unsigned i = 0; i < iterations; ++i) fn();
+    const double seconds = std::chrono::duration<double>(BenchClock::now() - start).count() / iterations;
+    std::println("  {:<48} {:>12.3f}us", name, seconds * 1e6);
+    return seconds;
+}
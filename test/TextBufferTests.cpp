@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <chrono>
+#include <format>
+
+#include "Helper/File.h"
+#include "Project/Audio/Faust/Faust.h"
+#include "Project/TextEditor/TextBuffer.h"
+
+#include "HeadlessProject.h"
+#include "Test.h"
+
+// The first Faust DSP's code buffer, with its code repeated to `size` bytes or more.
+static const TextBuffer &LoadRepeatedCode(const HeadlessProject &project, u32 size) {
+    const auto &buffer = project.Project->Audio.Faust.FaustDsps.front()->Editor.Buffer;
+    const std::string code = buffer.GetText() + "\n// Non-ASCII glyphs are drawn one at a time: π ≈ 3.14159, naïve café\n";
+    std::string text;
+    while (text.size() < size) text += code;
+    buffer.Apply(Action::TextBuffer::Set{buffer.Path, std::move(text)});
+    return buffer;
+}
+
+// Parsing happens on a background thread, so typing into a large file doesn't wait on tree-sitter.
+TEST(TextBufferEditLatencyIsIndependentOfSize) {
+    HeadlessProject project;
+    const auto &buffer = LoadRepeatedCode(project, 1024 * 1024);
+    buffer.Apply(Action::TextBuffer::EnterChar{buffer.Path, 'x'}); // Warm up.
+
+    BenchClock::duration max_latency{};
+    for (u32 i = 0; i < 100; ++i) {
+        const auto start = BenchClock::now();
+        buffer.Apply(Action::TextBuffer::EnterChar{buffer.Path, 'x'});
+        max_latency = std::max(max_latency, BenchClock::now() - start);
+    }
+    CHECK(max_latency < std::chrono::milliseconds{1});
+}
+
+BENCHMARK(TextBufferRender) {
+    HeadlessProject project;
+    const auto &buffer = LoadRepeatedCode(project, 64 * 1024);
+    Bench("Render a frame of a 64KB code buffer", 200, [&] { project.RenderFrame([&] { buffer.Render(); }); });
+}
+
+BENCHMARK(TextBufferGetText) {
+    HeadlessProject project;
+    const auto &buffer = LoadRepeatedCode(project, 500 * 1024);
+    Bench("Edit a 500KB buffer", 100, [&] { buffer.Apply(Action::TextBuffer::EnterChar{buffer.Path, 'x'}); });
+    Bench("Edit and flatten a 500KB buffer", 100, [&] {
+        buffer.Apply(Action::TextBuffer::EnterChar{buffer.Path, 'x'});
+        buffer.GetTextHash();
+    });
+    Bench("Get the cached text hash of a 500KB buffer", 10'000, [&] { buffer.GetTextHash(); });
+}
+
+// Typing at the end of a 50k-line buffer, where converting the cursor's line to a byte offset used to sum every preceding line.
+BENCHMARK(TextBufferEditEndOfLargeBuffer) {
+    static constexpr u32 LineCount = 50'000;
+    HeadlessProject project;
+    const auto &buffer = project.Project->Audio.Faust.FaustDsps.front()->Editor.Buffer;
+    const auto type_at_end = [&buffer](const std::string &name) {
+        buffer.Apply(Action::TextBuffer::MoveCursorsBottom{buffer.Path, false});
+        Bench(std::format("Type at the end of a 50k-line {} buffer", name), 1'000, [&] { buffer.Apply(Action::TextBuffer::EnterChar{buffer.Path, 'x'}); });
+    };
+
+    const std::string code = buffer.GetText();
+    std::string faust_text;
+    for (u32 i = 0; i < LineCount; ++i) faust_text += std::format("f{} = _ * {};\n", i, i);
+    buffer.Apply(Action::TextBuffer::Set{buffer.Path, faust_text + code});
+    type_at_end("Faust");
+
+    // The language is chosen by file extension, so load the JSON from a file.
+    std::string json_text = "[\n";
+    for (u32 i = 0; i < LineCount; ++i) json_text += std::format("  {{\"id\": {}, \"name\": \"node{}\"}},\n", i, i);
+    json_text += "  {}\n]\n";
+    const auto json_path = fs::temp_directory_path() / "FlowGridTextBufferBenchmark.json";
+    FileIO::write(json_path, json_text);
+    buffer.Apply(Action::TextBuffer::Open{buffer.Path, json_path});
+    fs::remove(json_path);
+    type_at_end("JSON");
+}
+
+// The `i`th keystroke of a scripted typing session: words of five letters, separated by spaces, with a newline every ten words.
+static unsigned short ScriptedKeystroke(u32 i) { return i % 60 == 59 ? '\n' : (i % 6 == 5 ? ' ' : 'a' + i % 6); }
+
+// Typed words are coalesced into one undo record each (newlines get their own), and undoing and redoing everything restores the text.
+TEST(TextBufferUndoCoalescesTypedWords) {
+    static constexpr u32 KeystrokeCount = 600;
+    HeadlessProject project;
+    const auto &buffer = project.Project->Audio.Faust.FaustDsps.front()->Editor.Buffer;
+    buffer.Apply(Action::TextBuffer::MoveCursorsBottom{buffer.Path, false});
+    const std::string initial_text = buffer.GetText();
+    const u32 initial_history_size = buffer.GetHistorySize();
+
+    for (u32 i = 0; i < KeystrokeCount; ++i) buffer.Apply(Action::TextBuffer::EnterChar{buffer.Path, ScriptedKeystroke(i)});
+    const std::string typed_text = buffer.GetText();
+    CHECK(typed_text.size() > initial_text.size() && typed_text.starts_with(initial_text));
+    CHECK(buffer.GetHistorySize() - initial_history_size <= KeystrokeCount / 6 + KeystrokeCount / 60); // At most one record per word or newline.
+
+    while (buffer.CanApply(Action::TextBuffer::Undo{buffer.Path})) buffer.Apply(Action::TextBuffer::Undo{buffer.Path});
+    CHECK(buffer.GetText() == initial_text);
+    while (buffer.CanApply(Action::TextBuffer::Redo{buffer.Path})) buffer.Apply(Action::TextBuffer::Redo{buffer.Path});
+    CHECK(buffer.GetText() == typed_text);
+}
+
+BENCHMARK(TextBufferUndoHistory) {
+    static constexpr u32 KeystrokeCount = 100'000;
+    HeadlessProject project;
+    const auto &buffer = project.Project->Audio.Faust.FaustDsps.front()->Editor.Buffer;
+    buffer.Apply(Action::TextBuffer::MoveCursorsBottom{buffer.Path, false});
+
+    u32 i = 0;
+    Bench("Type a keystroke in a 100k-keystroke session", KeystrokeCount, [&] { buffer.Apply(Action::TextBuffer::EnterChar{buffer.Path, ScriptedKeystroke(i++)}); });
+    std::println("  {:<48} {:>12} records, {:.1f}KB", "Undo history after 100k keystrokes", buffer.GetHistorySize(), buffer.GetHistoryByteSize() / 1024.0);
+    Bench("Undo a record", 1'000, [&] { buffer.Apply(Action::TextBuffer::Undo{buffer.Path}); });
+    Bench("Redo a record", 1'000, [&] { buffer.Apply(Action::TextBuffer::Redo{buffer.Path}); });
+}
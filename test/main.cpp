@@ -0,0 +1,39 @@
+// Usage: flowgrid_tests [--bench] [name-filter...]
+// Runs all tests (or all benchmarks, with `--bench`) whose name contains any of the filters.
+
+#include <algorithm>
+#include <print>
+#include <string_view>
+#include <vector>
+
+#include "Project/FileDialog/FileDialogImpl.h"
+
+#include "Test.h"
+
+FileDialogImpl FileDialogImp;
+
+int main(int argc, char **argv) {
+    bool bench = false;
+    std::vector<std::string_view> filters;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string_view{argv[i]} == "--bench") bench = true;
+        else filters.emplace_back(argv[i]);
+    }
+
+    unsigned run_count = 0, failure_count = 0;
+    for (const auto &test : TestCases()) {
+        if (test.IsBenchmark != bench) continue;
+        if (!filters.empty() && std::ranges::none_of(filters, [&test](auto filter) { return std::string_view{test.Name}.contains(filter); })) continue;
+
+        std::println("{}", test.Name);
+        ++run_count;
+        try {
+            test.Run();
+        } catch (const std::exception &e) {
+            std::println("  FAILED: {}", e.what());
+            ++failure_count;
+        }
+    }
+    std::println("{} of {} {} passed.", run_count - failure_count, run_count, bench ? "benchmarks" : "tests");
+    return failure_count == 0 ? 0 : 1;
+}